@@ -12,6 +12,7 @@
 #include "../memory.hpp"
 #include "../cast.hpp"
 #include <array>
+#include <cstring>
 
 namespace tt::pipeline_image {
 
@@ -61,6 +62,81 @@ image device_shared::makeImage(size_t width, size_t height) noexcept
     return image{this, width, height, width_in_pages, height_in_pages, allocatePages(nr_pages)};
 }
 
+/** Check if two pixel-maps have the same size and bit-identical pixels.
+ */
+[[nodiscard]] static bool equal_pixels(pixel_map<sfloat_rgba16> const &lhs, pixel_map<sfloat_rgba16> const &rhs) noexcept
+{
+    if (lhs.width() != rhs.width() or lhs.height() != rhs.height()) {
+        return false;
+    }
+
+    ttlet row_size = narrow_cast<size_t>(lhs.width()) * sizeof(sfloat_rgba16);
+    for (ssize_t rowNr = 0; rowNr != lhs.height(); ++rowNr) {
+        if (std::memcmp(lhs[rowNr].data(), rhs[rowNr].data(), row_size) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+image device_shared::makeImage(pixel_map<sfloat_rgba16> const &pixmap) noexcept
+{
+    ttlet width = narrow_cast<size_t>(pixmap.width());
+    ttlet height = narrow_cast<size_t>(pixmap.height());
+    ttlet hash = pixmap.hash();
+
+    if (hash != 0) {
+        ttlet it = imageCache.find(hash);
+        if (it != imageCache.end()) {
+            auto &entry = it->second;
+            // The hash only selects the candidate, the pixels are compared so that a hash
+            // collision can not show the wrong image.
+            if (equal_pixels(entry.pixels, pixmap)) {
+                ++entry.use_count;
+
+                ttlet width_in_pages = (width + (Page::width - 1)) / Page::width;
+                ttlet height_in_pages = (height + (Page::height - 1)) / Page::height;
+                auto r = image{this, width, height, width_in_pages, height_in_pages, std::vector<Page>{entry.pages}};
+                r.hash = hash;
+                r.state = image::State::Uploaded;
+                return r;
+            }
+
+            // A different image with the same hash is already cached, upload into its own pages.
+            auto r = makeImage(width, height);
+            r.upload(pixmap);
+            return r;
+        }
+    }
+
+    auto r = makeImage(width, height);
+    r.upload(pixmap);
+
+    if (hash != 0) {
+        auto pixels = pixel_map<sfloat_rgba16>(pixmap.width(), pixmap.height());
+        tt::copy(pixmap, pixels);
+        imageCache.emplace(hash, shared_image_pages{std::move(pixels), r.pages, 1});
+        r.hash = hash;
+    }
+    return r;
+}
+
+void device_shared::releaseImage(image const &image) noexcept
+{
+    if (image.hash != 0) {
+        ttlet it = imageCache.find(image.hash);
+        tt_axiom(it != imageCache.end());
+
+        if (--it->second.use_count != 0) {
+            // The pages are still used by other images.
+            return;
+        }
+        imageCache.erase(it);
+    }
+
+    freePages(image.pages);
+}
+
 tt::pixel_map<sfloat_rgba16> device_shared::getStagingPixelMap()
 {
     stagingTexture.transitionLayout(device, vk::Format::eR16G16B16A16Sfloat, vk::ImageLayout::eGeneral);
@@ -8,9 +8,11 @@
 #include "pipeline_image_page.hpp"
 #include "../required.hpp"
 #include "../rapid/sfloat_rgba16.hpp"
+#include "../pixel_map.hpp"
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.hpp>
 #include <mutex>
+#include <unordered_map>
 
 namespace tt {
 class gfx_device_vulkan;
@@ -46,6 +48,21 @@ struct device_shared final {
 
     std::vector<Page> atlasFreePages;
 
+    /** Pages in the atlas shared by images with identical content.
+     */
+    struct shared_image_pages {
+        /** A copy of the uploaded pixels.
+         * Used to check that an image with the same hash really has the same content.
+         */
+        pixel_map<sfloat_rgba16> pixels;
+        std::vector<Page> pages;
+        size_t use_count;
+    };
+
+    /** Images uploaded into the atlas, keyed on the hash of their pixel-map.
+     */
+    std::unordered_map<size_t, shared_image_pages> imageCache;
+
     device_shared(gfx_device_vulkan const &device);
     ~device_shared();
 
@@ -91,6 +108,16 @@ struct device_shared final {
      */
     image makeImage(size_t width, size_t height) noexcept;
 
+    /** Get an image in the atlas with the content of a pixel-map.
+     * When an image with the same pixels has already been uploaded, the new image
+     * shares its pages in the atlas. Otherwise the pixel-map is uploaded.
+     *
+     * @param pixmap A pixel-map with a hash calculated by `pixel_map::update_hash()`.
+     *               A pixel-map with a zero hash is always uploaded into its own pages.
+     * @return An image in the atlas in the uploaded state.
+     */
+    image makeImage(pixel_map<sfloat_rgba16> const &pixmap) noexcept;
+
     void drawInCommandBuffer(vk::CommandBuffer &commandBuffer);
 
     tt::pixel_map<sfloat_rgba16> getStagingPixelMap();
@@ -104,6 +131,11 @@ private:
 
     void updateAtlasWithStagingPixelMap(image const &image);
 
+    /** Release the pages of an image.
+     * Pages shared through the image-cache are freed when the last image using them is released.
+     */
+    void releaseImage(image const &image) noexcept;
+
     void buildShaders();
     void teardownShaders(gfx_device_vulkan *vulkanDevice);
     void addAtlasImage();
@@ -16,12 +16,14 @@
 namespace tt::pipeline_image {
 
 image::image(image &&other) noexcept :
+    state(other.state.load()),
     parent(other.parent),
     width_in_px(other.width_in_px),
     height_in_px(other.height_in_px),
     width_in_pages(other.width_in_pages),
     height_in_pages(other.height_in_pages),
-    pages(std::move(other.pages))
+    pages(std::move(other.pages)),
+    hash(other.hash)
 {
     tt_axiom(&other != this);
     other.parent = nullptr;
@@ -31,15 +33,17 @@ image &image::operator=(image &&other) noexcept
 {
     // Self-assignment is allowed.
     if (parent) {
-        parent->freePages(pages);
+        parent->releaseImage(*this);
     }
 
+    state = other.state.load();
     parent = other.parent;
     width_in_px = other.width_in_px;
     height_in_px = other.height_in_px;
     width_in_pages = other.width_in_pages;
     height_in_pages = other.height_in_pages;
     pages = std::move(other.pages);
+    hash = other.hash;
     other.parent = nullptr;
     return *this;
 }
@@ -47,7 +51,7 @@ image &image::operator=(image &&other) noexcept
 image::~image()
 {
     if (parent) {
-        parent->freePages(pages);
+        parent->releaseImage(*this);
     }
 }
 
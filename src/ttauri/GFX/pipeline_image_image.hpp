@@ -52,6 +52,12 @@ struct image {
 
     std::vector<Page> pages;
 
+    /** The hash of the pixel-map that was uploaded in the pages.
+     * When non-zero the pages are shared with other images with the same content
+     * through the image-cache of the device_shared.
+     */
+    size_t hash = 0;
+
     image() noexcept :
         parent(nullptr), width_in_px(0), height_in_px(0), width_in_pages(0), height_in_pages(0), pages() {}
 
@@ -31,6 +31,7 @@ enum class build_type {
 
 #define TT_OS_WINDOWS 'W'
 #define TT_OS_MACOS 'A'
+#define TT_OS_LINUX 'L'
 #define TT_OS_MOBILE 'M'
 #define TT_OS_OTHER 'O'
 
@@ -40,6 +41,8 @@ enum class build_type {
 #define TT_OPERATING_SYSTEM TT_OS_MACOS
 #elif defined(TARGET_OS_IPHONE) || defined(__ANDROID__)
 #define TT_OPERATING_SYSTEM TT_OS_MOBILE
+#elif defined(__linux__)
+#define TT_OPERATING_SYSTEM TT_OS_LINUX
 #else
 #define TT_OPERATING_SYSTEM TT_OS_OTHER
 #endif
@@ -47,6 +50,7 @@ enum class build_type {
 enum class operating_system {
     windows = TT_OS_WINDOWS,
     macos = TT_OS_MACOS,
+    linux_ = TT_OS_LINUX, ///< `linux` is a predefined macro in GNU mode.
     mobile = TT_OS_MOBILE,
     other = TT_OS_OTHER,
 
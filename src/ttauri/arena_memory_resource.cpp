@@ -0,0 +1,41 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "arena_memory_resource.hpp"
+#include <algorithm>
+
+namespace tt {
+
+void arena_memory_resource::allocate_chunk(size_t bytes, size_t alignment)
+{
+    // A large allocation gets a chunk of its own size, without skipping the growth of the next chunk.
+    ttlet minimum_size = sizeof(chunk_type) + bytes + alignment;
+    ttlet size = std::max(_next_chunk_size, minimum_size);
+    if (size == _next_chunk_size) {
+        _next_chunk_size = std::min(_next_chunk_size * 2, max_chunk_size);
+    }
+
+    auto *chunk = static_cast<chunk_type *>(_upstream->allocate(size, alignof(std::max_align_t)));
+    chunk->next = _chunks;
+    chunk->size = size;
+    _chunks = chunk;
+
+    _ptr = reinterpret_cast<std::byte *>(chunk + 1);
+    _end = reinterpret_cast<std::byte *>(chunk) + size;
+}
+
+void arena_memory_resource::release() noexcept
+{
+    while (_chunks != nullptr) {
+        auto *chunk = std::exchange(_chunks, _chunks->next);
+        _upstream->deallocate(chunk, chunk->size, alignof(std::max_align_t));
+    }
+
+    _ptr = nullptr;
+    _end = nullptr;
+    _next_chunk_size = _initial_chunk_size;
+    _free_lists = {};
+}
+
+} // namespace tt
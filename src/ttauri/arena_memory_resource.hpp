@@ -0,0 +1,205 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace tt {
+
+/** A memory resource which allocates from large chunks and releases them in one step.
+ *
+ * Small allocations are rounded up to a size class; deallocated small blocks are kept
+ * in a free list for their size class and reused by later allocations of the same class.
+ * Larger deallocated blocks are only reclaimed by `release()` or by destroying the arena.
+ *
+ * This is useful for building trees of many small objects, such as the nodes of a parsed
+ * formula or skeleton, which are all destroyed together.
+ *
+ * This class is not thread-safe.
+ */
+class arena_memory_resource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t granularity = 16;
+    static constexpr size_t nr_size_classes = 32;
+    static constexpr size_t max_pooled_size = granularity * nr_size_classes;
+    static constexpr size_t max_chunk_size = 1024 * 1024;
+
+    /** Create an arena.
+     *
+     * @param initial_chunk_size The size of the first chunk, each next chunk is twice as large.
+     * @param upstream The memory resource to allocate the chunks from.
+     */
+    explicit arena_memory_resource(
+        size_t initial_chunk_size = 4096,
+        std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) noexcept :
+        _upstream(upstream), _initial_chunk_size(initial_chunk_size), _next_chunk_size(initial_chunk_size)
+    {
+        tt_axiom(upstream != nullptr);
+    }
+
+    ~arena_memory_resource()
+    {
+        release();
+    }
+
+    arena_memory_resource(arena_memory_resource const &) = delete;
+    arena_memory_resource(arena_memory_resource &&) = delete;
+    arena_memory_resource &operator=(arena_memory_resource const &) = delete;
+    arena_memory_resource &operator=(arena_memory_resource &&) = delete;
+
+    [[nodiscard]] std::pmr::memory_resource *upstream_resource() const noexcept
+    {
+        return _upstream;
+    }
+
+    /** Release all the memory allocated from the arena back to the upstream resource.
+     * The objects in the arena must have been destroyed, or be trivially destructible.
+     */
+    void release() noexcept;
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        if (bytes <= max_pooled_size and alignment <= granularity) {
+            ttlet size_class = size_class_of(bytes);
+            if (auto *block = _free_lists[size_class]) {
+                _free_lists[size_class] = block->next;
+                return block;
+            }
+            return bump_allocate((size_class + 1) * granularity, granularity);
+        }
+        return bump_allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        if (bytes <= max_pooled_size and alignment <= granularity) {
+            ttlet size_class = size_class_of(bytes);
+            auto *block = static_cast<free_block_type *>(p);
+            block->next = _free_lists[size_class];
+            _free_lists[size_class] = block;
+        }
+    }
+
+    [[nodiscard]] bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    struct chunk_type {
+        chunk_type *next;
+        size_t size;
+    };
+
+    struct free_block_type {
+        free_block_type *next;
+    };
+
+    std::pmr::memory_resource *_upstream;
+    size_t _initial_chunk_size;
+    size_t _next_chunk_size;
+
+    chunk_type *_chunks = nullptr;
+    std::byte *_ptr = nullptr;
+    std::byte *_end = nullptr;
+
+    std::array<free_block_type *, nr_size_classes> _free_lists = {};
+
+    [[nodiscard]] static size_t size_class_of(size_t bytes) noexcept
+    {
+        return bytes == 0 ? 0 : (bytes - 1) / granularity;
+    }
+
+    [[nodiscard]] void *bump_allocate(size_t bytes, size_t alignment)
+    {
+        auto space = static_cast<size_t>(_end - _ptr);
+        void *ptr = _ptr;
+        if (not std::align(alignment, bytes, ptr, space)) {
+            allocate_chunk(bytes, alignment);
+
+            space = static_cast<size_t>(_end - _ptr);
+            ptr = _ptr;
+            [[maybe_unused]] ttlet aligned = std::align(alignment, bytes, ptr, space);
+            tt_axiom(aligned != nullptr);
+        }
+
+        _ptr = static_cast<std::byte *>(ptr) + bytes;
+        return ptr;
+    }
+
+    /** Allocate a chunk from upstream which can hold at least an allocation of the given size.
+     */
+    void allocate_chunk(size_t bytes, size_t alignment);
+};
+
+/** Select the memory resource for objects derived from `arena_allocated` on this thread.
+ *
+ * Scopes may be nested, the previous memory resource is restored when the scope ends.
+ */
+class arena_scope {
+public:
+    explicit arena_scope(std::pmr::memory_resource &resource) noexcept : _previous(std::exchange(_current, &resource)) {}
+
+    ~arena_scope()
+    {
+        _current = _previous;
+    }
+
+    arena_scope(arena_scope const &) = delete;
+    arena_scope(arena_scope &&) = delete;
+    arena_scope &operator=(arena_scope const &) = delete;
+    arena_scope &operator=(arena_scope &&) = delete;
+
+    /** The memory resource of the innermost scope on this thread, or the default memory resource.
+     */
+    [[nodiscard]] static std::pmr::memory_resource *current() noexcept
+    {
+        return _current != nullptr ? _current : std::pmr::get_default_resource();
+    }
+
+private:
+    std::pmr::memory_resource *_previous;
+
+    thread_local inline static std::pmr::memory_resource *_current = nullptr;
+};
+
+/** A base class for objects that are allocated from the memory resource of the current `arena_scope`.
+ *
+ * Each object remembers the memory resource it was allocated from, so that it can be deleted
+ * outside of the scope. The memory resource must outlive the object.
+ */
+struct arena_allocated {
+    [[nodiscard]] static void *operator new(size_t size)
+    {
+        auto *resource = arena_scope::current();
+        auto *header = static_cast<header_type *>(resource->allocate(sizeof(header_type) + size, alignof(header_type)));
+        header->resource = resource;
+        header->size = size;
+        return header + 1;
+    }
+
+    static void operator delete(void *ptr) noexcept
+    {
+        if (ptr != nullptr) {
+            auto *header = static_cast<header_type *>(ptr) - 1;
+            header->resource->deallocate(header, sizeof(header_type) + header->size, alignof(header_type));
+        }
+    }
+
+private:
+    struct alignas(std::max_align_t) header_type {
+        std::pmr::memory_resource *resource;
+        size_t size;
+    };
+};
+
+} // namespace tt
@@ -0,0 +1,122 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/arena_memory_resource.hpp"
+#include "ttauri/formula/formula.hpp"
+#include "ttauri/skeleton/skeleton.hpp"
+#include "ttauri/codec/JSON.hpp"
+#include <benchmark/benchmark.h>
+#include <format>
+#include <memory_resource>
+#include <string>
+
+using namespace tt;
+
+namespace {
+
+/** A memory resource which counts the number of allocations.
+ */
+class counting_memory_resource : public std::pmr::memory_resource {
+public:
+    int64_t count = 0;
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++count;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+[[nodiscard]] std::string large_formula()
+{
+    auto r = std::string{"0"};
+    for (auto i = 0; i != 1000; ++i) {
+        r += std::format(" + (a[{}] * {} - b.c)", i, i);
+    }
+    return r;
+}
+
+[[nodiscard]] std::string large_skeleton()
+{
+    auto r = std::string{};
+    for (auto i = 0; i != 500; ++i) {
+        r += std::format("line {} ${{a + {}}}\n#if a == {}\nmatched\n#else\n${{b * a}}\n#end\n", i, i, i);
+    }
+    return r;
+}
+
+[[nodiscard]] std::string large_JSON()
+{
+    auto r = std::string{"{"};
+    for (auto i = 0; i != 2000; ++i) {
+        r += std::format("\"key{}\": [{}, {}.5, \"value\", true, null, {{\"x\": {}}}],\n", i, i, i, i);
+    }
+    r += "}";
+    return r;
+}
+
+/** Parse with the memory resource of an arena, or with the counting resource directly.
+ * Returns the number of allocations from the counting resource.
+ */
+template<typename Parse>
+void parse_benchmark(benchmark::State &state, Parse const &parse)
+{
+    ttlet use_arena = state.range(0) != 0;
+    auto upstream = counting_memory_resource{};
+
+    for (auto _ : state) {
+        if (use_arena) {
+            auto arena = arena_memory_resource(64 * 1024, &upstream);
+            parse(arena);
+        } else {
+            parse(upstream);
+        }
+    }
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(upstream.count), benchmark::Counter::kAvgIterations);
+}
+
+} // namespace
+
+/** The argument selects parsing in an arena.
+ */
+static void arena_parse_formula(benchmark::State &state)
+{
+    ttlet text = large_formula();
+    parse_benchmark(state, [&](std::pmr::memory_resource &resource) {
+        auto e = parse_formula(text, resource);
+        benchmark::DoNotOptimize(e);
+    });
+}
+BENCHMARK(arena_parse_formula)->Arg(0)->Arg(1);
+
+static void arena_parse_skeleton(benchmark::State &state)
+{
+    ttlet text = large_skeleton();
+    parse_benchmark(state, [&](std::pmr::memory_resource &resource) {
+        auto e = parse_skeleton(URL("none:"), text, resource);
+        benchmark::DoNotOptimize(e);
+    });
+}
+BENCHMARK(arena_parse_skeleton)->Arg(0)->Arg(1);
+
+static void arena_parse_JSON(benchmark::State &state)
+{
+    ttlet text = large_JSON();
+    parse_benchmark(state, [&](std::pmr::memory_resource &resource) {
+        auto e = parse_JSON(text, resource);
+        benchmark::DoNotOptimize(e);
+    });
+}
+BENCHMARK(arena_parse_JSON)->Arg(0)->Arg(1);
@@ -0,0 +1,155 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/arena_memory_resource.hpp"
+#include "ttauri/formula/formula.hpp"
+#include "ttauri/tokenizer.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+namespace {
+
+/** A memory resource which counts the allocations that are outstanding.
+ */
+class counting_memory_resource : public std::pmr::memory_resource {
+public:
+    int count = 0;
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++count;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        --count;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+struct test_node : arena_allocated {
+    int value;
+    std::unique_ptr<test_node> next;
+
+    test_node(int value, std::unique_ptr<test_node> next = {}) : value(value), next(std::move(next)) {}
+};
+
+} // namespace
+
+TEST(arena_memory_resource, allocate_reuse)
+{
+    auto upstream = counting_memory_resource{};
+    auto arena = arena_memory_resource(4096, &upstream);
+
+    auto *a = arena.allocate(24);
+    auto *b = arena.allocate(24);
+    ASSERT_NE(a, b);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(a) % arena_memory_resource::granularity, 0);
+    ASSERT_EQ(upstream.count, 1);
+
+    // A deallocated block is reused for an allocation of the same size class.
+    arena.deallocate(a, 24);
+    ASSERT_EQ(arena.allocate(32), a);
+
+    arena.release();
+    ASSERT_EQ(upstream.count, 0);
+}
+
+TEST(arena_memory_resource, alignment_and_large)
+{
+    auto upstream = counting_memory_resource{};
+    auto arena = arena_memory_resource(256, &upstream);
+
+    auto *a = arena.allocate(10, 64);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(a) % 64, 0);
+
+    // Larger than a chunk.
+    auto *b = static_cast<std::byte *>(arena.allocate(100'000));
+    b[0] = std::byte{1};
+    b[99'999] = std::byte{2};
+
+    for (auto i = 0; i != 1000; ++i) {
+        arena.allocate(48);
+    }
+    ASSERT_GT(upstream.count, 2);
+
+    arena.release();
+    ASSERT_EQ(upstream.count, 0);
+}
+
+TEST(arena_memory_resource, pmr_vector)
+{
+    auto upstream = counting_memory_resource{};
+    auto arena = arena_memory_resource(4096, &upstream);
+
+    {
+        auto v = std::pmr::vector<int>(&arena);
+        for (auto i = 0; i != 10'000; ++i) {
+            v.push_back(i);
+        }
+        ASSERT_EQ(v[9'999], 9'999);
+    }
+    ASSERT_GT(upstream.count, 0);
+}
+
+TEST(arena_memory_resource, arena_allocated)
+{
+    auto upstream = counting_memory_resource{};
+    auto arena = arena_memory_resource(4096, &upstream);
+
+    auto list = std::unique_ptr<test_node>{};
+    {
+        auto scope = arena_scope(arena);
+        for (auto i = 0; i != 100; ++i) {
+            list = std::make_unique<test_node>(i, std::move(list));
+        }
+    }
+    ASSERT_EQ(upstream.count, 1);
+
+    // Objects outside of a scope are allocated from the default memory resource.
+    auto other = std::make_unique<test_node>(-1);
+    ASSERT_EQ(upstream.count, 1);
+
+    // Deleted outside of the scope.
+    ASSERT_EQ(list->value, 99);
+    list.reset();
+    other.reset();
+}
+
+TEST(arena_memory_resource, parse_tokens)
+{
+    auto counter = counting_memory_resource{};
+    {
+        // The name is too long for the small string optimization.
+        auto tokens = parseTokens("a_name_that_is_longer_than_a_small_string + 1", &counter);
+        ASSERT_EQ(tokens.size(), 4);
+        ASSERT_EQ(tokens[0].value.get_allocator().resource(), &counter);
+        ASSERT_GE(counter.count, 2);
+    }
+    ASSERT_EQ(counter.count, 0);
+}
+
+TEST(arena_memory_resource, parse_formula)
+{
+    auto arena = arena_memory_resource{};
+    auto e = parse_formula("(1 + 2) * 3", arena);
+    ASSERT_EQ(e->string(), "((1 + 2) * 3)");
+
+    auto context = formula_evaluation_context{};
+    ASSERT_EQ(e->evaluate(context), 9);
+}
@@ -7,6 +7,11 @@
 #include "pixel_map.inl"
 #include "memory.hpp"
 #include <optional>
+#include <span>
+#include <cstring>
+#if defined(TT_X86_64_V2)
+#include <immintrin.h>
+#endif
 
 namespace tt {
 
@@ -273,13 +278,211 @@ static void fillRow(pixel_row<uint8_t> row, int const rowY, std::vector<bezier_c
     }
 }
 
-void fill(pixel_map<uint8_t> &image, std::vector<bezier_curve> const &curves) noexcept
+static void fill_super_sample(pixel_map<uint8_t> &image, std::vector<bezier_curve> const &curves) noexcept
 {
     for (int rowNr = 0; rowNr < image.height(); rowNr++) {
         fillRow(image.at(rowNr), rowNr, curves);
     }
 }
 
+/** A line-segment of a flattened path, directed from low-y to high-y.
+ */
+struct coverage_edge {
+    float x0; //!< The x coordinate at y0.
+    float y0; //!< The lowest y coordinate of the line-segment.
+    float y1; //!< The highest y coordinate of the line-segment.
+    float dxdy; //!< The change in x for each unit of y.
+    float direction; //!< 1.0 when the original line-segment was going up, -1.0 when going down.
+};
+
+static void flatten_line(std::vector<coverage_edge> &r, point2 const P1, point2 const P2) noexcept
+{
+    if (P1.y() == P2.y()) {
+        // Horizontal lines do not change the coverage.
+        return;
+    } else if (P1.y() < P2.y()) {
+        r.push_back({P1.x(), P1.y(), P2.y(), (P2.x() - P1.x()) / (P2.y() - P1.y()), 1.0f});
+    } else {
+        r.push_back({P2.x(), P2.y(), P1.y(), (P1.x() - P2.x()) / (P1.y() - P2.y()), -1.0f});
+    }
+}
+
+/** Flatten a curve into line-segments.
+ * @see bezier_curve::flattenSegmentCount()
+ */
+static void flatten_curve(std::vector<coverage_edge> &r, bezier_curve const &curve, float const tolerance) noexcept
+{
+    if (curve.type == bezier_curve::Type::Linear) {
+        return flatten_line(r, curve.P1, curve.P2);
+    }
+
+    ttlet nr_segments = curve.flattenSegmentCount(tolerance);
+    ttlet step = 1.0f / static_cast<float>(nr_segments);
+
+    auto P = curve.P1;
+    for (int i = 1; i != nr_segments; ++i) {
+        ttlet next_P = curve.pointAt(static_cast<float>(i) * step);
+        flatten_line(r, P, next_P);
+        P = next_P;
+    }
+    flatten_line(r, P, curve.P2);
+}
+
+/** Accumulate the signed area of the part of an edge that crosses a row.
+ * Based on the accumulation rasterizer from font-rs by Raph Levien.
+ *
+ * @param accumulator The accumulation buffer of a row, two entries wider than the row.
+ * @param edge The edge to accumulate.
+ * @param row_y The y coordinate of the bottom of the row.
+ */
+static void accumulate_edge(std::span<float> accumulator, coverage_edge const &edge, float const row_y) noexcept
+{
+    ttlet y_bottom = std::max(edge.y0, row_y);
+    ttlet y_top = std::min(edge.y1, row_y + 1.0f);
+    ttlet dy = y_top - y_bottom;
+    if (dy <= 0.0f) {
+        return;
+    }
+
+    // Clamp the x coordinates to the image, area left of the image will be accumulated in
+    // the left most pixel, and the area right of the image in the extra entries of the accumulator.
+    ttlet max_x = static_cast<float>(std::ssize(accumulator) - 2);
+    ttlet xa = std::clamp(edge.x0 + (y_bottom - edge.y0) * edge.dxdy, 0.0f, max_x);
+    ttlet xb = std::clamp(edge.x0 + (y_top - edge.y0) * edge.dxdy, 0.0f, max_x);
+    ttlet x0 = std::min(xa, xb);
+    ttlet x1 = std::max(xa, xb);
+    ttlet d = dy * edge.direction;
+
+    ttlet x0_floor = std::floor(x0);
+    ttlet x0_int = static_cast<ssize_t>(x0_floor);
+    ttlet x1_ceil = std::ceil(x1);
+    ttlet x1_int = static_cast<ssize_t>(x1_ceil);
+
+    if (x1_int <= x0_int + 1) {
+        // The edge is inside a single pixel.
+        ttlet x_mid = 0.5f * (xa + xb) - x0_floor;
+        accumulator[x0_int] += d - d * x_mid;
+        accumulator[x0_int + 1] += d * x_mid;
+
+    } else {
+        ttlet s = 1.0f / (x1 - x0);
+        ttlet x0_fraction = x0 - x0_floor;
+        ttlet a0 = 0.5f * s * (1.0f - x0_fraction) * (1.0f - x0_fraction);
+        ttlet x1_fraction = x1 - x1_ceil + 1.0f;
+        ttlet am = 0.5f * s * x1_fraction * x1_fraction;
+
+        accumulator[x0_int] += d * a0;
+        if (x1_int == x0_int + 2) {
+            accumulator[x0_int + 1] += d * (1.0f - a0 - am);
+        } else {
+            ttlet a1 = s * (1.5f - x0_fraction);
+            accumulator[x0_int + 1] += d * (a1 - a0);
+            for (auto x = x0_int + 2; x < x1_int - 1; ++x) {
+                accumulator[x] += d * s;
+            }
+            ttlet a2 = a1 + static_cast<float>(x1_int - x0_int - 3) * s;
+            accumulator[x1_int - 1] += d * (1.0f - a2 - am);
+        }
+        accumulator[x1_int] += d * am;
+    }
+}
+
+/** Convert the accumulated signed area of a row into coverage.
+ * The prefix sum over the accumulator is the signed coverage of each pixel, which
+ * is added with saturation to the pixels in the row.
+ */
+static void accumulate_row(pixel_row<uint8_t> row, std::span<float const> accumulator) noexcept
+{
+    ttlet width = row.width();
+    auto pixels = row.data();
+
+    ssize_t x = 0;
+    auto coverage = 0.0f;
+
+#if defined(TT_X86_64_V2)
+    ttlet abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fff'ffff));
+    ttlet one = _mm_set1_ps(1.0f);
+    ttlet scale = _mm_set1_ps(255.0f);
+    ttlet pack_mask = _mm_set1_epi32(0x0c08'0400);
+
+    auto offset = _mm_setzero_ps();
+    for (; x + 4 <= width; x += 4) {
+        // Prefix sum of 4 floats, then add the running total.
+        auto sum = _mm_loadu_ps(accumulator.data() + x);
+        sum = _mm_add_ps(sum, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(sum), 4)));
+        sum = _mm_add_ps(sum, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(sum), 8)));
+        sum = _mm_add_ps(sum, offset);
+        offset = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3));
+
+        ttlet coverage_f32 = _mm_mul_ps(_mm_min_ps(_mm_and_ps(sum, abs_mask), one), scale);
+        ttlet coverage_u8 = _mm_shuffle_epi8(_mm_cvtps_epi32(coverage_f32), pack_mask);
+
+        int32_t dst_pixels;
+        std::memcpy(&dst_pixels, pixels + x, sizeof(dst_pixels));
+        dst_pixels = _mm_cvtsi128_si32(_mm_adds_epu8(_mm_cvtsi32_si128(dst_pixels), coverage_u8));
+        std::memcpy(pixels + x, &dst_pixels, sizeof(dst_pixels));
+    }
+    coverage = _mm_cvtss_f32(offset);
+#endif
+
+    for (; x != width; ++x) {
+        coverage += accumulator[x];
+        ttlet pixel_coverage = static_cast<int>(std::min(std::abs(coverage), 1.0f) * 255.0f + 0.5f);
+        pixels[x] = static_cast<uint8_t>(std::min(pixels[x] + pixel_coverage, 255));
+    }
+}
+
+static void fill_accumulate(pixel_map<uint8_t> &image, std::vector<bezier_curve> const &curves) noexcept
+{
+    constexpr auto tolerance = 0.05f;
+
+    auto edges = std::vector<coverage_edge>{};
+    edges.reserve(curves.size() * 4);
+    for (ttlet &curve : curves) {
+        flatten_curve(edges, curve, tolerance);
+    }
+    std::sort(edges.begin(), edges.end(), [](ttlet &lhs, ttlet &rhs) {
+        return lhs.y0 < rhs.y0;
+    });
+
+    auto accumulator = std::vector<float>(narrow_cast<size_t>(image.width() + 2), 0.0f);
+    auto active_edges = std::vector<coverage_edge const *>{};
+
+    auto next_edge = edges.cbegin();
+    for (ssize_t row_nr = 0; row_nr != image.height(); ++row_nr) {
+        ttlet row_y = static_cast<float>(row_nr);
+
+        // Retire edges below this row, and activate the edges that start in this row.
+        std::erase_if(active_edges, [row_y](ttlet edge) {
+            return edge->y1 <= row_y;
+        });
+        for (; next_edge != edges.cend() and next_edge->y0 < row_y + 1.0f; ++next_edge) {
+            if (next_edge->y1 > row_y) {
+                active_edges.push_back(&*next_edge);
+            }
+        }
+
+        if (active_edges.empty()) {
+            continue;
+        }
+
+        for (ttlet edge : active_edges) {
+            accumulate_edge(accumulator, *edge, row_y);
+        }
+        accumulate_row(image[row_nr], accumulator);
+        std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    }
+}
+
+void fill(pixel_map<uint8_t> &image, std::vector<bezier_curve> const &curves, fill_algorithm algorithm) noexcept
+{
+    switch (algorithm) {
+    case fill_algorithm::super_sample: fill_super_sample(image, curves); break;
+    case fill_algorithm::accumulate: fill_accumulate(image, curves); break;
+    default: tt_no_default();
+    }
+}
+
 
  [[nodiscard]] static float generate_sdf_r8_pixel(point2 point, std::vector<bezier_curve> const &curves) noexcept
 {
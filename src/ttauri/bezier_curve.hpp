@@ -16,6 +16,8 @@
 #include <tuple>
 #include <limits>
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
 namespace tt {
 
@@ -23,6 +25,19 @@ struct bezier_point;
 
 enum class LineJoinStyle { Bevel, Miter, Rounded };
 
+/** The algorithm used to rasterize the coverage of curves into a gray scale image.
+ */
+enum class fill_algorithm {
+    /** Solve every curve for 5 vertical sub-samples per row.
+     * Horizontal anti-aliasing is only done on the start and end pixel of each span.
+     */
+    super_sample,
+
+    /** Flatten the curves once and accumulate the exact signed area covered by each pixel.
+     */
+    accumulate
+};
+
 /*! Bezier Curve
  * A linear, quadratic or cubic bezier curve.
  */
@@ -264,6 +279,49 @@ struct bezier_curve {
         return r;
     }
 
+    /** Calculate the number of line-segments needed to approximate the curve.
+     * The number of line-segments is calculated using Wang's formula, so that
+     * the line-segments never deviate more than tolerance from the curve.
+     *
+     * @param tolerance The maximum distance between the line-segments and the curve.
+     * @return The number of line-segments, between 1 and 256.
+     */
+    [[nodiscard]] int flattenSegmentCount(float const tolerance) const noexcept
+    {
+        auto r = 1;
+        switch (type) {
+        case Type::Linear: return 1;
+        case Type::Quadratic: {
+            ttlet dd = hypot((P1 - C1) + (P2 - C1));
+            r = static_cast<int>(std::ceil(std::sqrt(0.25f * dd / tolerance)));
+        } break;
+        case Type::Cubic: {
+            ttlet dd1 = hypot((P1 - C1) + (C2 - C1));
+            ttlet dd2 = hypot((C1 - C2) + (P2 - C2));
+            r = static_cast<int>(std::ceil(std::sqrt(0.75f * std::max(dd1, dd2) / tolerance)));
+        } break;
+        default: tt_no_default();
+        }
+        return std::clamp(r, 1, 256);
+    }
+
+    /** Flatten the curve into a polyline.
+     * The points of the polyline are appended to a vector; P1 is not appended, so that
+     * the curves of a contour can be flattened one after another into the same polyline.
+     *
+     * @param r The polyline to append the points to, ending with P2.
+     * @param tolerance The maximum distance between the polyline and the curve.
+     */
+    void flatten(std::vector<point2> &r, float const tolerance) const noexcept
+    {
+        ttlet nr_segments = flattenSegmentCount(tolerance);
+        ttlet step = 1.0f / static_cast<float>(nr_segments);
+        for (int i = 1; i != nr_segments; ++i) {
+            r.push_back(pointAt(static_cast<float>(i) * step));
+        }
+        r.push_back(P2);
+    }
+
     /*! Return the flatness of a curve.
      * \return 1.0 when completely flat, < 1.0 when curved.
      */
@@ -348,10 +406,16 @@ makeContourFromPoints(std::vector<bezier_point>::const_iterator first, std::vect
     float tolerance) noexcept;
 
 /** Fill a linear gray scale image by filling a curve with anti-aliasing.
+ * The coverage is added to the pixels already in the image.
+ *
  * @param image An alpha-channel image to make opaque where pixel is inside the contours
  * @param curves All curves of path, in no particular order.
+ * @param algorithm The algorithm used to calculate the coverage of each pixel.
  */
-void fill(pixel_map<uint8_t> &image, std::vector<bezier_curve> const &curves) noexcept;
+void fill(
+    pixel_map<uint8_t> &image,
+    std::vector<bezier_curve> const &curves,
+    fill_algorithm algorithm = fill_algorithm::super_sample) noexcept;
 
 /** Fill a signed distance field image from the given contour.
  * @param image An signed-distance-field which show distance toward the closest curve
@@ -0,0 +1,77 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/bezier_curve.hpp"
+#include "ttauri/graphic_path.hpp"
+#include "ttauri/pixel_map.inl"
+#include <benchmark/benchmark.h>
+
+using namespace tt;
+
+/** A glyph-like path made of quadratic curves, like a TrueType 'o'.
+ */
+[[nodiscard]] static graphic_path make_glyph_path(float size) noexcept
+{
+    auto path = graphic_path{};
+
+    auto contour = [&path](float x, float y, float w, float h) {
+        path.moveTo(point2{x + w * 0.5f, y});
+        path.quadraticCurveTo(point2{x + w, y}, point2{x + w, y + h * 0.5f});
+        path.quadraticCurveTo(point2{x + w, y + h}, point2{x + w * 0.5f, y + h});
+        path.quadraticCurveTo(point2{x, y + h}, point2{x, y + h * 0.5f});
+        path.quadraticCurveTo(point2{x, y}, point2{x + w * 0.5f, y});
+        path.closeContour();
+    };
+
+    contour(size * 0.1f, size * 0.1f, size * 0.8f, size * 0.8f);
+    // The inner contour runs in the opposite direction.
+    path.moveTo(point2{size * 0.5f, size * 0.25f});
+    path.quadraticCurveTo(point2{size * 0.25f, size * 0.25f}, point2{size * 0.25f, size * 0.5f});
+    path.quadraticCurveTo(point2{size * 0.25f, size * 0.75f}, point2{size * 0.5f, size * 0.75f});
+    path.quadraticCurveTo(point2{size * 0.75f, size * 0.75f}, point2{size * 0.75f, size * 0.5f});
+    path.quadraticCurveTo(point2{size * 0.75f, size * 0.25f}, point2{size * 0.5f, size * 0.25f});
+    path.closeContour();
+    return path;
+}
+
+[[nodiscard]] static graphic_path make_circle_path(float size) noexcept
+{
+    auto path = graphic_path{};
+    path.addCircle(point2{size * 0.5f, size * 0.5f}, size * 0.4f);
+    return path;
+}
+
+[[nodiscard]] static graphic_path make_rounded_rectangle_path(float size) noexcept
+{
+    auto path = graphic_path{};
+    ttlet radius = size * 0.2f;
+    path.addRectangle(aarectangle{size * 0.1f, size * 0.1f, size * 0.8f, size * 0.8f}, corner_shapes{radius});
+    return path;
+}
+
+template<fill_algorithm Algorithm>
+static void fill_benchmark(benchmark::State &state, graphic_path (*make_path)(float))
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    ttlet curves = make_path(static_cast<float>(size)).getBeziers();
+
+    auto mask = pixel_map<uint8_t>(size, size);
+    for (auto _ : state) {
+        fill(mask);
+        fill(mask, curves, Algorithm);
+        benchmark::DoNotOptimize(mask[0].data());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_CAPTURE(fill_benchmark<fill_algorithm::super_sample>, glyph, make_glyph_path)->RangeMultiplier(2)->Range(16, 256);
+BENCHMARK_CAPTURE(fill_benchmark<fill_algorithm::accumulate>, glyph, make_glyph_path)->RangeMultiplier(2)->Range(16, 256);
+BENCHMARK_CAPTURE(fill_benchmark<fill_algorithm::super_sample>, circle, make_circle_path)->RangeMultiplier(2)->Range(16, 256);
+BENCHMARK_CAPTURE(fill_benchmark<fill_algorithm::accumulate>, circle, make_circle_path)->RangeMultiplier(2)->Range(16, 256);
+BENCHMARK_CAPTURE(fill_benchmark<fill_algorithm::super_sample>, rounded_rectangle, make_rounded_rectangle_path)
+    ->RangeMultiplier(2)
+    ->Range(16, 256);
+BENCHMARK_CAPTURE(fill_benchmark<fill_algorithm::accumulate>, rounded_rectangle, make_rounded_rectangle_path)
+    ->RangeMultiplier(2)
+    ->Range(16, 256);
@@ -0,0 +1,402 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "binary_log.hpp"
+#include "logger.hpp"
+#include "file.hpp"
+#include "exception.hpp"
+#include "counters.hpp"
+#include "hires_utc_clock.hpp"
+#include "cast.hpp"
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <new>
+
+namespace tt {
+
+[[nodiscard]] static constexpr uint64_t binary_log_align(uint64_t size) noexcept
+{
+    return (size + 7) & ~uint64_t{7};
+}
+
+/** Patch the size of a record, and pad the record to 8 bytes.
+ */
+static void binary_log_finish_record(std::vector<std::byte> &record) noexcept
+{
+    record.resize(binary_log_align(record.size()));
+    ttlet size = narrow_cast<uint32_t>(record.size());
+    std::memcpy(record.data(), &size, sizeof(size));
+}
+
+binary_log_writer::binary_log_writer(URL const &location, size_t ring_capacity, size_t dictionary_capacity) :
+    _view([&] {
+        ttlet total_size = binary_log_align(sizeof(binary_log_header)) + binary_log_align(dictionary_capacity) +
+            binary_log_align(ring_capacity);
+
+        // Grow the file to its full size before it is mapped.
+        auto f = file(location, access_mode::truncate_or_create_for_write | access_mode::read);
+        ttlet zero = std::byte{0};
+        f.write(&zero, 1, narrow_cast<ssize_t>(total_size - 1));
+        f.close();
+
+        return file_view(location, access_mode::open_for_read_and_write, 0, total_size);
+    }())
+{
+    auto bytes = _view.bytes();
+
+    _header = new (bytes.data()) binary_log_header{};
+    _header->version = binary_log_header::version_value;
+    _header->header_size = sizeof(binary_log_header);
+    _header->dictionary_offset = binary_log_align(sizeof(binary_log_header));
+    _header->dictionary_capacity = binary_log_align(dictionary_capacity);
+    _header->ring_offset = _header->dictionary_offset + _header->dictionary_capacity;
+    _header->ring_capacity = binary_log_align(ring_capacity);
+
+    _dictionary = bytes.subspan(_header->dictionary_offset, _header->dictionary_capacity);
+    _ring = bytes.subspan(_header->ring_offset, _header->ring_capacity);
+
+    // The magic is written last, so that a partially initialized file is not recognized.
+    std::atomic_thread_fence(std::memory_order::release);
+    _header->magic = binary_log_header::magic_value;
+}
+
+std::optional<uint32_t> binary_log_writer::find_or_add_format(binary_log_format const &format) noexcept
+{
+    ttlet[it, inserted] = _formats.try_emplace(&format);
+    if (not inserted) {
+        return it->second.id;
+    }
+
+    ttlet source_file_size = std::strlen(format.source_file);
+    ttlet format_size = std::strlen(format.format);
+
+    // Entry: header, uint32_t id, uint8_t level, uint8_t nr-arguments, uint16_t reserved,
+    // int32_t source-line, uint32_t source-file-size, uint32_t format-size, argument-types, source-file, format.
+    _record.clear();
+    detail::binary_log_append(_record, binary_log_record_header{0, binary_log_record_kind::format, 0});
+    detail::binary_log_append(_record, _next_format_id);
+    detail::binary_log_append(_record, format.level);
+    detail::binary_log_append(_record, narrow_cast<uint8_t>(format.argument_types.size()));
+    detail::binary_log_append(_record, uint16_t{0});
+    detail::binary_log_append(_record, narrow_cast<int32_t>(format.source_line));
+    detail::binary_log_append(_record, narrow_cast<uint32_t>(source_file_size));
+    detail::binary_log_append(_record, narrow_cast<uint32_t>(format_size));
+    for (ttlet type : format.argument_types) {
+        detail::binary_log_append(_record, type);
+    }
+    ttlet offset = _record.size();
+    _record.resize(offset + source_file_size + format_size);
+    std::memcpy(_record.data() + offset, format.source_file, source_file_size);
+    std::memcpy(_record.data() + offset + source_file_size, format.format, format_size);
+    binary_log_finish_record(_record);
+
+    ttlet dictionary_size = _header->dictionary_size.load(std::memory_order::relaxed);
+    if (dictionary_size + _record.size() > _dictionary.size()) {
+        // Messages from this log statement are written as text from now on.
+        increment_counter<"binary_log_dictionary_full">();
+        return it->second.id = std::nullopt;
+    }
+
+    std::memcpy(_dictionary.data() + dictionary_size, _record.data(), _record.size());
+    _header->dictionary_size.store(dictionary_size + _record.size(), std::memory_order::release);
+    return it->second.id = _next_format_id++;
+}
+
+void binary_log_writer::reserve(uint64_t head, uint64_t size) noexcept
+{
+    auto tail = _header->tail.load(std::memory_order::relaxed);
+    while (head + size - tail > _ring.size()) {
+        tt_axiom(tail != head);
+
+        binary_log_record_header record_header;
+        std::memcpy(&record_header, _ring.data() + tail % _ring.size(), sizeof(record_header));
+        tail += record_header.size;
+    }
+    _header->tail.store(tail, std::memory_order::release);
+}
+
+void binary_log_writer::write_record(std::span<std::byte const> record) noexcept
+{
+    if (record.size() > _ring.size() / 4) {
+        increment_counter<"binary_log_drop">();
+        return;
+    }
+
+    auto head = _header->head.load(std::memory_order::relaxed);
+
+    // A record is never split, the rest of the ring is filled with padding instead.
+    ttlet offset = head % _ring.size();
+    ttlet padding_size = _ring.size() - offset < record.size() ? _ring.size() - offset : 0;
+
+    reserve(head, padding_size + record.size());
+
+    if (padding_size != 0) {
+        ttlet padding = binary_log_record_header{narrow_cast<uint32_t>(padding_size), binary_log_record_kind::padding, 0};
+        std::memcpy(_ring.data() + offset, &padding, sizeof(padding));
+        head += padding_size;
+    }
+
+    std::memcpy(_ring.data() + head % _ring.size(), record.data(), record.size());
+    _header->head.store(head + record.size(), std::memory_order::release);
+}
+
+void binary_log_writer::write(detail::log_message_base const &message) noexcept
+{
+    ttlet &format = message.binary_format();
+    ttlet format_id = format.serializable ? find_or_add_format(format) : std::nullopt;
+
+    _record.clear();
+    if (format_id) {
+        ttlet &time_stamp = message.time_stamp();
+        ttlet utc = hires_utc_clock::make(time_stamp);
+
+        detail::binary_log_append(_record, binary_log_record_header{0, binary_log_record_kind::message, 0});
+        detail::binary_log_append(_record, *format_id);
+        detail::binary_log_append(_record, narrow_cast<int32_t>(time_stamp.cpu_id()));
+        detail::binary_log_append(_record, static_cast<uint64_t>(time_stamp.thread_id()));
+        detail::binary_log_append(_record, static_cast<int64_t>(utc.time_since_epoch().count()));
+        message.append_binary_arguments(_record);
+
+    } else {
+        ttlet text = message.format();
+        detail::binary_log_append(_record, binary_log_record_header{0, binary_log_record_kind::text, 0});
+        detail::binary_log_append_string(_record, text.data(), text.size());
+    }
+
+    binary_log_finish_record(_record);
+    write_record(_record);
+    increment_counter<"binary_log_write">(std::ssize(_record));
+}
+
+/** Read a value from a binary log.
+ * @throw parse_error When the value is outside of the bytes.
+ */
+template<typename T>
+[[nodiscard]] static T binary_log_read(std::span<std::byte const> bytes, size_t &offset)
+{
+    if (offset + sizeof(T) > bytes.size()) {
+        throw parse_error("binary log: Unexpected end of record at offset {}", offset);
+    }
+
+    T r;
+    std::memcpy(&r, bytes.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return r;
+}
+
+[[nodiscard]] static std::string binary_log_read_string(std::span<std::byte const> bytes, size_t &offset, size_t size)
+{
+    if (offset + size > bytes.size()) {
+        throw parse_error("binary log: Unexpected end of record at offset {}", offset);
+    }
+
+    auto r = std::string(reinterpret_cast<char const *>(bytes.data() + offset), size);
+    offset += size;
+    return r;
+}
+
+binary_log_reader::binary_log_reader(std::span<std::byte const> bytes) : _bytes(bytes)
+{
+    if (bytes.size() < sizeof(binary_log_header)) {
+        throw parse_error("binary log: File is too small");
+    }
+
+    _header = reinterpret_cast<binary_log_header const *>(bytes.data());
+    if (_header->magic != binary_log_header::magic_value) {
+        throw parse_error("binary log: Invalid magic");
+    }
+    if (_header->version != binary_log_header::version_value) {
+        throw parse_error("binary log: Unsupported version {}", _header->version);
+    }
+    if (_header->dictionary_offset + _header->dictionary_capacity > bytes.size() or
+        _header->ring_offset + _header->ring_capacity > bytes.size()) {
+        throw parse_error("binary log: The dictionary or ring is outside of the file");
+    }
+
+    ttlet dictionary_size = _header->dictionary_size.load(std::memory_order::acquire);
+    if (dictionary_size > _header->dictionary_capacity) {
+        throw parse_error("binary log: Dictionary size {} is larger than its capacity", dictionary_size);
+    }
+
+    ttlet dictionary = bytes.subspan(_header->dictionary_offset, dictionary_size);
+    auto offset = size_t{0};
+    while (offset != dictionary.size()) {
+        ttlet entry_offset = offset;
+        ttlet record_header = binary_log_read<binary_log_record_header>(dictionary, offset);
+        if (record_header.kind != binary_log_record_kind::format or record_header.size < sizeof(binary_log_record_header) or
+            entry_offset + record_header.size > dictionary.size()) {
+            throw parse_error("binary log: Invalid dictionary entry at offset {}", entry_offset);
+        }
+
+        ttlet id = binary_log_read<uint32_t>(dictionary, offset);
+        if (id != _formats.size()) {
+            throw parse_error("binary log: Unexpected format id {} at offset {}", id, entry_offset);
+        }
+
+        auto &entry = _formats.emplace_back();
+        entry.level = binary_log_read<log_level>(dictionary, offset);
+        ttlet nr_arguments = binary_log_read<uint8_t>(dictionary, offset);
+        [[maybe_unused]] ttlet reserved = binary_log_read<uint16_t>(dictionary, offset);
+        entry.source_line = binary_log_read<int32_t>(dictionary, offset);
+        ttlet source_file_size = binary_log_read<uint32_t>(dictionary, offset);
+        ttlet format_size = binary_log_read<uint32_t>(dictionary, offset);
+        for (auto i = 0; i != nr_arguments; ++i) {
+            entry.argument_types.push_back(binary_log_read<binary_log_argument_type>(dictionary, offset));
+        }
+        entry.source_file = binary_log_read_string(dictionary, offset, source_file_size);
+        entry.format = binary_log_read_string(dictionary, offset, format_size);
+
+        offset = entry_offset + record_header.size;
+    }
+}
+
+generator<std::string> binary_log_reader::lines() const
+{
+    ttlet ring = _bytes.subspan(_header->ring_offset, _header->ring_capacity);
+    ttlet head = _header->head.load(std::memory_order::acquire);
+
+    for (auto tail = _header->tail.load(std::memory_order::acquire); tail != head;) {
+        ttlet offset = tail % ring.size();
+        auto header_offset = offset;
+        ttlet record_header = binary_log_read<binary_log_record_header>(ring, header_offset);
+        if (record_header.size < sizeof(binary_log_record_header) or record_header.size % 8 != 0 or
+            offset + record_header.size > ring.size() or tail + record_header.size > head) {
+            throw parse_error("binary log: Invalid record size at offset {}", offset);
+        }
+
+        if (record_header.kind != binary_log_record_kind::padding) {
+            co_yield format_record(ring.subspan(offset, record_header.size));
+        }
+        tail += record_header.size;
+    }
+}
+
+std::string binary_log_reader::format_record(std::span<std::byte const> record) const
+{
+    auto offset = size_t{0};
+    ttlet record_header = binary_log_read<binary_log_record_header>(record, offset);
+
+    if (record_header.kind == binary_log_record_kind::text) {
+        ttlet size = binary_log_read<uint32_t>(record, offset);
+        return binary_log_read_string(record, offset, size);
+
+    } else if (record_header.kind != binary_log_record_kind::message) {
+        throw parse_error("binary log: Unknown record kind {}", static_cast<int>(record_header.kind));
+    }
+
+    ttlet format_id = binary_log_read<uint32_t>(record, offset);
+    if (format_id >= _formats.size()) {
+        throw parse_error("binary log: Unknown format id {}", format_id);
+    }
+    ttlet &entry = _formats[format_id];
+
+    ttlet cpu_id = binary_log_read<int32_t>(record, offset);
+    ttlet thread_id = binary_log_read<uint64_t>(record, offset);
+    ttlet utc = hires_utc_clock::time_point{hires_utc_clock::duration{binary_log_read<int64_t>(record, offset)}};
+
+    auto args = std::vector<argument_type>{};
+    for (ttlet type : entry.argument_types) {
+        switch (type) {
+        case binary_log_argument_type::boolean: args.emplace_back(binary_log_read<uint8_t>(record, offset) != 0); break;
+        case binary_log_argument_type::character: args.emplace_back(binary_log_read<char>(record, offset)); break;
+        case binary_log_argument_type::signed_integer: args.emplace_back(binary_log_read<int64_t>(record, offset)); break;
+        case binary_log_argument_type::unsigned_integer: args.emplace_back(binary_log_read<uint64_t>(record, offset)); break;
+        case binary_log_argument_type::float32: args.emplace_back(binary_log_read<float>(record, offset)); break;
+        case binary_log_argument_type::float64: args.emplace_back(binary_log_read<double>(record, offset)); break;
+        case binary_log_argument_type::string: {
+            ttlet size = binary_log_read<uint32_t>(record, offset);
+            args.emplace_back(binary_log_read_string(record, offset, size));
+        } break;
+        default: throw parse_error("binary log: Unknown argument type {}", static_cast<int>(type));
+        }
+    }
+
+    ttlet local_timestring = format_iso8601(utc);
+    ttlet text = format(entry.format, args);
+    if (static_cast<bool>(entry.level & log_level::statistics)) {
+        return std::format("{} {:5} {} tid={} cpu={}\n", local_timestring, to_const_string(entry.level), text, thread_id, cpu_id);
+    } else {
+        return std::format(
+            "{} {:5} {} ({}:{}) tid={} cpu={}\n",
+            local_timestring,
+            to_const_string(entry.level),
+            text,
+            entry.source_file,
+            entry.source_line,
+            thread_id,
+            cpu_id);
+    }
+}
+
+/** Format a single replacement field.
+ * @return The formatted argument, or empty when the argument could not be formatted.
+ */
+[[nodiscard]] static std::optional<std::string>
+binary_log_format_argument(std::string_view spec, binary_log_reader::argument_type const &arg) noexcept
+{
+    try {
+        ttlet fmt = std::format("{{:{}}}", spec);
+        return std::visit(
+            [&fmt](auto const &value) {
+                return std::vformat(fmt, std::make_format_args(value));
+            },
+            arg);
+    } catch (...) {
+        return {};
+    }
+}
+
+std::string binary_log_reader::format(std::string_view fmt, std::vector<argument_type> const &args)
+{
+    auto r = std::string{};
+    auto next_index = size_t{0};
+
+    for (auto i = size_t{0}; i != fmt.size(); ++i) {
+        ttlet c = fmt[i];
+        if (c == '}') {
+            // Unescape "}}".
+            r += c;
+            if (i + 1 != fmt.size() and fmt[i + 1] == '}') {
+                ++i;
+            }
+            continue;
+
+        } else if (c != '{') {
+            r += c;
+            continue;
+
+        } else if (i + 1 != fmt.size() and fmt[i + 1] == '{') {
+            r += c;
+            ++i;
+            continue;
+        }
+
+        ttlet end = fmt.find('}', i);
+        if (end == std::string_view::npos) {
+            r += fmt.substr(i);
+            break;
+        }
+
+        ttlet field = fmt.substr(i + 1, end - i - 1);
+        ttlet colon = field.find(':');
+        ttlet id = field.substr(0, colon);
+        ttlet spec = colon == std::string_view::npos ? std::string_view{} : field.substr(colon + 1);
+
+        auto index = next_index++;
+        if (not id.empty()) {
+            ttlet[ptr, ec] = std::from_chars(id.data(), id.data() + id.size(), index);
+            if (ec != std::errc{} or ptr != id.data() + id.size()) {
+                index = args.size();
+            }
+        }
+
+        ttlet formatted = index < args.size() ? binary_log_format_argument(spec, args[index]) : std::nullopt;
+        r += formatted ? *formatted : std::string{fmt.substr(i, end - i + 1)};
+        i = end;
+    }
+    return r;
+}
+
+} // namespace tt
@@ -0,0 +1,197 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "binary_log_format.hpp"
+#include "file_view.hpp"
+#include "coroutine.hpp"
+#include "URL.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace tt {
+namespace detail {
+class log_message_base;
+}
+
+/** The header at the start of a binary log file.
+ *
+ * A binary log file consists of:
+ *  - The header.
+ *  - The dictionary: an append-only list of `binary_log_format` descriptions.
+ *  - The ring: a ring buffer with a record for each message, the oldest records
+ *    are overwritten when the ring is full.
+ *
+ * All values are stored in the native byte order of the machine that wrote the log.
+ */
+struct binary_log_header {
+    static constexpr auto magic_value = std::array<char, 8>{'t', 't', 'b', 'l', 'o', 'g', '\r', '\n'};
+    static constexpr uint32_t version_value = 1;
+
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t header_size;
+
+    uint64_t dictionary_offset;
+    uint64_t dictionary_capacity;
+
+    /** The number of bytes used in the dictionary.
+     */
+    std::atomic<uint64_t> dictionary_size;
+
+    uint64_t ring_offset;
+    uint64_t ring_capacity;
+
+    /** The total number of bytes written to the ring.
+     */
+    std::atomic<uint64_t> head;
+
+    /** The total number of bytes written to the ring, before the oldest record.
+     */
+    std::atomic<uint64_t> tail;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(sizeof(binary_log_header) == 72);
+
+/** The kind of a record in the ring of a binary log.
+ */
+enum class binary_log_record_kind : uint16_t {
+    /** Unused bytes until the end of the ring. */
+    padding = 0,
+
+    /** A message with: uint32_t format-id, int32_t cpu-id, uint64_t thread-id,
+     * int64_t nanoseconds since the UTC epoch, followed by the arguments.
+     */
+    message = 1,
+
+    /** A message that was formatted when it was written: uint32_t length, followed by the text. */
+    text = 2,
+
+    /** An entry in the dictionary, see `binary_log_writer::find_or_add_format()`. */
+    format = 3,
+};
+
+/** The header of each record in the ring, and of each entry in the dictionary.
+ * Records are aligned to 8 bytes.
+ */
+struct binary_log_record_header {
+    uint32_t size;
+    binary_log_record_kind kind;
+    uint16_t reserved;
+};
+
+/** Writes log messages to a memory mapped binary log file.
+ *
+ * Messages are stored without formatting; the format string and argument types
+ * are stored once per log statement in the dictionary of the file. Messages with arguments
+ * that can not be stored in binary form are formatted and stored as text.
+ *
+ * Because the file is memory mapped, the messages survive a crash of the application.
+ * Use `binary_log_reader` to format the messages afterwards.
+ *
+ * This class is not thread-safe, it is used by the logger thread while holding the logger mutex.
+ */
+class binary_log_writer {
+public:
+    /** Create a new binary log file.
+     *
+     * @param location The location of the file, an existing file is overwritten.
+     * @param ring_capacity The size of the ring buffer with messages in bytes.
+     * @param dictionary_capacity The size reserved for the descriptions of the log statements in bytes.
+     * @throw io_error When the file could not be created.
+     */
+    binary_log_writer(URL const &location, size_t ring_capacity, size_t dictionary_capacity = 1024 * 1024);
+
+    binary_log_writer(binary_log_writer const &) = delete;
+    binary_log_writer(binary_log_writer &&) = delete;
+    binary_log_writer &operator=(binary_log_writer const &) = delete;
+    binary_log_writer &operator=(binary_log_writer &&) = delete;
+
+    /** Write a message to the log.
+     */
+    void write(detail::log_message_base const &message) noexcept;
+
+private:
+    struct format_entry {
+        /** The id of the format, or empty when the dictionary is full.
+         */
+        std::optional<uint32_t> id;
+    };
+
+    file_view _view;
+    binary_log_header *_header;
+    std::span<std::byte> _dictionary;
+    std::span<std::byte> _ring;
+
+    /** The formats that were written to the dictionary, by the address of the `binary_log_format`.
+     */
+    std::unordered_map<binary_log_format const *, format_entry> _formats;
+    uint32_t _next_format_id = 0;
+
+    /** A buffer for the record that is being written, reused to reduce allocations.
+     */
+    std::vector<std::byte> _record;
+
+    [[nodiscard]] std::optional<uint32_t> find_or_add_format(binary_log_format const &format) noexcept;
+
+    /** Remove the oldest records from the ring until there is room for size bytes.
+     */
+    void reserve(uint64_t head, uint64_t size) noexcept;
+
+    void write_record(std::span<std::byte const> record) noexcept;
+};
+
+/** Reads and formats the messages from a binary log file.
+ */
+class binary_log_reader {
+public:
+    using argument_type = std::variant<bool, char, int64_t, uint64_t, float, double, std::string>;
+
+    /** Open a binary log.
+     * @param bytes The bytes of a binary log file, which must remain valid while reading.
+     * @throw parse_error When the data is not a binary log file.
+     */
+    explicit binary_log_reader(std::span<std::byte const> bytes);
+
+    /** Read the messages in the log, from oldest to newest.
+     *
+     * @return Each message formatted as a line of text, like the messages written to the console.
+     * @throw parse_error When a record is corrupt.
+     */
+    [[nodiscard]] generator<std::string> lines() const;
+
+    /** Format a message, like `std::format()` but with arguments known at run time.
+     *
+     * @param fmt The format string.
+     * @param args The arguments.
+     * @return The formatted text.
+     */
+    [[nodiscard]] static std::string format(std::string_view fmt, std::vector<argument_type> const &args);
+
+private:
+    struct format_entry {
+        log_level level;
+        int source_line;
+        std::string source_file;
+        std::string format;
+        std::vector<binary_log_argument_type> argument_types;
+    };
+
+    std::span<std::byte const> _bytes;
+    binary_log_header const *_header;
+    std::vector<format_entry> _formats;
+
+    [[nodiscard]] std::string format_record(std::span<std::byte const> record) const;
+};
+
+} // namespace tt
@@ -0,0 +1,142 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "log_level.hpp"
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace tt {
+
+/** The type of an argument of a log message stored in a binary log.
+ */
+enum class binary_log_argument_type : uint8_t {
+    boolean = 1, ///< A bool stored as a single byte.
+    character = 2, ///< A char stored as a single byte.
+    signed_integer = 3, ///< A signed integer stored as a int64_t.
+    unsigned_integer = 4, ///< An unsigned integer stored as a uint64_t.
+    float32 = 5, ///< A float.
+    float64 = 6, ///< A double.
+    string = 7, ///< A uint32_t length followed by the UTF-8 characters.
+};
+
+/** Get the binary log argument type of a type.
+ * @return The argument type, or empty when the type can not be stored in a binary log.
+ */
+template<typename T>
+[[nodiscard]] constexpr std::optional<binary_log_argument_type> binary_log_argument_type_of() noexcept
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        return binary_log_argument_type::boolean;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return binary_log_argument_type::character;
+    } else if constexpr (std::is_integral_v<T> and std::is_signed_v<T>) {
+        return binary_log_argument_type::signed_integer;
+    } else if constexpr (std::is_integral_v<T> and std::is_unsigned_v<T>) {
+        return binary_log_argument_type::unsigned_integer;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return binary_log_argument_type::float32;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return binary_log_argument_type::float64;
+    } else if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, char const *>) {
+        return binary_log_argument_type::string;
+    } else {
+        return {};
+    }
+}
+
+/** The static description of a log message, shared by all messages logged from the same source line.
+ * The binary log writes this description once, after which each message only contains
+ * a reference to it and the raw bytes of the arguments.
+ */
+struct binary_log_format {
+    log_level level;
+    char const *source_file;
+    int source_line;
+    char const *format;
+
+    /** The types of each argument.
+     */
+    std::span<binary_log_argument_type const> argument_types;
+
+    /** True if all the arguments can be stored in a binary log.
+     * Otherwise the message is stored as text.
+     */
+    bool serializable;
+};
+
+namespace detail {
+
+template<typename T>
+void binary_log_append(std::vector<std::byte> &bytes, T const &value) noexcept
+{
+    ttlet offset = bytes.size();
+    bytes.resize(offset + sizeof(T));
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+inline void binary_log_append_string(std::vector<std::byte> &bytes, char const *str, size_t size) noexcept
+{
+    binary_log_append(bytes, static_cast<uint32_t>(size));
+    ttlet offset = bytes.size();
+    bytes.resize(offset + size);
+    std::memcpy(bytes.data() + offset, str, size);
+}
+
+/** Append the bytes of a single argument of a log message.
+ */
+template<typename T>
+void binary_log_append_argument(std::vector<std::byte> &bytes, T const &value) noexcept
+{
+    constexpr auto type = binary_log_argument_type_of<T>();
+    static_assert(type.has_value());
+
+    if constexpr (*type == binary_log_argument_type::boolean) {
+        binary_log_append(bytes, static_cast<uint8_t>(value));
+    } else if constexpr (*type == binary_log_argument_type::character) {
+        binary_log_append(bytes, value);
+    } else if constexpr (*type == binary_log_argument_type::signed_integer) {
+        binary_log_append(bytes, static_cast<int64_t>(value));
+    } else if constexpr (*type == binary_log_argument_type::unsigned_integer) {
+        binary_log_append(bytes, static_cast<uint64_t>(value));
+    } else if constexpr (std::is_same_v<T, char const *>) {
+        binary_log_append_string(bytes, value, std::strlen(value));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        binary_log_append_string(bytes, value.data(), value.size());
+    } else {
+        binary_log_append(bytes, value);
+    }
+}
+
+/** Append the bytes of all the arguments of a log message.
+ */
+template<typename... Values>
+void binary_log_append_arguments(std::vector<std::byte> &bytes, std::tuple<Values...> const &values) noexcept
+{
+    std::apply(
+        [&bytes](auto const &...value) {
+            (binary_log_append_argument(bytes, value), ...);
+        },
+        values);
+}
+
+template<typename... Values>
+constexpr bool binary_log_serializable = (binary_log_argument_type_of<Values>().has_value() and ...);
+
+template<typename... Values>
+constexpr auto binary_log_argument_types = std::array<binary_log_argument_type, sizeof...(Values)>{
+    binary_log_argument_type_of<Values>().value_or(binary_log_argument_type{})...};
+
+} // namespace detail
+} // namespace tt
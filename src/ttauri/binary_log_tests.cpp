@@ -0,0 +1,101 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/binary_log.hpp"
+#include "ttauri/logger.hpp"
+#include "ttauri/file_view.hpp"
+#include "ttauri/exception.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+/** Remove the timestamp from the start of a log line.
+ */
+[[nodiscard]] static std::string strip_time_stamp(std::string const &line)
+{
+    return line.substr(line.find(' ') + 1);
+}
+
+[[nodiscard]] static std::vector<std::string> read_lines(URL const &location)
+{
+    ttlet view = file_view(location);
+    ttlet reader = binary_log_reader(view.bytes());
+
+    auto r = std::vector<std::string>{};
+    for (ttlet &line : reader.lines()) {
+        r.push_back(line);
+    }
+    return r;
+}
+
+TEST(binary_log, format)
+{
+    using args = std::vector<binary_log_reader::argument_type>;
+
+    ASSERT_EQ(binary_log_reader::format("hello", args{}), "hello");
+    ASSERT_EQ(binary_log_reader::format("{} {}", args{int64_t{-5}, std::string{"world"}}), "-5 world");
+    ASSERT_EQ(binary_log_reader::format("{1}-{0}", args{'a', true}), "true-a");
+    ASSERT_EQ(binary_log_reader::format("{:>4}|{:.2f}", args{uint64_t{7}, 3.14159}), "   7|3.14");
+    ASSERT_EQ(binary_log_reader::format("{{}} }}", args{}), "{} }");
+
+    // Fields that can not be formatted are copied verbatim.
+    ASSERT_EQ(binary_log_reader::format("{} {}", args{int64_t{1}}), "1 {}");
+    ASSERT_EQ(binary_log_reader::format("{:q}", args{int64_t{1}}), "{:q}");
+}
+
+TEST(binary_log, round_trip)
+{
+    ttlet location = URL("file:binary_log_test1.bin");
+
+    ttlet message1 = detail::log_message<log_level::info, "a.cpp", 12, "hello {} {:>4} {:.2f} {}", int, unsigned int, double, std::string>(
+        -5, 7u, 3.14159, std::string("world"));
+    ttlet message2 = detail::log_message<log_level::statistics, "b.cpp", 3, "{1}-{0}", char, bool>('c', true);
+    ttlet message3 = detail::log_message<log_level::warning, "c.cpp", 4, "{}", URL>(location);
+
+    {
+        auto writer = binary_log_writer(location, 4096);
+        writer.write(message1);
+        writer.write(message2);
+        writer.write(message3);
+        writer.write(message1);
+    }
+
+    ttlet lines = read_lines(location);
+    ASSERT_EQ(lines.size(), 4);
+    ASSERT_EQ(strip_time_stamp(lines[0]), strip_time_stamp(message1.format()));
+    ASSERT_EQ(strip_time_stamp(lines[1]), strip_time_stamp(message2.format()));
+    // An URL can not be stored as binary, so it is stored as text.
+    ASSERT_EQ(lines[2], message3.format());
+    ASSERT_EQ(lines[3], lines[0]);
+}
+
+TEST(binary_log, wrap_around)
+{
+    ttlet location = URL("file:binary_log_test2.bin");
+
+    {
+        auto writer = binary_log_writer(location, 1024);
+        for (auto i = 0; i != 1000; ++i) {
+            writer.write(detail::log_message<log_level::info, "a.cpp", 1, "message {}", int>(i));
+        }
+    }
+
+    // Only the newest messages remain, in order.
+    ttlet lines = read_lines(location);
+    ASSERT_GT(lines.size(), 10);
+    auto expected = 1000 - std::ssize(lines);
+    for (ttlet &line : lines) {
+        ASSERT_NE(line.find(std::format("message {} ", expected++)), std::string::npos);
+    }
+}
+
+TEST(binary_log, invalid)
+{
+    auto bytes = std::vector<std::byte>(1024);
+    ASSERT_THROW(binary_log_reader{bytes}, parse_error);
+}
@@ -148,9 +148,9 @@ struct parse_context_t {
     }
 }
 
-[[nodiscard]] datum parse_JSON(std::string_view text)
+[[nodiscard]] datum parse_JSON(std::string_view text, std::pmr::memory_resource &resource)
 {
-    token_vector tokens = parseTokens(text);
+    token_vector tokens = parseTokens(text, &resource);
 
     datum root;
 
@@ -175,6 +175,11 @@ struct parse_context_t {
     return root;
 }
 
+[[nodiscard]] datum parse_JSON(std::string_view text)
+{
+    return parse_JSON(text, *std::pmr::get_default_resource());
+}
+
 [[nodiscard]] datum parse_JSON(URL const &url)
 {
     return parse_JSON(url.loadView()->string_view());
@@ -16,6 +16,7 @@
 #include <string_view>
 #include <vector>
 #include <optional>
+#include <memory_resource>
 
 namespace tt {
 
@@ -25,6 +26,13 @@ namespace tt {
  */
 [[nodiscard]] datum parse_JSON(std::string_view text);
 
+/** Parse a JSON string.
+ * @param text The text to parse.
+ * @param resource The memory resource for the temporary allocations of the parser.
+ * @return A datum representing the parsed object.
+ */
+[[nodiscard]] datum parse_JSON(std::string_view text, std::pmr::memory_resource &resource);
+
 /** Parse a JSON string.
  * @param file URL pointing to the file to parse.
  * @return A datum representing the parsed object.
@@ -0,0 +1,189 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "deflate.hpp"
+#include "../assert.hpp"
+#include "../cast.hpp"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace tt {
+
+constexpr int deflate_window_size = 32768;
+constexpr int deflate_min_match = 3;
+constexpr int deflate_max_match = 258;
+constexpr int deflate_hash_bits = 15;
+
+/** The maximum number of earlier positions compared when looking for a match.
+ */
+constexpr int deflate_max_chain = 32;
+
+constexpr auto deflate_length_base = std::array<int, 29>{3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+
+constexpr auto deflate_length_extra = std::array<int, 29>{0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+constexpr auto deflate_distance_base = std::array<int, 30>{1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                                                           33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                                                           1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+
+constexpr auto deflate_distance_extra = std::array<int, 30>{0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/** Writes bits starting at the least significant bit of each byte.
+ */
+class deflate_bit_writer {
+public:
+    deflate_bit_writer(bstring &output) noexcept : _output(output) {}
+
+    void write(uint32_t value, int nr_bits) noexcept
+    {
+        _buffer |= static_cast<uint64_t>(value) << _nr_bits;
+        _nr_bits += nr_bits;
+        while (_nr_bits >= 8) {
+            _output.push_back(static_cast<std::byte>(_buffer));
+            _buffer >>= 8;
+            _nr_bits -= 8;
+        }
+    }
+
+    /** Write a Huffman code, which are stored starting at the most significant bit.
+     */
+    void write_code(uint32_t code, int nr_bits) noexcept
+    {
+        auto reversed = uint32_t{0};
+        for (auto i = 0; i != nr_bits; ++i) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        write(reversed, nr_bits);
+    }
+
+    void flush() noexcept
+    {
+        if (_nr_bits != 0) {
+            _output.push_back(static_cast<std::byte>(_buffer));
+            _buffer = 0;
+            _nr_bits = 0;
+        }
+    }
+
+private:
+    bstring &_output;
+    uint64_t _buffer = 0;
+    int _nr_bits = 0;
+};
+
+/** Write a literal or length symbol using the fixed Huffman code.
+ */
+static void deflate_write_symbol(deflate_bit_writer &writer, int symbol) noexcept
+{
+    if (symbol < 144) {
+        writer.write_code(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        writer.write_code(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        writer.write_code(symbol - 256, 7);
+    } else {
+        writer.write_code(0xc0 + symbol - 280, 8);
+    }
+}
+
+static void deflate_write_match(deflate_bit_writer &writer, int length, int distance) noexcept
+{
+    tt_axiom(length >= deflate_min_match and length <= deflate_max_match);
+    tt_axiom(distance >= 1 and distance <= deflate_window_size);
+
+    auto length_code = 28;
+    while (deflate_length_base[length_code] > length) {
+        --length_code;
+    }
+    deflate_write_symbol(writer, 257 + length_code);
+    writer.write(length - deflate_length_base[length_code], deflate_length_extra[length_code]);
+
+    auto distance_code = 29;
+    while (deflate_distance_base[distance_code] > distance) {
+        --distance_code;
+    }
+    writer.write_code(distance_code, 5);
+    writer.write(distance - deflate_distance_base[distance_code], deflate_distance_extra[distance_code]);
+}
+
+[[nodiscard]] static uint32_t deflate_hash(std::byte const *p) noexcept
+{
+    ttlet value = static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16;
+    return (value * 2654435761u) >> (32 - deflate_hash_bits);
+}
+
+bstring deflate(std::span<std::byte const> bytes) noexcept
+{
+    auto r = bstring{};
+    r.reserve(bytes.size() / 2 + 16);
+    auto writer = deflate_bit_writer{r};
+
+    // A single final block with fixed Huffman codes.
+    writer.write(1, 1);
+    writer.write(1, 2);
+
+    // The most recent position for each hash, and the previous position with the same hash.
+    auto head = std::vector<int>(1 << deflate_hash_bits, -1);
+    auto prev = std::vector<int>(deflate_window_size, -1);
+
+    ttlet size = std::ssize(bytes);
+    ttlet insert = [&](ssize_t i) {
+        if (i + deflate_min_match <= size) {
+            auto &h = head[deflate_hash(bytes.data() + i)];
+            prev[i % deflate_window_size] = h;
+            h = narrow_cast<int>(i);
+        }
+    };
+
+    for (auto i = ssize_t{0}; i < size;) {
+        auto best_length = 0;
+        auto best_distance = 0;
+
+        if (i + deflate_min_match <= size) {
+            ttlet max_length = static_cast<int>(std::min(ssize_t{deflate_max_match}, size - i));
+
+            auto candidate = head[deflate_hash(bytes.data() + i)];
+            for (auto chain = 0; chain != deflate_max_chain and candidate >= 0 and i - candidate <= deflate_window_size; ++chain) {
+                auto length = 0;
+                while (length != max_length and bytes[candidate + length] == bytes[i + length]) {
+                    ++length;
+                }
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = narrow_cast<int>(i - candidate);
+                    if (length == max_length) {
+                        break;
+                    }
+                }
+
+                ttlet next = prev[candidate % deflate_window_size];
+                if (next >= candidate) {
+                    // The slot was reused by a newer position, the chain ends here.
+                    break;
+                }
+                candidate = next;
+            }
+        }
+
+        if (best_length >= deflate_min_match) {
+            deflate_write_match(writer, best_length, best_distance);
+            for (auto j = 0; j != best_length; ++j) {
+                insert(i++);
+            }
+        } else {
+            deflate_write_symbol(writer, static_cast<int>(bytes[i]));
+            insert(i++);
+        }
+    }
+
+    deflate_write_symbol(writer, 256);
+    writer.flush();
+    return r;
+}
+
+} // namespace tt
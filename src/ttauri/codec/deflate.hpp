@@ -0,0 +1,24 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "../required.hpp"
+#include "../byte_string.hpp"
+#include <span>
+
+namespace tt {
+
+/** Compress data using the deflate algorithm.
+ *
+ * The data is compressed into a single block with the fixed Huffman codes, after
+ * finding repeated strings with a hash chain. This is fast and compresses repetitive
+ * data such as log files well, but does not compete with the dynamic Huffman codes of zlib.
+ *
+ * @param bytes The data to compress.
+ * @return The compressed data, without a zlib or gzip header.
+ */
+[[nodiscard]] bstring deflate(std::span<std::byte const> bytes) noexcept;
+
+} // namespace tt
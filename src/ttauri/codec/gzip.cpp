@@ -4,8 +4,10 @@
 
 #include "gzip.hpp"
 #include "inflate.hpp"
+#include "deflate.hpp"
 #include "../endian.hpp"
 #include "../placement.hpp"
+#include <array>
 
 namespace tt {
 
@@ -84,4 +86,47 @@ bstring gzip_decompress(std::span<std::byte const> bytes, ssize_t max_size)
     return r;
 }
 
+/** Calculate the CRC-32 used by gzip.
+ */
+[[nodiscard]] static uint32_t gzip_crc32(std::span<std::byte const> bytes) noexcept
+{
+    constexpr auto table = [] {
+        auto r = std::array<uint32_t, 256>{};
+        for (auto i = uint32_t{0}; i != 256; ++i) {
+            auto c = i;
+            for (auto j = 0; j != 8; ++j) {
+                c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            }
+            r[i] = c;
+        }
+        return r;
+    }();
+
+    auto crc = uint32_t{0xffffffff};
+    for (ttlet byte : bytes) {
+        crc = table[(crc ^ static_cast<uint32_t>(byte)) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffff;
+}
+
+bstring gzip_compress(std::span<std::byte const> bytes) noexcept
+{
+    // ID1, ID2, CM=deflate, FLG, MTIME, XFL=fastest, OS=unknown.
+    auto r = bstring{
+        std::byte{31}, std::byte{139}, std::byte{8}, std::byte{0}, std::byte{0}, std::byte{0}, std::byte{0}, std::byte{0},
+        std::byte{4}, std::byte{255}};
+
+    r.append(deflate(bytes));
+
+    ttlet crc = gzip_crc32(bytes);
+    ttlet size = static_cast<uint32_t>(bytes.size());
+    for (auto i = 0; i != 32; i += 8) {
+        r.push_back(static_cast<std::byte>(crc >> i));
+    }
+    for (auto i = 0; i != 32; i += 8) {
+        r.push_back(static_cast<std::byte>(size >> i));
+    }
+    return r;
+}
+
 } // namespace tt
\ No newline at end of file
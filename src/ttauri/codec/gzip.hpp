@@ -13,6 +13,11 @@ namespace tt {
 
 bstring gzip_decompress(std::span<std::byte const> bytes, ssize_t max_size=0x01000000);
 
+/** Compress data into a single gzip member.
+ * @see deflate()
+ */
+[[nodiscard]] bstring gzip_compress(std::span<std::byte const> bytes) noexcept;
+
 inline bstring gzip_decompress(URL const &url, ssize_t max_size=0x01000000) {
     return gzip_decompress(*url.loadView(), max_size);
 }
@@ -116,3 +116,18 @@ TEST(GZip, UnzipXargs1) {
         ASSERT_EQ(decompressed[i], original_bytes[i]);
     }
 }
+
+TEST(GZip, ZipXargs1) {
+    ttlet original = file_view(URL("file:gzip_test8.bin"));
+    ttlet original_bytes = original.bytes();
+
+    ttlet compressed = gzip_compress(original_bytes);
+    ASSERT_LT(std::ssize(compressed), std::ssize(original_bytes));
+
+    auto decompressed = gzip_decompress(compressed);
+    ASSERT_EQ(std::ssize(decompressed), std::ssize(original_bytes));
+
+    for (ssize_t i = 0; i != std::ssize(decompressed); ++i) {
+        ASSERT_EQ(decompressed[i], original_bytes[i]);
+    }
+}
@@ -7,10 +7,12 @@
 
 #pragma once
 
-#include "wfree_unordered_map.hpp"
+#include "wfree_hash_map.hpp"
 #include "architecture.hpp"
 #include "fixed_string.hpp"
 #include "statistics.hpp"
+#include <array>
+#include <atomic>
 #include <span>
 #include <typeinfo>
 #include <typeindex>
@@ -18,42 +20,99 @@
 
 namespace tt {
 
-constexpr int MAX_NR_COUNTERS = 1024;
+/** How the value of a counter is stored.
+ */
+enum class counter_mode {
+    /** A single atomic, shared by all threads.
+     * Best for counters that are incremented by one thread at a time.
+     */
+    shared,
+
+    /** An atomic for each of a number of shards, each on its own cache-line.
+     * Threads are assigned to a shard so that concurrent increments do not
+     * contend on a single cache-line, while reading the counter sums all the shards.
+     */
+    sharded
+};
+
+/** The number of shards of a sharded counter.
+ */
+constexpr size_t counter_nr_shards = 16;
 
 struct counter_map_value_type {
-    std::atomic<int64_t> *counter;
+    /** Read the current value of the counter.
+     */
+    int64_t (*read)() noexcept;
     int64_t previous_value;
 };
 
-using counter_map_type = wfree_unordered_map<std::string, counter_map_value_type, MAX_NR_COUNTERS>;
+using counter_map_type = wfree_hash_map<std::string, counter_map_value_type>;
 
 // To reduce number of executed instruction this is a global variable.
-// The wfree_unordered_map does not need to be initialized.
+// The wfree_hash_map does not need to be initialized.
 inline counter_map_type counter_map;
 
+namespace detail {
+
+inline std::atomic<size_t> counter_shard_next = 0;
+
+/** The shard of the current thread, or counter_nr_shards when not yet assigned.
+ */
+inline thread_local size_t counter_shard = counter_nr_shards;
+
+tt_no_inline inline size_t make_counter_shard() noexcept
+{
+    return counter_shard = counter_shard_next.fetch_add(1, std::memory_order::relaxed) % counter_nr_shards;
+}
+
+/** Get the shard of the current thread.
+ * Threads are assigned round-robin to shards on their first increment.
+ */
+[[nodiscard]] inline size_t get_counter_shard() noexcept
+{
+    ttlet shard = counter_shard;
+    if (shard < counter_nr_shards) {
+        [[likely]] return shard;
+    }
+    return make_counter_shard();
+}
+
+struct counter_shard_type {
+    alignas(hardware_destructive_interference_size) std::atomic<int64_t> value = 0;
+};
+
+} // namespace detail
+
+template<basic_fixed_string Tag, counter_mode Mode = counter_mode::shared>
+struct counter_functor;
+
 template<basic_fixed_string Tag>
-struct counter_functor {
+struct counter_functor<Tag, counter_mode::shared> {
     // Make sure non of the counters are false sharing cache-lines.
     alignas(hardware_destructive_interference_size) inline static std::atomic<int64_t> counter = 0;
+    inline static std::atomic<bool> in_map = false;
 
     tt_no_inline void add_to_map() const noexcept
     {
-        counter_map.insert(Tag, counter_map_value_type{&counter, 0});
-        statistics_start();
+        // The previous value is zero more than once when incremented by zero, only the first call inserts the counter.
+        if (not in_map.exchange(true, std::memory_order::relaxed)) {
+            counter_map.insert(Tag, counter_map_value_type{&read, 0});
+            statistics_start();
+        }
     }
 
-    int64_t increment() const noexcept
+    int64_t increment(int64_t amount = 1) const noexcept
     {
-        ttlet value = counter.fetch_add(1, std::memory_order::relaxed);
+        ttlet value = counter.fetch_add(amount, std::memory_order::relaxed);
 
         if (value == 0) {
             [[unlikely]] add_to_map();
         }
 
-        return value + 1;
+        return value + amount;
     }
 
-    [[nodiscard]] int64_t read() const noexcept
+    [[nodiscard]] static int64_t read() noexcept
     {
         return counter.load(std::memory_order::relaxed);
     }
@@ -62,15 +121,61 @@ struct counter_functor {
 };
 
 template<basic_fixed_string Tag>
-inline int64_t increment_counter() noexcept
+struct counter_functor<Tag, counter_mode::sharded> {
+    inline static std::array<detail::counter_shard_type, counter_nr_shards> shards = {};
+    inline static std::atomic<bool> in_map = false;
+
+    tt_no_inline void add_to_map() const noexcept
+    {
+        // Called on the first increment of each shard, only the first call inserts the counter.
+        if (not in_map.exchange(true, std::memory_order::relaxed)) {
+            counter_map.insert(Tag, counter_map_value_type{&read, 0});
+            statistics_start();
+        }
+    }
+
+    int64_t increment(int64_t amount = 1) const noexcept
+    {
+        ttlet value = shards[detail::get_counter_shard()].value.fetch_add(amount, std::memory_order::relaxed);
+
+        if (value == 0) {
+            [[unlikely]] add_to_map();
+        }
+
+        return value + amount;
+    }
+
+    [[nodiscard]] static int64_t read() noexcept
+    {
+        auto r = int64_t{0};
+        for (ttlet &shard : shards) {
+            r += shard.value.load(std::memory_order::relaxed);
+        }
+        return r;
+    }
+};
+
+/** Increment a counter.
+ *
+ * A counter must always be used with the same mode, the mode is part of the identity of the counter.
+ *
+ * @tparam Tag The name of the counter.
+ * @tparam Mode How the counter is stored, use `counter_mode::sharded` for counters that are
+ *              incremented by many threads at the same time.
+ * @param amount The amount to add to the counter, for counters that accumulate quantities such as durations.
+ * @return The value of the counter after incrementing, for sharded counters the value of
+ *         the shard of the current thread.
+ */
+template<basic_fixed_string Tag, counter_mode Mode = counter_mode::shared>
+inline int64_t increment_counter(int64_t amount = 1) noexcept
 {
-    return counter_functor<Tag>{}.increment();
+    return counter_functor<Tag, Mode>{}.increment(amount);
 }
 
-template<basic_fixed_string Tag>
+template<basic_fixed_string Tag, counter_mode Mode = counter_mode::shared>
 [[nodiscard]] inline int64_t read_counter() noexcept
 {
-    return counter_functor<Tag>{}.read();
+    return counter_functor<Tag, Mode>::read();
 }
 
 /*!
@@ -80,8 +185,7 @@ template<basic_fixed_string Tag>
 {
     auto &item = counter_map[tag];
 
-    ttlet *const count_ptr = item.counter;
-    ttlet count = count_ptr != nullptr ? item.counter->load(std::memory_order::relaxed) : 0;
+    ttlet count = item.read != nullptr ? item.read() : 0;
     ttlet count_since_last_read = count - item.previous_value;
     item.previous_value = count;
     return {count, count_since_last_read};
@@ -0,0 +1,37 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/counters.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace tt;
+
+/** Increment a counter from a number of threads at the same time.
+ * A shared counter bounces a single cache-line between the cores, while
+ * a sharded counter should scale with the number of threads.
+ */
+template<counter_mode Mode>
+static void increment_counter_contended(benchmark::State &state)
+{
+    for (auto _ : state) {
+        increment_counter<"counter_benchmark", Mode>();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** The cost of summing the shards when reading a counter.
+ */
+template<counter_mode Mode>
+static void read_counter_cost(benchmark::State &state)
+{
+    increment_counter<"counter_benchmark_read", Mode>();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(read_counter<"counter_benchmark_read", Mode>());
+    }
+}
+
+BENCHMARK_TEMPLATE(increment_counter_contended, counter_mode::shared)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(increment_counter_contended, counter_mode::sharded)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(read_counter_cost, counter_mode::shared);
+BENCHMARK_TEMPLATE(read_counter_cost, counter_mode::sharded);
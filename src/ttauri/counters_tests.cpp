@@ -7,6 +7,8 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 using namespace tt;
@@ -30,3 +32,35 @@ TEST(Counters, RunTimeRead) {
     ASSERT_EQ(read_counter("foo_b").first, 1);
     ASSERT_EQ(read_counter("bar_b").first, 2);
 }
+
+TEST(Counters, Sharded) {
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto i = 0; i != 8; ++i) {
+            threads.emplace_back([] {
+                for (auto j = 0; j != 10000; ++j) {
+                    increment_counter<"foo_c", counter_mode::sharded>();
+                }
+                increment_counter<"bar_c", counter_mode::sharded>(5);
+            });
+        }
+    }
+
+    ASSERT_EQ((read_counter<"foo_c", counter_mode::sharded>()), 80000);
+    ASSERT_EQ((read_counter<"bar_c", counter_mode::sharded>()), 40);
+
+    // Sharded counters are read by name in the same way as shared counters.
+    ASSERT_EQ(read_counter("foo_c").first, 80000);
+    ASSERT_EQ(read_counter("bar_c").first, 40);
+}
+
+TEST(Counters, IncrementByZero) {
+    // Incrementing by zero while the counter is zero inserts the counter only once.
+    increment_counter<"foo_d">(0);
+    increment_counter<"foo_d">(0);
+    ASSERT_EQ(read_counter("foo_d").first, 0);
+
+    increment_counter<"foo_d">(3);
+    increment_counter<"foo_d">(0);
+    ASSERT_EQ(read_counter("foo_d").first, 3);
+}
@@ -7,39 +7,177 @@
 #include "exception.hpp"
 #include "thread.hpp"
 #include "subsystem.hpp"
+#include "counters.hpp"
+#include "logger.hpp"
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace tt {
 
+/** A shard of the lock-order graph.
+ * The graph is split in shards by the address of the object,
+ * so that threads checking different objects do not contend on a single mutex.
+ */
+struct dead_lock_detector_graph_shard {
+    alignas(hardware_destructive_interference_size) unfair_mutex_impl<false> mutex;
+
+    /** For each object, the objects that were locked while holding it.
+     */
+    std::unordered_map<void *, std::vector<void *>> successors;
+
+    /** For each object, the objects that were held while locking it.
+     * This reverse index is used to find the edges to an object when it is removed.
+     */
+    std::unordered_map<void *, std::vector<void *>> predecessors;
+};
+
+/** Serializes adding pairs to the graph, so that two threads can not concurrently add opposite orders.
+ */
 static unfair_mutex_impl<false> dead_lock_detector_mutex;
 
+/** Get the shards of the graph.
+ * The graph is initialized on first use, as mutexes may be locked during static initialization.
+ */
+[[nodiscard]] static std::array<dead_lock_detector_graph_shard, 16> &dead_lock_detector_graph() noexcept
+{
+    static auto graph = std::array<dead_lock_detector_graph_shard, 16>{};
+    return graph;
+}
+
+[[nodiscard]] static dead_lock_detector_graph_shard &dead_lock_detector_shard(void *object) noexcept
+{
+    ttlet hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object) >> 3) * 0x9e3779b97f4a7c15;
+    return dead_lock_detector_graph()[static_cast<size_t>(hash >> 60)];
+}
+
+[[nodiscard]] static bool dead_lock_detector_graph_contains(void *before, void *after) noexcept
+{
+    auto &shard = dead_lock_detector_shard(before);
+    ttlet lock = std::scoped_lock(shard.mutex);
+
+    ttlet it = shard.successors.find(before);
+    return it != shard.successors.end() and std::find(it->second.begin(), it->second.end(), after) != it->second.end();
+}
+
+[[nodiscard]] static std::vector<void *> dead_lock_detector_graph_successors(void *object) noexcept
+{
+    auto &shard = dead_lock_detector_shard(object);
+    ttlet lock = std::scoped_lock(shard.mutex);
+
+    ttlet it = shard.successors.find(object);
+    return it != shard.successors.end() ? it->second : std::vector<void *>{};
+}
+
+/** Insert a pair in the graph.
+ * The caller must hold `dead_lock_detector_mutex`.
+ */
+static void dead_lock_detector_graph_insert(void *before, void *after) noexcept
+{
+    {
+        auto &shard = dead_lock_detector_shard(before);
+        ttlet lock = std::scoped_lock(shard.mutex);
+
+        auto &successors = shard.successors[before];
+        if (std::find(successors.begin(), successors.end(), after) != successors.end()) {
+            return;
+        }
+        successors.push_back(after);
+    }
+
+    auto &shard = dead_lock_detector_shard(after);
+    ttlet lock = std::scoped_lock(shard.mutex);
+    shard.predecessors[after].push_back(before);
+}
+
+/** Remove `object` from the list of `key` in `map`, and remove `key` when its list becomes empty.
+ */
+static void dead_lock_detector_graph_erase(std::unordered_map<void *, std::vector<void *>> &map, void *key, void *object) noexcept
+{
+    if (auto it = map.find(key); it != map.end()) {
+        std::erase(it->second, object);
+        if (it->second.empty()) {
+            map.erase(it);
+        }
+    }
+}
+
+/** Check if the graph has a path between two objects, meaning that `to` was locked after `from`,
+ * directly or through other objects.
+ */
+[[nodiscard]] static bool dead_lock_detector_graph_has_path(void *from, void *to) noexcept
+{
+    auto todo = std::vector<void *>{from};
+    auto visited = std::unordered_set<void *>{from};
+
+    while (not todo.empty()) {
+        ttlet object = todo.back();
+        todo.pop_back();
+
+        for (ttlet successor : dead_lock_detector_graph_successors(object)) {
+            if (successor == to) {
+                return true;
+            }
+            if (visited.insert(successor).second) {
+                todo.push_back(successor);
+            }
+        }
+    }
+    return false;
+}
+
 [[nodiscard]] void *dead_lock_detector::check_graph(void *object) noexcept
 {
     tt_axiom(object != nullptr);
 
-    ttlet lock = std::scoped_lock(dead_lock_detector_mutex);
+    ttlet current_generation = generation.load(std::memory_order::acquire);
+    if (filter.generation != current_generation) {
+        [[unlikely]] filter.clear(current_generation);
+    }
 
     for (ttlet before : stack) {
-        auto correct_order = detail::dead_lock_detector_pair{before, object};
-        ttlet reverse_order = detail::dead_lock_detector_pair{object, before};
+        ttlet correct_order = detail::dead_lock_detector_pair{before, object};
 
-        if (std::binary_search(std::cbegin(lock_graph), std::cend(lock_graph), correct_order)) {
-            // The object has been locked in the correct order in comparison to `before`.
-            continue;
+        if (filter.contains(correct_order)) {
+            // This thread already checked this order.
+            [[likely]] continue;
         }
 
-        if (std::binary_search(std::cbegin(lock_graph), std::cend(lock_graph), reverse_order)) {
-            // The object has been locked in reverse order in comparison to `before`.
-            return before;
+        if (not dead_lock_detector_graph_contains(before, object)) {
+            auto found = false;
+            {
+                ttlet lock = std::scoped_lock(dead_lock_detector_mutex);
+                found = dead_lock_detector_graph_has_path(object, before);
+                if (not found) {
+                    dead_lock_detector_graph_insert(before, object);
+                }
+            }
+
+            if (found) {
+                // The object has been locked in reverse order in comparison to `before`.
+                // Remember the pair, so that it is only reported once by this thread.
+                report(before, object);
+                filter.insert(correct_order);
+                return before;
+            }
         }
 
-        // Insert the new 'correct' order in the sorted lock_graph.
-        ttlet it = std::upper_bound(std::cbegin(lock_graph), std::cend(lock_graph), correct_order);
-        lock_graph.insert(it, std::move(correct_order));
+        filter.insert(correct_order);
     }
     return nullptr;
 }
 
+void dead_lock_detector::report(void *before, void *object) noexcept
+{
+    reporting = true;
+    increment_counter<"dead_lock_detected">();
+    tt_log_error(
+        "Potential dead-lock: {} is locked while holding {}, which conflicts with an earlier lock order.",
+        get_name(object),
+        get_name(before));
+    reporting = false;
+}
+
 void *dead_lock_detector::lock(void *object) noexcept
 {
     if (system_shutting_down()) {
@@ -56,13 +194,15 @@ void *dead_lock_detector::lock(void *object) noexcept
         }
     }
 
-    if (auto before = check_graph(object)) {
-        // Trying to lock `object` after `before` in previously reversed order
-        return before;
-    }
+    // Objects locked while reporting are not checked, the logger may lock the objects being reported.
+    ttlet before = (stack.empty() or reporting) ? nullptr : check_graph(object);
 
+    // The object is pushed even when a potential dead-lock is found, as the caller may continue
+    // to lock the object, and unlock it later.
     stack.push_back(object);
-    return nullptr;
+
+    // When not nullptr, trying to lock `object` after `before` in previously reversed order.
+    return before;
 }
 
 /** Unlock an object on this thread.
@@ -98,18 +238,61 @@ void dead_lock_detector::clear_stack() noexcept
 void dead_lock_detector::clear_graph() noexcept
 {
     ttlet lock = std::scoped_lock(dead_lock_detector_mutex);
-    lock_graph.clear();
+
+    for (auto &shard : dead_lock_detector_graph()) {
+        ttlet shard_lock = std::scoped_lock(shard.mutex);
+        shard.successors.clear();
+        shard.predecessors.clear();
+    }
+    generation.fetch_add(1, std::memory_order::release);
 }
 
 void dead_lock_detector::remove_object(void *object) noexcept
 {
+    if (system_shutting_down()) {
+        // Global mutexes are destroyed after main() returns, when the graph may already be destroyed.
+        return;
+    }
+
     tt_axiom(object != nullptr);
 
     ttlet lock = std::scoped_lock(dead_lock_detector_mutex);
 
-    std::erase_if(lock_graph, [object](ttlet &item) {
-        return item.before == object or item.after == object;
-    });
+    auto successors = std::vector<void *>{};
+    auto predecessors = std::vector<void *>{};
+    {
+        auto &shard = dead_lock_detector_shard(object);
+        ttlet shard_lock = std::scoped_lock(shard.mutex);
+
+        if (auto it = shard.successors.find(object); it != shard.successors.end()) {
+            successors = std::move(it->second);
+            shard.successors.erase(it);
+        }
+        if (auto it = shard.predecessors.find(object); it != shard.predecessors.end()) {
+            predecessors = std::move(it->second);
+            shard.predecessors.erase(it);
+        }
+    }
+
+    if (successors.empty() and predecessors.empty()) {
+        // The object was never locked together with another object, so no filter can contain it.
+        return;
+    }
+
+    // Only the shards of the objects that share an edge with the removed object are touched.
+    for (ttlet after : successors) {
+        auto &shard = dead_lock_detector_shard(after);
+        ttlet shard_lock = std::scoped_lock(shard.mutex);
+        dead_lock_detector_graph_erase(shard.predecessors, after, object);
+    }
+    for (ttlet before : predecessors) {
+        auto &shard = dead_lock_detector_shard(before);
+        ttlet shard_lock = std::scoped_lock(shard.mutex);
+        dead_lock_detector_graph_erase(shard.successors, before, object);
+    }
+
+    // The address of the object may be reused, so the filters of all threads are invalidated.
+    generation.fetch_add(1, std::memory_order::release);
 }
 
 } // namespace tt
@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include "required.hpp"
 #include "assert.hpp"
 #include "architecture.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <compare>
@@ -23,8 +29,63 @@ struct dead_lock_detector_pair {
     operator<=>(dead_lock_detector_pair const &lhs, dead_lock_detector_pair const &rhs) noexcept = default;
 };
 
-}
+/** A per-thread cache of lock-order pairs which have already been checked.
+ *
+ * This is a direct mapped cache; a pair that is evicted is checked against the global
+ * graph again on its next use. The cache is cleared when objects are removed from the
+ * graph, since the address of a removed object may be reused by a new object.
+ */
+struct dead_lock_detector_filter {
+    static constexpr size_t capacity = 256;
 
+    /** The graph generation for which the pairs are valid.
+     */
+    uint64_t generation = 0;
+    std::array<dead_lock_detector_pair, capacity> pairs = {};
+
+    [[nodiscard]] static size_t index(dead_lock_detector_pair const &pair) noexcept
+    {
+        // Pointers to objects are aligned, so the low bits are discarded before mixing.
+        constexpr uint64_t golden_ratio = 0x9e3779b97f4a7c15;
+        ttlet before = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pair.before) >> 3);
+        ttlet after = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pair.after) >> 3);
+        return static_cast<size_t>(((before * golden_ratio) ^ after) * golden_ratio >> (64 - std::bit_width(capacity - 1)));
+    }
+
+    [[nodiscard]] bool contains(dead_lock_detector_pair const &pair) const noexcept
+    {
+        return pairs[index(pair)] == pair;
+    }
+
+    void insert(dead_lock_detector_pair const &pair) noexcept
+    {
+        pairs[index(pair)] = pair;
+    }
+
+    void clear(uint64_t new_generation) noexcept
+    {
+        generation = new_generation;
+        pairs = {};
+    }
+};
+
+} // namespace detail
+
+/** Detect potential dead-locks by checking the order in which objects are locked.
+ *
+ * Each time a thread locks an object while holding other objects, the pairs of
+ * held-before-acquired objects are added to a global lock-order graph. A potential
+ * dead-lock is found when an object is locked while the graph already has a path
+ * from that object to one of the held objects.
+ *
+ * Pairs which were already checked are remembered in a small per-thread filter,
+ * so that once the lock orders of an application are known, locking an object
+ * only costs a few instructions per held object. This makes the detector cheap enough
+ * to be enabled in release builds with the `TT_DEAD_LOCK_DETECTOR` build option.
+ *
+ * A potential dead-lock is logged as an error with the names of both objects, once per
+ * thread for each pair, and counted in the "dead_lock_detected" counter.
+ */
 class dead_lock_detector {
 public:
     /** Lock an object on this thread.
@@ -43,7 +104,7 @@ public:
     /** Remove the object from the detection.
      * This function is needed when there are mutex-like objects
      * that are dynamically de-allocated.
-     * 
+     *
      * @param object The object to remove from the lock order graph.
      */
     static void remove_object(void *object) noexcept;
@@ -58,17 +119,29 @@ public:
      */
     static void clear_graph() noexcept;
 
+    /** Get a human readable name of an object.
+     *
+     * @return The name of the symbol of a global variable, with an offset when the
+     *         object is a member of the global variable; otherwise the address.
+     */
+    [[nodiscard]] static std::string get_name(void *object) noexcept;
+
 private:
     thread_local inline static std::vector<void *> stack;
 
-    /** The order in which objects where locked.
-     * Each pair gives a first before second order.
-     * 
-     * When accessing lock_order dead_lock_detector_mutex must be locked.
+    thread_local inline static detail::dead_lock_detector_filter filter;
+
+    /** Set while reporting a potential dead-lock, so that locks taken by the logger are not checked.
      */
-    inline static std::vector<detail::dead_lock_detector_pair> lock_graph;
+    thread_local inline static bool reporting = false;
+
+    /** Incremented when objects are removed from the graph, to invalidate the filters.
+     */
+    inline static std::atomic<uint64_t> generation = 0;
 
     [[nodiscard]] static void *check_graph(void *object) noexcept;
+
+    static void report(void *before, void *object) noexcept;
 };
 
 }
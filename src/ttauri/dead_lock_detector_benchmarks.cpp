@@ -0,0 +1,38 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/unfair_mutex.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+using namespace tt;
+
+/** Lock and unlock a number of nested mutexes, always in the same order.
+ * The argument is the nesting depth; the template argument turns the dead-lock detector on or off.
+ */
+template<bool UseDeadLockDetector>
+static void dead_lock_detector_nested_lock(benchmark::State &state)
+{
+    ttlet depth = static_cast<size_t>(state.range(0));
+
+    auto mutexes = std::vector<std::unique_ptr<unfair_mutex_impl<UseDeadLockDetector>>>{};
+    for (auto i = size_t{0}; i != depth; ++i) {
+        mutexes.push_back(std::make_unique<unfair_mutex_impl<UseDeadLockDetector>>());
+    }
+
+    for (auto _ : state) {
+        for (auto &mutex : mutexes) {
+            mutex->lock();
+        }
+        for (auto it = mutexes.rbegin(); it != mutexes.rend(); ++it) {
+            (*it)->unlock();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * depth);
+}
+
+BENCHMARK_TEMPLATE(dead_lock_detector_nested_lock, false)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK_TEMPLATE(dead_lock_detector_nested_lock, true)->Arg(1)->Arg(2)->Arg(4);
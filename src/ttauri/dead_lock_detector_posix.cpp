@@ -0,0 +1,51 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dead_lock_detector.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#if TT_OPERATING_SYSTEM == TT_OS_LINUX
+#include <link.h>
+#endif
+
+namespace tt {
+
+[[nodiscard]] std::string dead_lock_detector::get_name(void *object) noexcept
+{
+    try {
+        auto info = Dl_info{};
+#if TT_OPERATING_SYSTEM == TT_OS_LINUX
+        // dladdr() returns the nearest symbol below the address, check that the object is inside the symbol.
+        ElfW(Sym) *symbol = nullptr;
+        ttlet found = dladdr1(object, &info, reinterpret_cast<void **>(&symbol), RTLD_DL_SYMENT) != 0 and
+            info.dli_sname != nullptr and symbol != nullptr and
+            static_cast<std::byte *>(object) < static_cast<std::byte *>(info.dli_saddr) + symbol->st_size;
+#else
+        ttlet found = dladdr(object, &info) != 0 and info.dli_sname != nullptr;
+#endif
+
+        if (not found) {
+            return std::format("{}", object);
+        }
+
+        auto status = 0;
+        auto *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        auto name = std::string{status == 0 ? demangled : info.dli_sname};
+        std::free(demangled);
+
+        ttlet offset = static_cast<std::byte *>(object) - static_cast<std::byte *>(info.dli_saddr);
+        if (offset != 0) {
+            name += std::format("+{}", offset);
+        }
+        return name;
+
+    } catch (...) {
+        return {};
+    }
+}
+
+} // namespace tt
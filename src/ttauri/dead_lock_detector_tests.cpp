@@ -331,3 +331,110 @@ TEST(dead_lock_detector, good_lock4)
     dead_lock_detector::remove_object(&c);
 }
 
+
+TEST(dead_lock_detector, dead_lock_transitive)
+{
+    dead_lock_detector::clear_stack();
+    dead_lock_detector::clear_graph();
+
+    int a, b, c;
+
+    auto at = std::thread([&]() {
+        dead_lock_detector::clear_stack();
+        ASSERT_NULL(dead_lock_detector::lock(&a));
+        ASSERT_NULL(dead_lock_detector::lock(&b));
+        ASSERT_TRUE(dead_lock_detector::unlock(&b));
+        ASSERT_TRUE(dead_lock_detector::unlock(&a));
+    });
+    at.join();
+
+    auto bt = std::thread([&]() {
+        dead_lock_detector::clear_stack();
+        ASSERT_NULL(dead_lock_detector::lock(&b));
+        ASSERT_NULL(dead_lock_detector::lock(&c));
+        ASSERT_TRUE(dead_lock_detector::unlock(&c));
+        ASSERT_TRUE(dead_lock_detector::unlock(&b));
+    });
+    bt.join();
+
+    // a -> b -> c, so locking a while holding c may dead-lock.
+    auto ct = std::thread([&]() {
+        dead_lock_detector::clear_stack();
+        ASSERT_NULL(dead_lock_detector::lock(&c));
+        ASSERT_EQ(dead_lock_detector::lock(&a), &c);
+
+        // The object is still tracked, so that it can be unlocked normally.
+        ASSERT_TRUE(dead_lock_detector::unlock(&a));
+        ASSERT_TRUE(dead_lock_detector::unlock(&c));
+    });
+    ct.join();
+
+    dead_lock_detector::remove_object(&a);
+    dead_lock_detector::remove_object(&b);
+    dead_lock_detector::remove_object(&c);
+}
+
+TEST(dead_lock_detector, remove_object)
+{
+    dead_lock_detector::clear_stack();
+    dead_lock_detector::clear_graph();
+
+    int a, b;
+
+    ASSERT_NULL(dead_lock_detector::lock(&a));
+    ASSERT_NULL(dead_lock_detector::lock(&b));
+    ASSERT_TRUE(dead_lock_detector::unlock(&b));
+    ASSERT_TRUE(dead_lock_detector::unlock(&a));
+
+    // After removing the object, the reverse order is allowed, even though
+    // the first order is remembered by the filter of this thread.
+    dead_lock_detector::remove_object(&a);
+
+    ASSERT_NULL(dead_lock_detector::lock(&b));
+    ASSERT_NULL(dead_lock_detector::lock(&a));
+    ASSERT_TRUE(dead_lock_detector::unlock(&a));
+    ASSERT_TRUE(dead_lock_detector::unlock(&b));
+
+    dead_lock_detector::remove_object(&a);
+    dead_lock_detector::remove_object(&b);
+}
+
+TEST(dead_lock_detector, remove_object_after)
+{
+    dead_lock_detector::clear_stack();
+    dead_lock_detector::clear_graph();
+
+    int a, b, c;
+
+    ASSERT_NULL(dead_lock_detector::lock(&a));
+    ASSERT_NULL(dead_lock_detector::lock(&b));
+    ASSERT_TRUE(dead_lock_detector::unlock(&b));
+    ASSERT_TRUE(dead_lock_detector::unlock(&a));
+
+    // Removing an object which was never locked together with another object leaves the graph intact.
+    dead_lock_detector::remove_object(&c);
+
+    auto at = std::thread([&]() {
+        dead_lock_detector::clear_stack();
+        ASSERT_NULL(dead_lock_detector::lock(&b));
+        ASSERT_NOT_NULL(dead_lock_detector::lock(&a));
+    });
+    at.join();
+
+    // Removing the object that was locked second also removes the edge from the first object.
+    dead_lock_detector::remove_object(&b);
+
+    ASSERT_NULL(dead_lock_detector::lock(&b));
+    ASSERT_NULL(dead_lock_detector::lock(&a));
+    ASSERT_TRUE(dead_lock_detector::unlock(&a));
+    ASSERT_TRUE(dead_lock_detector::unlock(&b));
+
+    dead_lock_detector::remove_object(&a);
+    dead_lock_detector::remove_object(&b);
+}
+
+TEST(dead_lock_detector, get_name)
+{
+    int a;
+    ASSERT_FALSE(dead_lock_detector::get_name(&a).empty());
+}
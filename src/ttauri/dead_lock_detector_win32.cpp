@@ -0,0 +1,48 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dead_lock_detector.hpp"
+#include <format>
+#include <mutex>
+#include <Windows.h>
+#include <DbgHelp.h>
+
+#pragma comment(lib, "dbghelp")
+
+namespace tt {
+
+/** DbgHelp functions are not thread-safe.
+ * This is a std::mutex, since an unfair_mutex would call the dead-lock detector.
+ */
+static std::mutex dead_lock_detector_dbghelp_mutex;
+
+[[nodiscard]] std::string dead_lock_detector::get_name(void *object) noexcept
+{
+    try {
+        ttlet lock = std::scoped_lock(dead_lock_detector_dbghelp_mutex);
+
+        static ttlet initialized = SymInitialize(GetCurrentProcess(), nullptr, TRUE);
+        if (initialized) {
+            alignas(SYMBOL_INFO) char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+            auto *symbol = reinterpret_cast<SYMBOL_INFO *>(buffer);
+            symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+            symbol->MaxNameLen = MAX_SYM_NAME;
+
+            auto displacement = DWORD64{0};
+            if (SymFromAddr(GetCurrentProcess(), reinterpret_cast<DWORD64>(object), &displacement, symbol)) {
+                auto name = std::string{symbol->Name, symbol->NameLen};
+                if (displacement != 0) {
+                    name += std::format("+{}", displacement);
+                }
+                return name;
+            }
+        }
+        return std::format("{}", object);
+
+    } catch (...) {
+        return {};
+    }
+}
+
+} // namespace tt
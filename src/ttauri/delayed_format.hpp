@@ -60,6 +60,13 @@ public:
         return std::apply(format_locale_wrapper<Values const &...>, std::tuple_cat(std::tuple{loc, Fmt.c_str()}, _values));
     }
 
+    /** The captured arguments.
+     */
+    [[nodiscard]] std::tuple<Values...> const &values() const noexcept
+    {
+        return _values;
+    }
+
 private:
     std::tuple<Values...> _values;
 
@@ -0,0 +1,67 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace tt {
+
+/** Memory which is mapped twice, back-to-back, into the address space.
+ *
+ * Writing to `data()[i]` also changes `data()[i + size()]`, so that a ring buffer
+ * can hand out contiguous spans that cross the end of the buffer.
+ */
+class double_mapped_memory {
+public:
+    /** Allocate and map the memory.
+     *
+     * @param size The minimum size in bytes, it is rounded up to a multiple of `granularity()`.
+     * @throw os_error When the memory could not be mapped.
+     */
+    double_mapped_memory(size_t size);
+    ~double_mapped_memory();
+
+    double_mapped_memory(double_mapped_memory const &) = delete;
+    double_mapped_memory &operator=(double_mapped_memory const &) = delete;
+
+    double_mapped_memory(double_mapped_memory &&other) noexcept :
+        _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0))
+    {
+    }
+
+    double_mapped_memory &operator=(double_mapped_memory &&other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        return *this;
+    }
+
+    /** The start of the first mapping, the second mapping starts at `data() + size()`.
+     */
+    [[nodiscard]] std::byte *data() const noexcept
+    {
+        return _data;
+    }
+
+    /** The size of a single mapping in bytes.
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /** The size in bytes of which the size of the memory must be a multiple.
+     */
+    [[nodiscard]] static size_t granularity() noexcept;
+
+private:
+    std::byte *_data = nullptr;
+    size_t _size = 0;
+};
+
+} // namespace tt
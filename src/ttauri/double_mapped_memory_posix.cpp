@@ -0,0 +1,83 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "double_mapped_memory.hpp"
+#include "exception.hpp"
+#include "logger.hpp"
+#include "memory.hpp"
+#include <atomic>
+#include <format>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace tt {
+
+/** Create an anonymous shared memory object.
+ */
+[[nodiscard]] static int double_mapped_memory_create_fd()
+{
+#if TT_OPERATING_SYSTEM == TT_OS_LINUX
+    ttlet fd = memfd_create("tt_double_mapped_memory", MFD_CLOEXEC);
+#else
+    static std::atomic<int> sequence = 0;
+    ttlet name = std::format("/tt-dmm-{}-{}", getpid(), sequence.fetch_add(1));
+    ttlet fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1) {
+        shm_unlink(name.c_str());
+    }
+#endif
+
+    if (fd == -1) {
+        throw os_error("Could not create shared memory for double mapped memory. '{}'", get_last_error_message());
+    }
+    return fd;
+}
+
+double_mapped_memory::double_mapped_memory(size_t size) : _size(ceil(size, granularity()))
+{
+    ttlet fd = double_mapped_memory_create_fd();
+
+    if (ftruncate(fd, static_cast<off_t>(_size)) == -1) {
+        ttlet error_message = get_last_error_message();
+        close(fd);
+        throw os_error("Could not resize shared memory for double mapped memory. '{}'", error_message);
+    }
+
+    // Reserve the address range for both mappings, then replace each half by the shared memory.
+    auto *address = mmap(nullptr, _size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED) {
+        ttlet error_message = get_last_error_message();
+        close(fd);
+        throw os_error("Could not reserve address space for double mapped memory. '{}'", error_message);
+    }
+
+    auto *bytes = static_cast<std::byte *>(address);
+    for (auto *half : {bytes, bytes + _size}) {
+        if (mmap(half, _size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            ttlet error_message = get_last_error_message();
+            munmap(address, _size * 2);
+            close(fd);
+            throw os_error("Could not map double mapped memory. '{}'", error_message);
+        }
+    }
+
+    // The mappings keep the shared memory alive.
+    close(fd);
+    _data = bytes;
+}
+
+double_mapped_memory::~double_mapped_memory()
+{
+    if (_data != nullptr) {
+        munmap(_data, _size * 2);
+    }
+}
+
+[[nodiscard]] size_t double_mapped_memory::granularity() noexcept
+{
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+} // namespace tt
@@ -0,0 +1,72 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "double_mapped_memory.hpp"
+#include "exception.hpp"
+#include "logger.hpp"
+#include "memory.hpp"
+#include <Windows.h>
+
+namespace tt {
+
+double_mapped_memory::double_mapped_memory(size_t size) : _size(ceil(size, granularity()))
+{
+    ttlet mapping = CreateFileMappingW(
+        INVALID_HANDLE_VALUE,
+        NULL,
+        PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<uint64_t>(_size) >> 32),
+        static_cast<DWORD>(_size),
+        NULL);
+    if (mapping == NULL) {
+        throw os_error("Could not create file mapping for double mapped memory. '{}'", get_last_error_message());
+    }
+
+    // Find a free address range for both views. Another thread may allocate in the range
+    // between releasing the reservation and mapping the views, in that case try again.
+    for (auto attempt = 0; attempt != 16; ++attempt) {
+        auto *address = static_cast<std::byte *>(VirtualAlloc(NULL, _size * 2, MEM_RESERVE, PAGE_NOACCESS));
+        if (address == NULL) {
+            break;
+        }
+        VirtualFree(address, 0, MEM_RELEASE);
+
+        auto *first = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, _size, address);
+        if (first == NULL) {
+            continue;
+        }
+
+        auto *second = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, _size, address + _size);
+        if (second == NULL) {
+            UnmapViewOfFile(first);
+            continue;
+        }
+
+        // The views keep the file mapping alive.
+        CloseHandle(mapping);
+        _data = address;
+        return;
+    }
+
+    ttlet error_message = get_last_error_message();
+    CloseHandle(mapping);
+    throw os_error("Could not map double mapped memory. '{}'", error_message);
+}
+
+double_mapped_memory::~double_mapped_memory()
+{
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data + _size);
+        UnmapViewOfFile(_data);
+    }
+}
+
+[[nodiscard]] size_t double_mapped_memory::granularity() noexcept
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+}
+
+} // namespace tt
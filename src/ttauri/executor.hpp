@@ -0,0 +1,165 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "thread_pool.hpp"
+#include "timer.hpp"
+#include "thread.hpp"
+#include "hires_utc_clock.hpp"
+#include <coroutine>
+
+namespace tt {
+
+/** An executor resumes coroutines on a specific thread or set of threads.
+ *
+ * A coroutine moves itself to the executor by awaiting `schedule()`:
+ *
+ * ```
+ * task<pixel_map<sfloat_rgba16>> load_image(URL url)
+ * {
+ *     co_await thread_pool_executor::global().schedule();
+ *     auto image = decode_png(url);
+ *     co_await gui_executor::global().schedule();
+ *     co_return upload(image);
+ * }
+ * ```
+ */
+class executor {
+public:
+    executor() noexcept = default;
+    virtual ~executor() = default;
+    executor(executor const &) = delete;
+    executor(executor &&) = delete;
+    executor &operator=(executor const &) = delete;
+    executor &operator=(executor &&) = delete;
+
+    /** Resume a suspended coroutine on one of the threads of the executor.
+     */
+    virtual void execute(std::coroutine_handle<> coroutine) noexcept = 0;
+
+    /** Suspend the current coroutine and resume it on the executor.
+     */
+    [[nodiscard]] auto schedule() noexcept
+    {
+        struct awaiter {
+            executor &self;
+
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                self.execute(awaiting);
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        return awaiter{*this};
+    }
+};
+
+/** An executor that resumes coroutines on the workers of a thread pool.
+ */
+class thread_pool_executor final : public executor {
+public:
+    explicit thread_pool_executor(thread_pool &pool) noexcept : _pool(pool) {}
+
+    void execute(std::coroutine_handle<> coroutine) noexcept override
+    {
+        _pool.submit([coroutine] {
+            coroutine.resume();
+        });
+    }
+
+    /** An executor for the global thread pool.
+     */
+    [[nodiscard]] static thread_pool_executor &global() noexcept
+    {
+        static auto r = thread_pool_executor{thread_pool::global()};
+        return r;
+    }
+
+private:
+    thread_pool &_pool;
+};
+
+/** An executor that resumes coroutines on the thread of a timer.
+ */
+class timer_executor final : public executor {
+public:
+    explicit timer_executor(tt::timer &timer) noexcept : _timer(timer) {}
+
+    void execute(std::coroutine_handle<> coroutine) noexcept override
+    {
+        _timer.add_oneshot(hires_utc_clock::now(), [coroutine] {
+            coroutine.resume();
+        });
+    }
+
+    /** Suspend the current coroutine and resume it on the timer thread after a delay.
+     *
+     * @param delay The minimum amount of time to suspend the coroutine.
+     */
+    [[nodiscard]] auto schedule_after(timer::duration delay) noexcept
+    {
+        struct awaiter {
+            tt::timer &self;
+            timer::time_point wakeup;
+
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                self.add_oneshot(wakeup, [awaiting] {
+                    awaiting.resume();
+                });
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        return awaiter{_timer, hires_utc_clock::now() + delay};
+    }
+
+    /** An executor for the global timer.
+     */
+    [[nodiscard]] static timer_executor &global() noexcept
+    {
+        static auto r = timer_executor{timer::global()};
+        return r;
+    }
+
+private:
+    timer &_timer;
+};
+
+/** An executor that resumes coroutines on the gui thread.
+ *
+ * When `execute()` is called from the gui thread the coroutine is resumed immediately.
+ */
+class gui_executor final : public executor {
+public:
+    void execute(std::coroutine_handle<> coroutine) noexcept override
+    {
+        run_on_gui_thread([coroutine] {
+            coroutine.resume();
+        });
+    }
+
+    [[nodiscard]] static gui_executor &global() noexcept
+    {
+        static auto r = gui_executor{};
+        return r;
+    }
+};
+
+} // namespace tt
@@ -10,6 +10,7 @@
 #include <string>
 #include <string_view>
 #include <memory>
+#include <memory_resource>
 
 
 namespace tt {
@@ -38,6 +39,16 @@ inline std::unique_ptr<formula_node> parse_formula(std::string_view text) {
     return parse_formula(text.cbegin(), text.cend());
 }
 
+/** Parse an formula in an arena.
+ * The nodes of the formula and the temporary tokens are allocated from the memory resource,
+ * which must outlive the returned formula. The strings and lists of child nodes held by
+ * the nodes are still allocated from the heap.
+ */
+inline std::unique_ptr<formula_node> parse_formula(std::string_view text, std::pmr::memory_resource &resource) {
+    auto scope = arena_scope(resource);
+    return parse_formula(text);
+}
+
 
 /** Find the end of an formula.
     * This function will track nested brackets and strings, until the terminating_character is found.
@@ -10,13 +10,17 @@
 #include "../parse_location.hpp"
 #include "../datum.hpp"
 #include "../exception.hpp"
+#include "../arena_memory_resource.hpp"
 #include <vector>
 #include <memory>
 #include <string>
 
 namespace tt {
 
-struct formula_node {
+/** A node of a parsed formula.
+ * Nodes are allocated from the memory resource of the current `arena_scope`.
+ */
+struct formula_node : arena_allocated {
     using formula_vector = std::vector<std::unique_ptr<formula_node>>;
 
     parse_location location;
@@ -6,22 +6,26 @@
 
 #include "../required.hpp"
 #include "../tokenizer.hpp"
+#include "../arena_memory_resource.hpp"
 #include <vector>
 #include <string_view>
 
 namespace tt {
 
 struct formula_parse_context {
-    using const_iterator = typename std::vector<token_t>::const_iterator;
+    using const_iterator = typename token_vector::const_iterator;
 
     std::string_view::const_iterator first;
     std::string_view::const_iterator last;
 
-    std::vector<token_t> tokens;
+    token_vector tokens;
     const_iterator token_it;
 
+    /** Tokenize the text of a formula.
+     * The tokens are allocated from the memory resource of the current `arena_scope`.
+     */
     formula_parse_context(std::string_view::const_iterator first, std::string_view::const_iterator last) :
-        first(first), last(last), tokens(parseTokens(first, last)), token_it(tokens.begin()) {}
+        first(first), last(last), tokens(parseTokens(first, last, arena_scope::current())), token_it(tokens.begin()) {}
 
     [[nodiscard]] token_t const& operator*() const noexcept {
         return *token_it;
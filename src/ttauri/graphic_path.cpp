@@ -3,6 +3,7 @@
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "graphic_path.hpp"
+#include "path_stroker.hpp"
 #include "pixel_map.inl"
 #include "bezier_curve.hpp"
 #include "pixel_map.hpp"
@@ -436,21 +437,11 @@ graphic_path graphic_path::toStroke(float strokeWidth, LineJoinStyle lineJoinSty
     tt_assert(!hasLayers());
     tt_assert(!isContourOpen());
 
-    auto r = graphic_path{};
-
-    float starboardOffset = strokeWidth / 2;
-    float portOffset = -starboardOffset;
-
-    for (int i = 0; i < numberOfContours(); i++) {
-        ttlet baseContour = getBeziersOfContour(i);
-
-        ttlet starboardContour = makeParallelContour(baseContour, starboardOffset, lineJoinStyle, tolerance);
-        r.addContour(starboardContour);
-
-        ttlet portContour = makeInverseContour(makeParallelContour(baseContour, portOffset, lineJoinStyle, tolerance));
-        r.addContour(portContour);
-    }
+    // Reuse the buffers of the stroker between calls on the same thread.
+    thread_local auto stroker = path_stroker{};
 
+    auto r = graphic_path{};
+    stroker.stroke(r, *this, strokeWidth, lineJoinStyle, tolerance * strokeWidth);
     return r;
 }
 
@@ -527,6 +518,67 @@ void composit(pixel_map<sfloat_rgba16>& dst, graphic_path const &src) noexcept
     }
 }
 
+/** The curves and color of each layer of a path.
+ */
+using composit_layers = std::vector<std::pair<std::vector<bezier_curve>, color>>;
+
+/** Composit layers onto a band of rows of the destination image.
+ * @param dst The band of the destination image.
+ * @param band_y The y-coordinate of the bottom row of the band in the original destination image.
+ * @param layers The layers to composit.
+ */
+static void composit_band(pixel_map<sfloat_rgba16> &dst, ssize_t band_y, composit_layers const &layers) noexcept
+{
+    ttlet offset = translate2{0.0f, -narrow_cast<float>(band_y)};
+
+    auto mask = pixel_map<uint8_t>(dst.width(), dst.height());
+    auto curves = std::vector<bezier_curve>{};
+    for (ttlet &[layer_curves, fill_color] : layers) {
+        curves.clear();
+        for (ttlet &curve : layer_curves) {
+            curves.push_back(offset * curve);
+        }
+
+        fill(mask);
+        fill(mask, curves);
+        composit(dst, fill_color, mask);
+    }
+}
+
+static void parallel_composit(pixel_map<sfloat_rgba16> &dst, composit_layers const &layers) noexcept
+{
+    // Rasterizing is expensive per pixel, so smaller bands are still worth a thread.
+    constexpr ssize_t min_band_size = 0x4000;
+
+    parallel_for_each_band(
+        dst,
+        [&layers](pixel_map<sfloat_rgba16> &band, ssize_t band_y) {
+            composit_band(band, band_y, layers);
+        },
+        min_band_size);
+}
+
+void parallel_composit(pixel_map<sfloat_rgba16> &dst, color color, graphic_path const &path) noexcept
+{
+    tt_assert(!path.hasLayers());
+    tt_assert(!path.isContourOpen());
+
+    parallel_composit(dst, composit_layers{{path.getBeziers(), color}});
+}
+
+void parallel_composit(pixel_map<sfloat_rgba16> &dst, graphic_path const &src) noexcept
+{
+    tt_assert(src.hasLayers() && !src.isLayerOpen());
+
+    auto layers = composit_layers{};
+    for (int layerNr = 0; layerNr < src.numberOfLayers(); layerNr++) {
+        ttlet[layer, fill_color] = src.getLayer(layerNr);
+        layers.emplace_back(layer.getBeziers(), fill_color);
+    }
+
+    parallel_composit(dst, layers);
+}
+
 void fill(pixel_map<sdf_r8> &dst, graphic_path const &path) noexcept
 {
     fill(dst, path.getBeziers());
@@ -219,13 +219,14 @@ struct graphic_path {
     /** Convert path to stroke-path.
      *
      * This function will create contours that are offset from the original path
-     * which creates a stroke. The path will first be subdivided until the curves
-     * are mostly flat, then the curves are converted into lines and offset, then
-     * the lines are connected to each other.
+     * which creates a stroke. The path will first be flattened into polylines,
+     * then the line-segments are offset and connected to each other.
      *
      * \param strokeWidth width of the stroke.
      * \param lineJoinStyle the style of how outside corners of a stroke are drawn.
-     * \param tolerance Tolerance of how flat the curves in the path need to be.
+     * \param tolerance maximum distance between the polylines and the curves,
+     *        relative to the stroke width.
+     * \see path_stroker
      */
     [[nodiscard]] graphic_path toStroke(
         float strokeWidth = 1.0f,
@@ -268,6 +269,29 @@ void composit(pixel_map<sfloat_rgba16> &dst, tt::color color, graphic_path const
  */
 void composit(pixel_map<sfloat_rgba16> &dst, graphic_path const &mask) noexcept;
 
+/** Composit color onto the destination image where the mask is solid.
+ *
+ * The destination image is split in horizontal bands of rows. Each band is
+ * rasterized and composited on its own thread. Small images are composited
+ * on the current thread.
+ *
+ * \param dst destination image.
+ * \param color color to composit.
+ * \param mask mask where the color will be composited on the destination.
+ */
+void parallel_composit(pixel_map<sfloat_rgba16> &dst, tt::color color, graphic_path const &mask) noexcept;
+
+/** Composit color onto the destination image where the mask is solid.
+ *
+ * The destination image is split in horizontal bands of rows. Each band is
+ * rasterized and composited on its own thread, the layers of the mask are
+ * composited in order within each band.
+ *
+ * \param dst destination image.
+ * \param mask mask where the color will be composited on the destination.
+ */
+void parallel_composit(pixel_map<sfloat_rgba16> &dst, graphic_path const &mask) noexcept;
+
 /** Fill a signed distance field image from the given path.
  * @param dst An signed-distance-field which show distance toward the closest curve
  * @param path A path.
@@ -0,0 +1,52 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/graphic_path.hpp"
+#include "ttauri/pixel_map.inl"
+#include <benchmark/benchmark.h>
+
+using namespace tt;
+
+/** An icon-like path with a few overlapping layers.
+ */
+[[nodiscard]] static graphic_path make_icon_path(float size) noexcept
+{
+    auto path = graphic_path{};
+    path.addCircle(point2{size * 0.5f, size * 0.5f}, size * 0.45f);
+    path.closeLayer(color{1.0f, 0.5f, 0.0f, 1.0f});
+    path.addRectangle(aarectangle{size * 0.2f, size * 0.2f, size * 0.6f, size * 0.6f}, corner_shapes{size * 0.1f});
+    path.closeLayer(color{0.0f, 0.2f, 1.0f, 0.7f});
+    return path;
+}
+
+static void composit_serial(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    ttlet path = make_icon_path(static_cast<float>(size));
+
+    auto image = pixel_map<sfloat_rgba16>(size, size);
+    for (auto _ : state) {
+        fill(image, f32x4{});
+        composit(image, path);
+        benchmark::DoNotOptimize(image[0].data());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+static void composit_parallel(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    ttlet path = make_icon_path(static_cast<float>(size));
+
+    auto image = pixel_map<sfloat_rgba16>(size, size);
+    for (auto _ : state) {
+        fill(image, f32x4{});
+        parallel_composit(image, path);
+        benchmark::DoNotOptimize(image[0].data());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK(composit_serial)->RangeMultiplier(2)->Range(32, 1024)->UseRealTime();
+BENCHMARK(composit_parallel)->RangeMultiplier(2)->Range(32, 1024)->UseRealTime();
@@ -43,3 +43,30 @@ TEST(grahpic_path, getbezier_pointsOfContour)
     ASSERT_EQ(points[2], bezier_point(point2( 2,2 ), bezier_point::Type::Anchor));
     ASSERT_EQ(points[3], bezier_point(point2( 1,2 ), bezier_point::Type::Anchor));
 }
+
+TEST(grahpic_path, parallel_composit)
+{
+    auto path = graphic_path();
+    path.addCircle(point2{100.0f, 150.0f}, 90.0f);
+    path.closeLayer(color{1.0f, 0.0f, 0.0f, 1.0f});
+    path.addRectangle(aarectangle{40.0f, 20.0f, 120.0f, 250.0f}, corner_shapes{10.0f});
+    path.closeLayer(color{0.0f, 0.0f, 1.0f, 0.5f});
+
+    auto expected = pixel_map<sfloat_rgba16>(203, 301);
+    fill(expected, f32x4{0.0f, 1.0f, 0.0f, 1.0f});
+    composit(expected, path);
+
+    auto result = pixel_map<sfloat_rgba16>(203, 301);
+    fill(result, f32x4{0.0f, 1.0f, 0.0f, 1.0f});
+    parallel_composit(result, path);
+
+    for (auto y = 0; y != result.height(); ++y) {
+        for (auto x = 0; x != result.width(); ++x) {
+            ttlet expected_pixel = static_cast<f32x4>(expected[y][x]);
+            ttlet result_pixel = static_cast<f32x4>(result[y][x]);
+            for (auto i = 0_uz; i != 4; ++i) {
+                ASSERT_NEAR(result_pixel[i], expected_pixel[i], 0.05f);
+            }
+        }
+    }
+}
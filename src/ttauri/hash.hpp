@@ -10,6 +10,9 @@
 #include <utility>
 #include <array>
 #include <type_traits>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 
 namespace tt {
 
@@ -40,4 +43,110 @@ template<typename First, typename Second, typename... Args>
 }
 
 
-}
\ No newline at end of file
+namespace detail {
+
+constexpr uint64_t hash_bytes_prime1 = 0x9e37'79b1'85eb'ca87;
+constexpr uint64_t hash_bytes_prime2 = 0xc2b2'ae3d'27d4'eb4f;
+constexpr uint64_t hash_bytes_prime3 = 0x1656'67b1'9e37'79f9;
+constexpr uint64_t hash_bytes_prime4 = 0x85eb'ca77'c2b2'ae63;
+constexpr uint64_t hash_bytes_prime5 = 0x27d4'eb2f'1656'67c5;
+
+[[nodiscard]] tt_force_inline uint64_t hash_bytes_load64(std::byte const *ptr) noexcept
+{
+    uint64_t r;
+    std::memcpy(&r, ptr, sizeof(r));
+    return r;
+}
+
+[[nodiscard]] tt_force_inline uint64_t hash_bytes_load32(std::byte const *ptr) noexcept
+{
+    uint32_t r;
+    std::memcpy(&r, ptr, sizeof(r));
+    return r;
+}
+
+[[nodiscard]] tt_force_inline uint64_t hash_bytes_round(uint64_t accumulator, uint64_t input) noexcept
+{
+    accumulator += input * hash_bytes_prime2;
+    accumulator = std::rotl(accumulator, 31);
+    return accumulator * hash_bytes_prime1;
+}
+
+[[nodiscard]] tt_force_inline uint64_t hash_bytes_merge(uint64_t accumulator, uint64_t lane) noexcept
+{
+    accumulator ^= hash_bytes_round(0, lane);
+    return accumulator * hash_bytes_prime1 + hash_bytes_prime4;
+}
+
+} // namespace detail
+
+/** Hash a block of memory.
+ *
+ * This is the XXH64 algorithm. The bulk of the data is processed 32 bytes at
+ * a time in four independent lanes, so that the multiplications of each lane
+ * are executed in parallel by the CPU.
+ *
+ * @param ptr A pointer to the data to hash.
+ * @param size The number of bytes to hash.
+ * @param seed A seed, used to chain hashes of multiple blocks together.
+ * @return A 64 bit hash of the data.
+ */
+[[nodiscard]] inline uint64_t hash_bytes(void const *ptr, size_t size, uint64_t seed = 0) noexcept
+{
+    using namespace detail;
+
+    auto p = static_cast<std::byte const *>(ptr);
+    ttlet end = p + size;
+
+    uint64_t h;
+    if (size >= 32) {
+        auto lane1 = seed + hash_bytes_prime1 + hash_bytes_prime2;
+        auto lane2 = seed + hash_bytes_prime2;
+        auto lane3 = seed;
+        auto lane4 = seed - hash_bytes_prime1;
+
+        ttlet end32 = end - 32;
+        do {
+            lane1 = hash_bytes_round(lane1, hash_bytes_load64(p));
+            lane2 = hash_bytes_round(lane2, hash_bytes_load64(p + 8));
+            lane3 = hash_bytes_round(lane3, hash_bytes_load64(p + 16));
+            lane4 = hash_bytes_round(lane4, hash_bytes_load64(p + 24));
+            p += 32;
+        } while (p <= end32);
+
+        h = std::rotl(lane1, 1) + std::rotl(lane2, 7) + std::rotl(lane3, 12) + std::rotl(lane4, 18);
+        h = hash_bytes_merge(h, lane1);
+        h = hash_bytes_merge(h, lane2);
+        h = hash_bytes_merge(h, lane3);
+        h = hash_bytes_merge(h, lane4);
+    } else {
+        h = seed + hash_bytes_prime5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= hash_bytes_round(0, hash_bytes_load64(p));
+        h = std::rotl(h, 27) * hash_bytes_prime1 + hash_bytes_prime4;
+    }
+
+    if (p + 4 <= end) {
+        h ^= hash_bytes_load32(p) * hash_bytes_prime1;
+        h = std::rotl(h, 23) * hash_bytes_prime2 + hash_bytes_prime3;
+        p += 4;
+    }
+
+    for (; p != end; ++p) {
+        h ^= static_cast<uint64_t>(*p) * hash_bytes_prime5;
+        h = std::rotl(h, 11) * hash_bytes_prime1;
+    }
+
+    h ^= h >> 33;
+    h *= hash_bytes_prime2;
+    h ^= h >> 29;
+    h *= hash_bytes_prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace tt
@@ -43,6 +43,10 @@ std::string format_engineering(hires_utc_clock::duration duration)
         ttlet tmp_tsc2 = time_stamp_count::now();
 
         if (tmp_tsc1.cpu_id() != tmp_tsc2.cpu_id()) {
+            if (time_stamp_count::is_synchronized()) {
+                // The thread was migrated, the TSC counts are still comparable but the sample is slow.
+                continue;
+            }
             tt_log_fatal("CPU Switch detected during get_sample(), which should never happen");
         }
 
@@ -127,9 +131,64 @@ static void advance_cpu_thread_mask(uint64_t const &process_cpu_mask, uint64_t &
     } while ((process_cpu_mask & thread_cpu_mask) == 0);
 }
 
+void hires_utc_clock::subsystem_proc_synchronized(std::stop_token stop_token) noexcept
+{
+    // The TSCs of all CPUs are synchronized, so a single sample on any CPU determines the
+    // epoch of each CPU; there is no need to migrate this thread to each CPU.
+    //
+    // The frequency is refined by measuring the TSC against UTC over an interval that
+    // doubles each time up to about 17 minutes. The interval is restarted when the UTC
+    // clock is stepped by a time server, which is detected by comparing it with the steady clock.
+    ttlet process_cpu_mask = process_affinity_mask();
+
+    time_stamp_count base_tsc;
+    auto base_tp = hires_utc_clock::time_point{};
+    auto base_steady = std::chrono::steady_clock::time_point{};
+    auto next_refinement = hires_utc_clock::duration{1s};
+
+    while (!stop_token.stop_requested()) {
+        time_stamp_count tsc;
+        ttlet tp = hires_utc_clock::now(tsc);
+        ttlet steady = std::chrono::steady_clock::now();
+
+        if (base_tp == hires_utc_clock::time_point{} or std::chrono::abs((tp - base_tp) - (steady - base_steady)) > 1ms) {
+            if (base_tp != hires_utc_clock::time_point{}) {
+                tt_log_info("The UTC clock was adjusted, restarting the TSC frequency refinement.");
+            }
+            base_tsc = tsc;
+            base_tp = tp;
+            base_steady = steady;
+            next_refinement = 1s;
+
+        } else if (tp - base_tp >= next_refinement and tsc.count() > base_tsc.count()) {
+            ttlet[delta_tsc_lo, delta_tsc_hi] = wide_mul(tsc.count() - base_tsc.count(), uint64_t{1'000'000'000});
+            ttlet duration = narrow_cast<uint64_t>((tp - base_tp) / 1ns);
+            time_stamp_count::set_frequency(wide_div(delta_tsc_lo, delta_tsc_hi, duration));
+
+            if (next_refinement < 1024s) {
+                next_refinement *= 2;
+            }
+        }
+
+        // Correct the epoch for drift that accumulated since the previous sample.
+        ttlet tsc_epoch = tp - tsc.time_since_epoch();
+        for (size_t cpu_id = 0; cpu_id != process_cpu_mask.size() and cpu_id != tsc_epochs.size(); ++cpu_id) {
+            if (process_cpu_mask[cpu_id]) {
+                tsc_epochs[cpu_id].store(tsc_epoch, std::memory_order::relaxed);
+            }
+        }
+
+        std::this_thread::sleep_for(100ms);
+    }
+}
+
 void hires_utc_clock::subsystem_proc(std::stop_token stop_token) noexcept
 {
     set_thread_name("hires_utc_clock");
+    if (time_stamp_count::is_synchronized()) {
+        return subsystem_proc_synchronized(stop_token);
+    }
+
     subsystem_proc_frequency_calibration(stop_token);
 
     ttlet process_cpu_mask = process_affinity_mask();
@@ -28,7 +28,8 @@ struct hires_utc_clock {
     [[nodiscard]] static time_point now() noexcept;
 
     /** Get the current time and TSC value.
-     * @pre Use `set_thread_affinity()` to set the CPU affinity to a single CPU.
+     * @pre Use `set_thread_affinity()` to set the CPU affinity to a single CPU,
+     *      unless `time_stamp_count::is_synchronized()`.
      */
     [[nodiscard]] static time_point now(time_stamp_count &tsc) noexcept;
 
@@ -65,6 +66,7 @@ private:
     static inline std::array<std::atomic<hires_utc_clock::time_point>, maximum_num_cpus> tsc_epochs = {};
 
     static void subsystem_proc_frequency_calibration(std::stop_token stop_token) noexcept;
+    static void subsystem_proc_synchronized(std::stop_token stop_token) noexcept;
     static void subsystem_proc(std::stop_token stop_token) noexcept;
 
     /** Subsystem initializer.
@@ -10,11 +10,12 @@ namespace tt {
 hires_utc_clock::time_point hires_utc_clock::now() noexcept {
     struct timespec ts;
 
-    if (clock_gettime(CLOCK_TAI, &ts) != -1) {
+    // CLOCK_REALTIME is UTC, CLOCK_TAI would be ahead of UTC by the number of leap seconds.
+    if (clock_gettime(CLOCK_REALTIME, &ts) != 0) {
         tt_no_default();
     }
 
-    auto utc_ts = static_cast<int64_t>(ts.tv_sec) * 1000000;
+    auto utc_ts = static_cast<int64_t>(ts.tv_sec) * 1'000'000'000;
     utc_ts += ts.tv_nsec;
 
     return time_point(duration(utc_ts));
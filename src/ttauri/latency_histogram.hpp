@@ -0,0 +1,154 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+namespace tt {
+
+/** A wait-free histogram of durations with log-linear buckets.
+ *
+ * Each power-of-two range of nanoseconds is split into 16 linear sub-buckets, giving a
+ * relative error of at most 1/16 over the range of 1 ns to about 18 minutes; longer
+ * durations are counted in the last bucket.
+ *
+ * Any number of threads may `add()` durations, while a single thread takes snapshots.
+ */
+class latency_histogram {
+public:
+    static constexpr int sub_bucket_bits = 4;
+    static constexpr int nr_sub_buckets = 1 << sub_bucket_bits;
+    static constexpr int max_exponent = 40;
+    static constexpr int nr_buckets = (max_exponent - sub_bucket_bits + 1) * nr_sub_buckets;
+
+    /** The counts of a histogram at the time of a snapshot.
+     */
+    class snapshot_type {
+    public:
+        std::array<uint64_t, nr_buckets> buckets = {};
+
+        [[nodiscard]] uint64_t count() const noexcept
+        {
+            auto r = uint64_t{0};
+            for (ttlet bucket : buckets) {
+                r += bucket;
+            }
+            return r;
+        }
+
+        /** Get the duration below which a fraction of the durations falls.
+         *
+         * @param fraction A value between 0.0 and 1.0, for example 0.99 for the 99th percentile.
+         * @return The highest duration of the bucket which contains the percentile, or zero when empty.
+         */
+        [[nodiscard]] std::chrono::nanoseconds percentile(double fraction) const noexcept
+        {
+            tt_axiom(fraction >= 0.0 and fraction <= 1.0);
+
+            ttlet total = count();
+            if (total == 0) {
+                return {};
+            }
+
+            // The number of durations at or below the percentile, at least one.
+            auto rank = static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5);
+            rank = std::clamp(rank, uint64_t{1}, total);
+
+            auto seen = uint64_t{0};
+            for (auto i = 0; i != nr_buckets; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return std::chrono::nanoseconds{bucket_highest_value(i)};
+                }
+            }
+            tt_no_default();
+        }
+
+        snapshot_type &operator+=(snapshot_type const &rhs) noexcept
+        {
+            for (auto i = 0; i != nr_buckets; ++i) {
+                buckets[i] += rhs.buckets[i];
+            }
+            return *this;
+        }
+    };
+
+    constexpr latency_histogram() noexcept = default;
+    latency_histogram(latency_histogram const &) = delete;
+    latency_histogram(latency_histogram &&) = delete;
+    latency_histogram &operator=(latency_histogram const &) = delete;
+    latency_histogram &operator=(latency_histogram &&) = delete;
+
+    /** Count a duration.
+     * This is wait-free and uses a single relaxed atomic increment.
+     */
+    void add(std::chrono::nanoseconds duration) noexcept
+    {
+        _buckets[bucket_index(duration.count())].fetch_add(1, std::memory_order::relaxed);
+    }
+
+    /** Take the counts and reset the histogram.
+     * Durations added concurrently are either in this snapshot or in the next.
+     */
+    [[nodiscard]] snapshot_type take() noexcept
+    {
+        auto r = snapshot_type{};
+        for (auto i = 0; i != nr_buckets; ++i) {
+            r.buckets[i] = _buckets[i].exchange(0, std::memory_order::relaxed);
+        }
+        return r;
+    }
+
+    [[nodiscard]] constexpr static int bucket_index(int64_t value) noexcept
+    {
+        if (value < nr_sub_buckets) {
+            return value < 0 ? 0 : static_cast<int>(value);
+        }
+
+        ttlet exponent = std::bit_width(static_cast<uint64_t>(value)) - 1;
+        if (exponent >= max_exponent) {
+            return nr_buckets - 1;
+        }
+
+        ttlet shift = exponent - sub_bucket_bits;
+        ttlet sub_bucket = static_cast<int>(value >> shift) & (nr_sub_buckets - 1);
+        return (shift + 1) * nr_sub_buckets + sub_bucket;
+    }
+
+    [[nodiscard]] constexpr static int64_t bucket_lowest_value(int index) noexcept
+    {
+        tt_axiom(index >= 0 and index < nr_buckets);
+
+        if (index < nr_sub_buckets) {
+            return index;
+        }
+        ttlet shift = index / nr_sub_buckets - 1;
+        ttlet sub_bucket = index % nr_sub_buckets;
+        return static_cast<int64_t>(nr_sub_buckets + sub_bucket) << shift;
+    }
+
+    [[nodiscard]] constexpr static int64_t bucket_highest_value(int index) noexcept
+    {
+        tt_axiom(index >= 0 and index < nr_buckets);
+
+        if (index < nr_sub_buckets) {
+            return index;
+        }
+        ttlet shift = index / nr_sub_buckets - 1;
+        return bucket_lowest_value(index) + (int64_t{1} << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, nr_buckets> _buckets = {};
+};
+
+} // namespace tt
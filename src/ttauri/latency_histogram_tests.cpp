@@ -0,0 +1,95 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/latency_histogram.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+TEST(latency_histogram, bucket_index)
+{
+    // Small values have a bucket each.
+    for (auto value = 0; value != latency_histogram::nr_sub_buckets; ++value) {
+        ASSERT_EQ(latency_histogram::bucket_index(value), value);
+    }
+
+    // Each value falls between the lowest and highest value of its bucket.
+    for (auto value = int64_t{1}; value < (int64_t{1} << latency_histogram::max_exponent); value += value / 7 + 1) {
+        ttlet index = latency_histogram::bucket_index(value);
+        ASSERT_LE(latency_histogram::bucket_lowest_value(index), value);
+        ASSERT_GE(latency_histogram::bucket_highest_value(index), value);
+
+        // The relative error is at most 1/16.
+        ASSERT_LE(
+            latency_histogram::bucket_highest_value(index) - latency_histogram::bucket_lowest_value(index),
+            latency_histogram::bucket_lowest_value(index) / latency_histogram::nr_sub_buckets);
+    }
+
+    // Buckets are adjacent.
+    for (auto index = 1; index != latency_histogram::nr_buckets; ++index) {
+        ASSERT_EQ(latency_histogram::bucket_highest_value(index - 1) + 1, latency_histogram::bucket_lowest_value(index));
+    }
+
+    // Values which are out of range are clamped.
+    ASSERT_EQ(latency_histogram::bucket_index(-5), 0);
+    ASSERT_EQ(latency_histogram::bucket_index(int64_t{1} << 50), latency_histogram::nr_buckets - 1);
+}
+
+TEST(latency_histogram, percentile)
+{
+    using namespace std::chrono_literals;
+
+    auto histogram = std::make_unique<latency_histogram>();
+    for (auto i = 1; i <= 1000; ++i) {
+        histogram->add(std::chrono::microseconds{i});
+    }
+
+    ttlet snapshot = histogram->take();
+    ASSERT_EQ(snapshot.count(), 1000);
+
+    ttlet within = [](std::chrono::nanoseconds value, std::chrono::nanoseconds expected) {
+        return value >= expected and value <= expected + expected / latency_histogram::nr_sub_buckets;
+    };
+    ASSERT_TRUE(within(snapshot.percentile(0.5), 500us));
+    ASSERT_TRUE(within(snapshot.percentile(0.9), 900us));
+    ASSERT_TRUE(within(snapshot.percentile(0.99), 990us));
+    ASSERT_TRUE(within(snapshot.percentile(0.999), 999us));
+    ASSERT_TRUE(within(snapshot.percentile(1.0), 1000us));
+
+    // Taking a snapshot resets the histogram.
+    ttlet empty = histogram->take();
+    ASSERT_EQ(empty.count(), 0);
+    ASSERT_EQ(empty.percentile(0.5), 0ns);
+}
+
+TEST(latency_histogram, concurrent_add)
+{
+    auto histogram = std::make_unique<latency_histogram>();
+    auto total = latency_histogram::snapshot_type{};
+
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto t = 0; t != 4; ++t) {
+            threads.emplace_back([&histogram, t] {
+                for (auto i = 0; i != 100000; ++i) {
+                    histogram->add(std::chrono::nanoseconds{i * (t + 1)});
+                }
+            });
+        }
+
+        // Snapshots taken during the adds lose no durations.
+        for (auto i = 0; i != 100; ++i) {
+            total += histogram->take();
+        }
+    }
+
+    total += histogram->take();
+    ASSERT_EQ(total.count(), 400000);
+}
@@ -0,0 +1,240 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "log_file.hpp"
+#include "file_view.hpp"
+#include "counters.hpp"
+#include "thread.hpp"
+#include "cast.hpp"
+#include "codec/gzip.hpp"
+#include <filesystem>
+#include <format>
+#include <utility>
+
+namespace tt {
+
+log_file::log_file(log_file_options options) : _options(std::move(options))
+{
+    _buffer.reserve(_options.buffer_size);
+
+    if (std::filesystem::exists(location().nativePath())) {
+        close_segment();
+    }
+    open_segment();
+
+    _thread = std::jthread([this](std::stop_token stop_token) {
+        loop(stop_token);
+    });
+}
+
+log_file::~log_file()
+{
+    _thread.request_stop();
+    _thread.join();
+}
+
+URL log_file::location() const noexcept
+{
+    return _options.directory / std::format("{}.log", _options.name);
+}
+
+std::string log_file::take_free_buffer() noexcept
+{
+    if (_free_buffers.empty()) {
+        auto r = std::string{};
+        r.reserve(_options.buffer_size);
+        return r;
+    }
+
+    auto r = std::move(_free_buffers.back());
+    _free_buffers.pop_back();
+    return r;
+}
+
+void log_file::open_segment()
+{
+    _file = std::make_unique<file>(location(), access_mode::truncate_or_create_for_write | access_mode::create_directories);
+    _segment_size = 0;
+    _segment_start = std::chrono::system_clock::now();
+}
+
+void log_file::close_segment() noexcept
+{
+    using namespace std::chrono;
+
+    try {
+        if (_file) {
+            _file->close();
+            _file = nullptr;
+        }
+
+        // The sequence restarts in each process, so skip names of segments left by an earlier process.
+        ttlet now = floor<seconds>(system_clock::now());
+        auto closed_location = URL{};
+        auto compressed_location = URL{};
+        do {
+            ttlet closed_name = std::format("{}-{:%Y%m%dT%H%M%S}-{}.log", _options.name, now, _segment_sequence++);
+            closed_location = _options.directory / closed_name;
+            compressed_location = _options.directory / std::format("{}.gz", closed_name);
+        } while (std::filesystem::exists(closed_location.nativePath()) or
+                 std::filesystem::exists(compressed_location.nativePath()));
+
+        std::filesystem::rename(location().nativePath(), closed_location.nativePath());
+
+        if (_options.compress) {
+            // Compress on a separate thread, so that flushing is not stalled. Only one
+            // segment is compressed at a time.
+            if (_compress_thread.joinable()) {
+                _compress_thread.join();
+            }
+            _compress_thread = std::jthread([closed_location, compressed_location] {
+                set_thread_name("log_file_compress");
+                compress_segment(closed_location, compressed_location);
+            });
+        }
+
+    } catch (...) {
+        increment_counter<"log_file_error">();
+    }
+}
+
+void log_file::compress_segment(URL const &closed_location, URL const &compressed_location) noexcept
+{
+    try {
+        {
+            ttlet view = file_view(closed_location);
+            ttlet compressed = gzip_compress(view.bytes());
+
+            auto compressed_file = file(compressed_location, access_mode::truncate_or_create_for_write);
+            compressed_file.write(bstring_view{compressed});
+            compressed_file.close();
+        }
+        std::filesystem::remove(closed_location.nativePath());
+
+    } catch (...) {
+        increment_counter<"log_file_error">();
+    }
+}
+
+void log_file::write_buffer(std::string const &buffer) noexcept
+{
+    if (_segment_size != 0 and _segment_size + buffer.size() > _options.max_segment_size) {
+        close_segment();
+        try {
+            open_segment();
+        } catch (...) {
+            increment_counter<"log_file_error">();
+        }
+    }
+
+    if (not _file) {
+        // The segment could not be opened, try again with the next buffer.
+        try {
+            open_segment();
+        } catch (...) {
+            increment_counter<"log_file_error">();
+            return;
+        }
+    }
+
+    try {
+        _file->write(std::string_view{buffer});
+        _segment_size += buffer.size();
+        increment_counter<"log_file_bytes">(std::ssize(buffer));
+    } catch (...) {
+        increment_counter<"log_file_error">();
+    }
+}
+
+void log_file::loop(std::stop_token stop_token) noexcept
+{
+    using namespace std::chrono;
+
+    set_thread_name("log_file");
+
+    auto buffers = std::vector<std::string>{};
+    while (true) {
+        auto flush_request = uint64_t{0};
+        auto stop = false;
+        {
+            auto lock = std::unique_lock(_mutex);
+            _condition.wait_for(lock, stop_token, _options.flush_interval, [this] {
+                return not _full_buffers.empty() or _flush_request != _flush_done;
+            });
+
+            // Text written before the stop was requested is in the buffers taken below.
+            stop = stop_token.stop_requested();
+
+            std::swap(buffers, _full_buffers);
+            if (not _buffer.empty()) {
+                buffers.push_back(std::exchange(_buffer, take_free_buffer()));
+            }
+            flush_request = _flush_request;
+        }
+
+        if (not buffers.empty()) {
+            ttlet start = steady_clock::now();
+            for (ttlet &buffer : buffers) {
+                write_buffer(buffer);
+            }
+            increment_counter<"log_file_flush">();
+            increment_counter<"log_file_flush_ns">(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+        }
+
+        if (_segment_size != 0 and system_clock::now() - _segment_start >= _options.max_segment_age) {
+            close_segment();
+            try {
+                open_segment();
+            } catch (...) {
+                increment_counter<"log_file_error">();
+            }
+        }
+
+        {
+            ttlet lock = std::scoped_lock(_mutex);
+            for (auto &buffer : buffers) {
+                if (_free_buffers.size() < _options.max_nr_buffers) {
+                    buffer.clear();
+                    _free_buffers.push_back(std::move(buffer));
+                }
+            }
+            buffers.clear();
+            _flush_done = flush_request;
+        }
+        _flushed_condition.notify_all();
+
+        if (stop) {
+            break;
+        }
+    }
+}
+
+void log_file::write(std::string_view text) noexcept
+{
+    ttlet lock = std::scoped_lock(_mutex);
+
+    if (not _buffer.empty() and _buffer.size() + text.size() > _options.buffer_size) {
+        if (_full_buffers.size() >= _options.max_nr_buffers) {
+            increment_counter<"log_file_drop">();
+            return;
+        }
+
+        _full_buffers.push_back(std::exchange(_buffer, take_free_buffer()));
+        _condition.notify_one();
+    }
+
+    _buffer.append(text);
+}
+
+void log_file::flush() noexcept
+{
+    auto lock = std::unique_lock(_mutex);
+    ttlet request = ++_flush_request;
+    _condition.notify_one();
+    _flushed_condition.wait(lock, [this, request] {
+        return _flush_done >= request;
+    });
+}
+
+} // namespace tt
@@ -0,0 +1,150 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "URL.hpp"
+#include "file.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace tt {
+
+struct log_file_options {
+    /** The directory where the log files are created.
+     */
+    URL directory = URL::urlFromApplicationLogDirectory();
+
+    /** The name of the log files.
+     * The current segment is called "<name>.log", closed segments "<name>-<date>T<time>-<sequence>.log".
+     */
+    std::string name = "log";
+
+    /** The size of each buffer in bytes, a buffer is written to the file with a single write.
+     */
+    size_t buffer_size = 1024 * 1024;
+
+    /** The number of full buffers that may wait to be written.
+     * Messages are dropped when all buffers are full.
+     */
+    size_t max_nr_buffers = 4;
+
+    /** The time between writing partially filled buffers.
+     */
+    std::chrono::milliseconds flush_interval = std::chrono::seconds{1};
+
+    /** A new segment is started when the current segment would grow beyond this size in bytes.
+     */
+    size_t max_segment_size = 64 * 1024 * 1024;
+
+    /** A new segment is started when the current segment is older than this.
+     */
+    std::chrono::seconds max_segment_age = std::chrono::hours{24};
+
+    /** Compress closed segments into "<name>-<date>T<time>-<sequence>.log.gz".
+     */
+    bool compress = false;
+};
+
+/** A log file which is written asynchronously.
+ *
+ * Text is accumulated in large buffers, which are written to the file by a background thread.
+ * The log file is split into segments by size and age, closed segments are optionally compressed.
+ *
+ * The following counters are maintained:
+ *  - "log_file_bytes": The number of bytes written to the file.
+ *  - "log_file_flush": The number of times buffers were written to the file.
+ *  - "log_file_flush_ns": The total time in nanoseconds spent writing buffers to the file.
+ *  - "log_file_drop": The number of messages dropped because all buffers were full.
+ *  - "log_file_error": The number of failed writes, rotations and compressions.
+ */
+class log_file {
+public:
+    /** Open the log file and start the background thread.
+     * An existing log file is closed as a segment first.
+     *
+     * @throw io_error When the log file could not be created.
+     */
+    log_file(log_file_options options);
+
+    /** Write all the buffered text to the file and stop the background thread.
+     */
+    ~log_file();
+
+    log_file(log_file const &) = delete;
+    log_file(log_file &&) = delete;
+    log_file &operator=(log_file const &) = delete;
+    log_file &operator=(log_file &&) = delete;
+
+    /** Add text to the log file.
+     * The text is written to the file later by the background thread.
+     * This function does not block on file I/O.
+     */
+    void write(std::string_view text) noexcept;
+
+    /** Write all the buffered text to the file.
+     * This function blocks until the background thread has written the text.
+     */
+    void flush() noexcept;
+
+private:
+    log_file_options _options;
+
+    std::mutex _mutex;
+    std::condition_variable_any _condition;
+    std::condition_variable_any _flushed_condition;
+
+    /** The buffer that is being filled by `write()`.
+     */
+    std::string _buffer;
+
+    /** Full buffers waiting to be written by the background thread.
+     */
+    std::vector<std::string> _full_buffers;
+
+    /** Empty buffers which can be reused.
+     */
+    std::vector<std::string> _free_buffers;
+
+    uint64_t _flush_request = 0;
+    uint64_t _flush_done = 0;
+
+    // The following are only used by the background thread, after construction.
+    std::unique_ptr<file> _file;
+    size_t _segment_size = 0;
+    std::chrono::system_clock::time_point _segment_start;
+    int _segment_sequence = 0;
+
+    std::jthread _thread;
+
+    /** Compresses the last closed segment.
+     */
+    std::jthread _compress_thread;
+
+    [[nodiscard]] URL location() const noexcept;
+    [[nodiscard]] std::string take_free_buffer() noexcept;
+
+    void open_segment();
+
+    /** Rename the current segment and start compressing it when requested.
+     */
+    void close_segment() noexcept;
+
+    /** Compress a closed segment and remove the uncompressed segment.
+     */
+    static void compress_segment(URL const &closed_location, URL const &compressed_location) noexcept;
+
+    void write_buffer(std::string const &buffer) noexcept;
+    void loop(std::stop_token stop_token) noexcept;
+};
+
+} // namespace tt
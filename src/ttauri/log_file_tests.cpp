@@ -0,0 +1,146 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/log_file.hpp"
+#include "ttauri/file_view.hpp"
+#include "ttauri/codec/gzip.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+[[nodiscard]] static log_file_options make_log_file_options(std::string_view directory)
+{
+    std::filesystem::remove_all(URL(std::format("file:{}", directory)).nativePath());
+
+    auto r = log_file_options{};
+    r.directory = URL(std::format("file:{}", directory));
+    r.name = "test";
+    r.buffer_size = 256;
+    return r;
+}
+
+/** The names of the closed segments in a directory, sorted by their sequence number.
+ */
+[[nodiscard]] static std::vector<std::string> closed_segments(URL const &directory)
+{
+    auto r = std::vector<std::string>{};
+    for (ttlet &entry : std::filesystem::directory_iterator(directory.nativePath())) {
+        ttlet name = entry.path().filename().string();
+        if (name != "test.log") {
+            r.push_back(name);
+        }
+    }
+    std::sort(r.begin(), r.end(), [](ttlet &lhs, ttlet &rhs) {
+        return std::stoi(lhs.substr(lhs.rfind('-') + 1)) < std::stoi(rhs.substr(rhs.rfind('-') + 1));
+    });
+    return r;
+}
+
+[[nodiscard]] static std::string read_text(URL const &location)
+{
+    ttlet view = file_view(location);
+    ttlet bytes = view.bytes();
+    return std::string(reinterpret_cast<char const *>(bytes.data()), bytes.size());
+}
+
+TEST(log_file, write)
+{
+    ttlet options = make_log_file_options("log_file_test1");
+
+    auto expected = std::string{};
+    {
+        auto file = log_file(options);
+        for (auto i = 0; i != 100; ++i) {
+            ttlet line = std::format("message {}\n", i);
+            file.write(line);
+            expected += line;
+        }
+        file.flush();
+        ASSERT_EQ(read_text(options.directory / "test.log"), expected);
+
+        file.write("last\n");
+        expected += "last\n";
+    }
+
+    // The destructor writes the remaining text.
+    ASSERT_EQ(read_text(options.directory / "test.log"), expected);
+}
+
+TEST(log_file, rotate_by_size)
+{
+    auto options = make_log_file_options("log_file_test2");
+    options.max_segment_size = 1000;
+
+    auto expected = std::string{};
+    {
+        auto file = log_file(options);
+        for (auto i = 0; i != 1000; ++i) {
+            ttlet line = std::format("message {}\n", i);
+            file.write(line);
+            expected += line;
+            if (i % 10 == 0) {
+                file.flush();
+            }
+        }
+    }
+
+    auto text = std::string{};
+    for (ttlet &name : closed_segments(options.directory)) {
+        ttlet segment = read_text(options.directory / name);
+        ASSERT_LE(segment.size(), options.max_segment_size);
+        text += segment;
+    }
+    text += read_text(options.directory / "test.log");
+    ASSERT_EQ(text, expected);
+}
+
+TEST(log_file, compress)
+{
+    auto options = make_log_file_options("log_file_test3");
+    options.compress = true;
+
+    {
+        auto file = log_file(options);
+        file.write("first segment\n");
+    }
+
+    // Opening the log file again closes and compresses the previous segment.
+    {
+        auto file = log_file(options);
+        file.write("second segment\n");
+    }
+
+    ttlet segments = closed_segments(options.directory);
+    ASSERT_EQ(segments.size(), 1);
+    ASSERT_TRUE(segments[0].ends_with(".log.gz"));
+
+    ttlet decompressed = gzip_decompress(options.directory / segments[0]);
+    ASSERT_EQ(std::string(reinterpret_cast<char const *>(decompressed.data()), decompressed.size()), "first segment\n");
+    ASSERT_EQ(read_text(options.directory / "test.log"), "second segment\n");
+}
+
+TEST(log_file, restart)
+{
+    ttlet options = make_log_file_options("log_file_test4");
+
+    // Each log_file starts with sequence number zero, restarting within the same second
+    // must not overwrite a segment left by an earlier log_file.
+    for (auto i = 0; i != 3; ++i) {
+        auto file = log_file(options);
+        file.write(std::format("segment {}\n", i));
+    }
+
+    ttlet segments = closed_segments(options.directory);
+    ASSERT_EQ(segments.size(), 2);
+    ASSERT_EQ(read_text(options.directory / segments[0]), "segment 0\n");
+    ASSERT_EQ(read_text(options.directory / segments[1]), "segment 1\n");
+    ASSERT_EQ(read_text(options.directory / "test.log"), "segment 2\n");
+}
@@ -5,6 +5,7 @@
 #include "logger.hpp"
 #include "trace.hpp"
 #include "required.hpp"
+#include "cast.hpp"
 #include "URL.hpp"
 #include "strings.hpp"
 #include "thread.hpp"
@@ -12,6 +13,8 @@
 #include "timer.hpp"
 #include "unfair_recursive_mutex.hpp"
 #include "console.hpp"
+#include "binary_log.hpp"
+#include "log_file.hpp"
 #include <format>
 #include <exception>
 #include <memory>
@@ -19,6 +22,9 @@
 #include <ostream>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 namespace tt {
 namespace detail {
@@ -27,24 +33,63 @@ using namespace std::literals::chrono_literals;
 
 /*! Write to a log file and console.
  * This will write to the console if one is open.
- * It will also create a log file in the application-data directory.
+ * It will also write to the log file when it was started with `logger_start_log_file()`.
  */
-static void logger_write(std::string const &str) noexcept
+static void logger_write(std::string const &str, log_file *sink) noexcept
 {
     console_output(str);
+    if (sink) {
+        sink->write(str);
+    }
 }
 
-unfair_mutex logger_mutex;
+unfair_mutex logger_mutex{unfair_mutex_statistics_of<"logger">};
 std::jthread logger_thread;
 
+/** The binary log, or empty when messages are written to the console.
+ * Protected by `logger_mutex`.
+ */
+std::unique_ptr<binary_log_writer> logger_binary_log;
+
+/** The log file, or empty when messages are only written to the console.
+ * Protected by `logger_mutex`, `logger_flush()` keeps a reference while writing outside the lock.
+ */
+std::shared_ptr<log_file> logger_log_file;
+
+/** The maximum time a message may stay in the log queue.
+ * The logger thread is woken up by `log_wakeup()` when a message is added,
+ * it also flushes at least this often as an upper bound on the flush latency.
+ */
+constexpr auto logger_max_flush_latency = 100ms;
+
+std::mutex logger_wakeup_mutex;
+std::condition_variable_any logger_wakeup_condition;
+
+void log_wakeup() noexcept
+{
+    if (not log_pending.exchange(true)) {
+        // Synchronize with the logger thread checking `log_pending` before waiting.
+        { ttlet lock = std::scoped_lock(logger_wakeup_mutex); }
+        logger_wakeup_condition.notify_one();
+    }
+}
+
 static void logger_thread_loop(std::stop_token stop_token) noexcept
 {
     set_thread_name("logger");
     tt_log_info("logger thread started");
 
     while (!stop_token.stop_requested()) {
+        // Clear before flushing, so that a message added during the flush wakes up the thread again.
+        // The fence pairs with the fence in `log()` between adding a message and reading `log_pending`.
+        log_pending.store(false, std::memory_order::relaxed);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
         logger_flush();
-        std::this_thread::sleep_for(100ms);
+
+        auto lock = std::unique_lock(logger_wakeup_mutex);
+        logger_wakeup_condition.wait_for(lock, stop_token, logger_max_flush_latency, [] {
+            return log_pending.load();
+        });
     }
 
     tt_log_info("logger thread finished");
@@ -81,23 +126,84 @@ void logger_flush() noexcept
 {
     ttlet t = trace<"log_flush">{};
 
-    bool wrote_message;
+    auto copy_of_messages = std::vector<std::unique_ptr<detail::log_message_base>>{};
+    auto count = size_t{0};
+    auto log_file = std::shared_ptr<tt::log_file>{};
     do {
-        std::unique_ptr<detail::log_message_base> copy_of_message;
+        copy_of_messages.clear();
 
         {
             ttlet lock = std::scoped_lock(detail::logger_mutex);
-
-            wrote_message = detail::log_fifo.take_one([&copy_of_message](auto &message) {
-                copy_of_message = message.make_unique_copy();
+            log_file = detail::logger_log_file;
+
+            // Copy the messages so that the slots in the fifo are released before formatting.
+            // Messages for the binary log are not formatted, so they are written directly from the fifo.
+            count = detail::log_fifo.take_all([&copy_of_messages](auto &message) {
+                if (detail::logger_binary_log) {
+                    detail::logger_binary_log->write(message);
+                    if (not static_cast<bool>(message.binary_format().level & (log_level::error | log_level::fatal))) {
+                        return;
+                    }
+                }
+                copy_of_messages.push_back(message.make_unique_copy());
             });
         }
 
-        if (wrote_message) {
+        auto has_fatal = false;
+        for (ttlet &copy_of_message : copy_of_messages) {
             tt_axiom(copy_of_message);
-            detail::logger_write(copy_of_message->format());
+            detail::logger_write(copy_of_message->format(), log_file.get());
+            has_fatal |= static_cast<bool>(copy_of_message->binary_format().level & log_level::fatal);
         }
-    } while (wrote_message);
+        if (has_fatal and log_file) {
+            // The application terminates after a fatal message.
+            log_file->flush();
+        }
+        if (count != 0) {
+            increment_counter<"log_message">(narrow_cast<int64_t>(count));
+        }
+    } while (count != 0);
+}
+
+void logger_start_log_file(log_file_options const &options)
+{
+    auto log_file = std::make_shared<tt::log_file>(options);
+
+    ttlet lock = std::scoped_lock(detail::logger_mutex);
+    detail::logger_log_file = std::move(log_file);
+}
+
+void logger_start_log_file()
+{
+    logger_start_log_file(log_file_options{});
+}
+
+void logger_stop_log_file() noexcept
+{
+    logger_flush();
+
+    auto log_file = std::shared_ptr<tt::log_file>{};
+    {
+        ttlet lock = std::scoped_lock(detail::logger_mutex);
+        log_file = std::move(detail::logger_log_file);
+    }
+    // The destructor writes the remaining buffers, which is done outside the lock.
+}
+
+void logger_start_binary_log(URL const &location, size_t capacity)
+{
+    auto binary_log = std::make_unique<binary_log_writer>(location, capacity);
+
+    ttlet lock = std::scoped_lock(detail::logger_mutex);
+    detail::logger_binary_log = std::move(binary_log);
+}
+
+void logger_stop_binary_log() noexcept
+{
+    logger_flush();
+
+    ttlet lock = std::scoped_lock(detail::logger_mutex);
+    detail::logger_binary_log = nullptr;
 }
 
 } // namespace tt
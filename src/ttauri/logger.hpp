@@ -18,6 +18,7 @@
 #include "fixed_string.hpp"
 #include "subsystem.hpp"
 #include "log_level.hpp"
+#include "binary_log_format.hpp"
 #include <chrono>
 #include <format>
 #include <string>
@@ -26,8 +27,11 @@
 #include <mutex>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 namespace tt {
+class URL;
+struct log_file_options;
 void trace_record() noexcept;
 }
 
@@ -41,6 +45,18 @@ public:
 
     [[nodiscard]] virtual std::string format() const noexcept = 0;
     [[nodiscard]] virtual std::unique_ptr<log_message_base> make_unique_copy() const noexcept = 0;
+
+    /** The static description of the message, used by the binary log.
+     * The address of the description is unique for each log statement.
+     */
+    [[nodiscard]] virtual binary_log_format const &binary_format() const noexcept = 0;
+
+    [[nodiscard]] virtual time_stamp_count const &time_stamp() const noexcept = 0;
+
+    /** Append the raw bytes of the arguments of the message.
+     * @pre `binary_format().serializable` must be true.
+     */
+    virtual void append_binary_arguments(std::vector<std::byte> &bytes) const noexcept = 0;
 };
 
 template<log_level Level, basic_fixed_string SourceFile, int SourceLine, basic_fixed_string Fmt, typename... Values>
@@ -86,7 +102,36 @@ public:
         return std::make_unique<log_message>(*this);
     }
 
+    [[nodiscard]] binary_log_format const &binary_format() const noexcept override
+    {
+        return _binary_format;
+    }
+
+    [[nodiscard]] time_stamp_count const &time_stamp() const noexcept override
+    {
+        return _time_stamp;
+    }
+
+    void append_binary_arguments(std::vector<std::byte> &bytes) const noexcept override
+    {
+        if constexpr (binary_log_serializable<Values...>) {
+            binary_log_append_arguments(bytes, _what.values());
+        } else {
+            tt_no_default();
+        }
+    }
+
 private:
+    static constexpr auto _binary_argument_types = binary_log_argument_types<Values...>;
+
+    static constexpr auto _binary_format = binary_log_format{
+        Level,
+        SourceFile.c_str(),
+        SourceLine,
+        Fmt.c_str(),
+        std::span<binary_log_argument_type const>{_binary_argument_types},
+        binary_log_serializable<Values...>};
+
     time_stamp_count _time_stamp;
     delayed_format<Fmt, Values...> _what;
 };
@@ -95,6 +140,15 @@ private:
  */
 inline wfree_fifo<log_message_base, 256> log_fifo;
 
+/** Set when a message was added to the log queue after the logger thread started flushing.
+ * Only the first message of a burst needs to wake up the logger thread.
+ */
+inline std::atomic<bool> log_pending = false;
+
+/** Wake up the logger thread to flush the log queue.
+ */
+tt_no_inline void log_wakeup() noexcept;
+
 /** Deinitalize the logger system.
  */
 tt_no_inline void logger_deinit() noexcept;
@@ -120,6 +174,40 @@ inline std::atomic<bool> logger_is_running = false;
  */
 tt_no_inline void logger_flush() noexcept;
 
+/** Write log messages to a log file as well as the console.
+ * Messages are collected in large buffers which are written to the file by a
+ * background thread, see `log_file`.
+ *
+ * @param options The location of the log file and how it is rotated.
+ * @throw io_error When the file could not be created.
+ */
+void logger_start_log_file(log_file_options const &options);
+
+/** Write log messages to a log file in the application's log directory as well as the console.
+ * @throw io_error When the file could not be created.
+ */
+void logger_start_log_file();
+
+/** Stop writing log messages to the log file.
+ * Buffered messages are written to the file before it is closed.
+ */
+void logger_stop_log_file() noexcept;
+
+/** Write log messages to a binary log file instead of the console.
+ * Messages are written without formatting them, see `binary_log_writer`.
+ * Error and fatal messages are still written to the console as well.
+ *
+ * @param location The location of the binary log file, an existing file is overwritten.
+ * @param capacity The size of the ring buffer for messages in bytes.
+ * @throw io_error When the file could not be created.
+ */
+void logger_start_binary_log(URL const &location, size_t capacity = 64 * 1024 * 1024);
+
+/** Stop writing log messages to the binary log file.
+ * Messages are written to the console again.
+ */
+void logger_stop_binary_log() noexcept;
+
 /** Start the logger system.
  * Initialize the logger system if it is not already initialized and while the system is not in shutdown-mode.
  * @return true if the logger system is initialized, false when the system is being shutdown.
@@ -166,6 +254,16 @@ tt_force_inline void log(Args &&...args) noexcept
         // If the logger did not start we will log in degraded mode and log from the current thread.
         // On fatal error we also want to log from the current thread.
         [[unlikely]] logger_flush();
+
+    } else {
+        // The fence orders adding the message before reading `log_pending`; it pairs with the fence in the
+        // logger thread between clearing `log_pending` and flushing. Either this thread sees `false`
+        // and wakes up the logger thread, or the logger thread's flush sees the message.
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        if (!detail::log_pending.load(std::memory_order::relaxed)) {
+            // Wake up the logger thread once for a burst of messages.
+            [[unlikely]] detail::log_wakeup();
+        }
     }
 
     if constexpr (static_cast<bool>(Level & log_level::fatal)) {
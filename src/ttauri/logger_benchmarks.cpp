@@ -0,0 +1,89 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/logger.hpp"
+#include "ttauri/counters.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace tt;
+
+/** Enable info messages and discard the console output while benchmarking.
+ */
+class logger_benchmark_scope {
+public:
+    logger_benchmark_scope() noexcept :
+        _log_level(log_level_global.exchange(make_log_level(log_level::info))), _cout_buffer(std::cout.rdbuf(nullptr))
+    {
+        logger_start();
+    }
+
+    ~logger_benchmark_scope()
+    {
+        logger_flush();
+        std::cout.rdbuf(_cout_buffer);
+        std::cout.clear();
+        log_level_global.store(_log_level);
+    }
+
+private:
+    log_level _log_level;
+    std::streambuf *_cout_buffer;
+};
+
+/** The overhead of a log call on the calling thread.
+ */
+static void log_call(benchmark::State &state)
+{
+    ttlet scope = logger_benchmark_scope{};
+
+    auto i = 0;
+    for (auto _ : state) {
+        tt_log_info("benchmark message {} {}", i++, 3.14);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** The time between a log call and the logger thread writing the message.
+ * The argument is the number of threads that log continuously in the background.
+ * Under load the iteration ends when the logger thread wrote any batch of messages,
+ * which may be the batch just before the one with the measured message.
+ */
+static void log_delivery_latency(benchmark::State &state)
+{
+    using namespace std::chrono;
+
+    ttlet scope = logger_benchmark_scope{};
+
+    auto stop = std::atomic<bool>{false};
+    auto background_threads = std::vector<std::jthread>{};
+    for (auto i = 0; i != state.range(0); ++i) {
+        background_threads.emplace_back([&stop] {
+            auto j = 0;
+            while (not stop.load(std::memory_order::relaxed)) {
+                tt_log_info("background message {}", j++);
+                std::this_thread::sleep_for(10us);
+            }
+        });
+    }
+
+    for (auto _ : state) {
+        ttlet count = read_counter<"log_message">();
+        ttlet start = steady_clock::now();
+        tt_log_info("latency message");
+        while (read_counter<"log_message">() == count) {
+            std::this_thread::yield();
+        }
+        state.SetIterationTime(duration_cast<duration<double>>(steady_clock::now() - start).count());
+    }
+
+    stop = true;
+}
+
+BENCHMARK(log_call);
+BENCHMARK(log_delivery_latency)->Arg(0)->Arg(1)->Arg(4)->UseManualTime()->Unit(benchmark::kMicrosecond);
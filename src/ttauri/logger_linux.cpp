@@ -0,0 +1,16 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "logger.hpp"
+#include <cerrno>
+#include <cstring>
+
+namespace tt {
+
+[[nodiscard]] std::string get_last_error_message() noexcept
+{
+    return std::strerror(errno);
+}
+
+} // namespace tt
@@ -0,0 +1,190 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "metrics.hpp"
+#include "counters.hpp"
+#include "trace.hpp"
+#include "file.hpp"
+#include "thread.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <mutex>
+#include <thread>
+
+namespace tt {
+
+static std::mutex metrics_exporter_mutex;
+static std::jthread metrics_exporter_thread;
+
+[[nodiscard]] metrics_snapshot take_metrics_snapshot() noexcept
+{
+    auto r = metrics_snapshot{};
+    r.time_point = hires_utc_clock::now();
+
+    for (auto &[name, item] : counter_map.items()) {
+        ttlet value = item.read != nullptr ? item.read() : 0;
+        r.counters.push_back(counter_metric{std::move(name), value});
+    }
+
+    for (auto &[name, stat] : trace_statistics_map.items()) {
+        if (stat != nullptr) {
+            ttlet total = stat->read_total();
+            r.traces.push_back(trace_metric{std::move(name), total.count, total.duration});
+        }
+    }
+
+    std::sort(r.counters.begin(), r.counters.end(), [](ttlet &lhs, ttlet &rhs) {
+        return lhs.name < rhs.name;
+    });
+    std::sort(r.traces.begin(), r.traces.end(), [](ttlet &lhs, ttlet &rhs) {
+        return lhs.name < rhs.name;
+    });
+    return r;
+}
+
+/** Append a string with the escapes shared by OpenMetrics label values and JSON strings.
+ */
+static void metrics_append_quoted(std::string &r, std::string_view str) noexcept
+{
+    r += '"';
+    for (ttlet c : str) {
+        switch (c) {
+        case '"': r += "\\\""; break;
+        case '\\': r += "\\\\"; break;
+        case '\n': r += "\\n"; break;
+        default: r += c;
+        }
+    }
+    r += '"';
+}
+
+[[nodiscard]] static double metrics_seconds(std::chrono::nanoseconds duration) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+}
+
+[[nodiscard]] std::string to_open_metrics(metrics_snapshot const &snapshot) noexcept
+{
+    auto r = std::string{};
+
+    r += "# TYPE tt_counter counter\n";
+    for (ttlet &counter : snapshot.counters) {
+        r += "tt_counter_total{name=";
+        metrics_append_quoted(r, counter.name);
+        r += std::format("}} {}\n", counter.value);
+    }
+
+    r += "# TYPE tt_trace_seconds summary\n";
+    r += "# UNIT tt_trace_seconds seconds\n";
+    for (ttlet &trace : snapshot.traces) {
+        r += "tt_trace_seconds_count{name=";
+        metrics_append_quoted(r, trace.name);
+        r += std::format("}} {}\n", trace.count);
+
+        r += "tt_trace_seconds_sum{name=";
+        metrics_append_quoted(r, trace.name);
+        r += std::format("}} {}\n", metrics_seconds(trace.duration));
+    }
+
+    r += "# EOF\n";
+    return r;
+}
+
+[[nodiscard]] std::string to_json(metrics_snapshot const &snapshot) noexcept
+{
+    auto r = std::string{};
+
+    r += "{\"time\":";
+    metrics_append_quoted(r, format_iso8601_utc(snapshot.time_point));
+
+    r += ",\"counters\":{";
+    for (auto i = size_t{0}; i != snapshot.counters.size(); ++i) {
+        if (i != 0) {
+            r += ',';
+        }
+        metrics_append_quoted(r, snapshot.counters[i].name);
+        r += std::format(":{}", snapshot.counters[i].value);
+    }
+
+    r += "},\"traces\":{";
+    for (auto i = size_t{0}; i != snapshot.traces.size(); ++i) {
+        if (i != 0) {
+            r += ',';
+        }
+        metrics_append_quoted(r, snapshot.traces[i].name);
+        r += std::format(":{{\"count\":{},\"duration_ns\":{}}}", snapshot.traces[i].count, snapshot.traces[i].duration.count());
+    }
+
+    r += "}}\n";
+    return r;
+}
+
+/** Write the metrics to a temporary file, then rename it over the destination.
+ */
+static void metrics_export(metrics_exporter_options const &options) noexcept
+{
+    ttlet snapshot = take_metrics_snapshot();
+    ttlet text = options.format == metrics_format::json ? to_json(snapshot) : to_open_metrics(snapshot);
+
+    try {
+        ttlet destination = std::filesystem::path{options.location.nativePath()};
+        auto temporary = destination;
+        temporary += ".tmp";
+
+        {
+            auto tmp_file = file(URL::urlFromPath(temporary.string()), access_mode::truncate_or_create_for_write);
+            tmp_file.write(std::string_view{text});
+            tmp_file.close();
+        }
+        std::filesystem::rename(temporary, destination);
+
+    } catch (...) {
+        increment_counter<"metrics_export_error">();
+    }
+}
+
+static void metrics_exporter_loop(std::stop_token stop_token, metrics_exporter_options options) noexcept
+{
+    set_thread_name("metrics_exporter");
+
+    auto mutex = std::mutex{};
+    auto condition = std::condition_variable_any{};
+
+    while (not stop_token.stop_requested()) {
+        metrics_export(options);
+
+        auto lock = std::unique_lock(mutex);
+        condition.wait_for(lock, stop_token, options.interval, [] {
+            return false;
+        });
+    }
+
+    // Write the final values.
+    metrics_export(options);
+}
+
+void metrics_exporter_start(metrics_exporter_options const &options)
+{
+    ttlet lock = std::scoped_lock(metrics_exporter_mutex);
+
+    if (metrics_exporter_thread.joinable()) {
+        return;
+    }
+    metrics_exporter_thread = std::jthread(metrics_exporter_loop, options);
+}
+
+void metrics_exporter_stop() noexcept
+{
+    ttlet lock = std::scoped_lock(metrics_exporter_mutex);
+
+    if (metrics_exporter_thread.joinable()) {
+        metrics_exporter_thread.request_stop();
+        metrics_exporter_thread.join();
+        metrics_exporter_thread = {};
+    }
+}
+
+} // namespace tt
@@ -0,0 +1,87 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "hires_utc_clock.hpp"
+#include "URL.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tt {
+
+struct counter_metric {
+    std::string name;
+    int64_t value;
+};
+
+struct trace_metric {
+    std::string name;
+
+    /** The number of completed traces.
+     */
+    int64_t count;
+
+    /** The total duration of the completed traces.
+     */
+    std::chrono::nanoseconds duration;
+};
+
+/** The values of all registered counters and trace statistics at a point in time.
+ * Counters and traces are sorted by name.
+ */
+struct metrics_snapshot {
+    hires_utc_clock::time_point time_point;
+    std::vector<counter_metric> counters;
+    std::vector<trace_metric> traces;
+};
+
+/** Take a snapshot of all the counters and trace statistics.
+ *
+ * The values are totals since the start of the application; unlike the statistics
+ * log this does not reset anything, so it may be called from any thread at any time.
+ */
+[[nodiscard]] metrics_snapshot take_metrics_snapshot() noexcept;
+
+/** Format a snapshot in the OpenMetrics text format.
+ *
+ * Counters are exported as the `tt_counter` family, traces as the `tt_trace_seconds`
+ * summary family, each with the name of the counter or trace as the `name` label.
+ */
+[[nodiscard]] std::string to_open_metrics(metrics_snapshot const &snapshot) noexcept;
+
+/** Format a snapshot as a JSON object.
+ */
+[[nodiscard]] std::string to_json(metrics_snapshot const &snapshot) noexcept;
+
+enum class metrics_format { open_metrics, json };
+
+struct metrics_exporter_options {
+    /** The file to write the metrics to.
+     * The file is replaced atomically, so that a reader never sees a partially written file.
+     */
+    URL location;
+
+    metrics_format format = metrics_format::open_metrics;
+
+    /** The time between writing the metrics.
+     */
+    std::chrono::milliseconds interval = std::chrono::seconds{10};
+};
+
+/** Start periodically writing the metrics to a file.
+ * The metrics are written once immediately, and again when the exporter is stopped.
+ *
+ * Failed writes are counted in the "metrics_export_error" counter.
+ */
+void metrics_exporter_start(metrics_exporter_options const &options);
+
+/** Stop writing the metrics.
+ */
+void metrics_exporter_stop() noexcept;
+
+} // namespace tt
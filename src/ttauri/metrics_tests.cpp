@@ -0,0 +1,110 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/metrics.hpp"
+#include "ttauri/counters.hpp"
+#include "ttauri/trace.hpp"
+#include "ttauri/file_view.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+
+using namespace std;
+using namespace tt;
+
+[[nodiscard]] static std::string read_text(URL const &location)
+{
+    ttlet view = file_view(location);
+    ttlet bytes = view.bytes();
+    return std::string(reinterpret_cast<char const *>(bytes.data()), bytes.size());
+}
+
+TEST(metrics, snapshot)
+{
+    increment_counter<"metrics_test_a">(3);
+    increment_counter<"metrics_test_b", counter_mode::sharded>(5);
+    for (auto i = 0; i != 4; ++i) {
+        auto t = trace<"metrics_test_trace">{};
+    }
+
+    ttlet snapshot = take_metrics_snapshot();
+
+    ttlet a = std::find_if(snapshot.counters.begin(), snapshot.counters.end(), [](ttlet &item) {
+        return item.name == "metrics_test_a";
+    });
+    ASSERT_NE(a, snapshot.counters.end());
+    ASSERT_EQ(a->value, 3);
+
+    ttlet b = std::find_if(snapshot.counters.begin(), snapshot.counters.end(), [](ttlet &item) {
+        return item.name == "metrics_test_b";
+    });
+    ASSERT_NE(b, snapshot.counters.end());
+    ASSERT_EQ(b->value, 5);
+
+    ttlet t = std::find_if(snapshot.traces.begin(), snapshot.traces.end(), [](ttlet &item) {
+        return item.name == "metrics_test_trace";
+    });
+    ASSERT_NE(t, snapshot.traces.end());
+    ASSERT_EQ(t->count, 4);
+
+    ASSERT_TRUE(std::is_sorted(snapshot.counters.begin(), snapshot.counters.end(), [](ttlet &lhs, ttlet &rhs) {
+        return lhs.name < rhs.name;
+    }));
+
+    // Taking a snapshot does not reset the values.
+    ttlet snapshot2 = take_metrics_snapshot();
+    ttlet a2 = std::find_if(snapshot2.counters.begin(), snapshot2.counters.end(), [](ttlet &item) {
+        return item.name == "metrics_test_a";
+    });
+    ASSERT_EQ(a2->value, 3);
+}
+
+TEST(metrics, open_metrics)
+{
+    auto snapshot = metrics_snapshot{};
+    snapshot.counters.push_back(counter_metric{"foo", 42});
+    snapshot.counters.push_back(counter_metric{"a\"b", 1});
+    snapshot.traces.push_back(trace_metric{"bar", 2, std::chrono::milliseconds{1500}});
+
+    ASSERT_EQ(
+        to_open_metrics(snapshot),
+        "# TYPE tt_counter counter\n"
+        "tt_counter_total{name=\"foo\"} 42\n"
+        "tt_counter_total{name=\"a\\\"b\"} 1\n"
+        "# TYPE tt_trace_seconds summary\n"
+        "# UNIT tt_trace_seconds seconds\n"
+        "tt_trace_seconds_count{name=\"bar\"} 2\n"
+        "tt_trace_seconds_sum{name=\"bar\"} 1.5\n"
+        "# EOF\n");
+}
+
+TEST(metrics, json)
+{
+    auto snapshot = metrics_snapshot{};
+    snapshot.counters.push_back(counter_metric{"foo", 42});
+    snapshot.traces.push_back(trace_metric{"bar", 2, std::chrono::nanoseconds{1500}});
+
+    ttlet text = to_json(snapshot);
+    ASSERT_TRUE(text.starts_with("{\"time\":\""));
+    ASSERT_TRUE(text.ends_with(",\"counters\":{\"foo\":42},\"traces\":{\"bar\":{\"count\":2,\"duration_ns\":1500}}}\n"));
+}
+
+TEST(metrics, exporter)
+{
+    ttlet location = URL("file:metrics_test.txt");
+    std::filesystem::remove(location.nativePath());
+
+    increment_counter<"metrics_test_export">();
+
+    auto options = metrics_exporter_options{};
+    options.location = location;
+    metrics_exporter_start(options);
+    metrics_exporter_stop();
+
+    ttlet text = read_text(location);
+    ASSERT_NE(text.find("tt_counter_total{name=\"metrics_test_export\"} 1\n"), std::string::npos);
+    ASSERT_TRUE(text.ends_with("# EOF\n"));
+}
@@ -5,8 +5,11 @@
 #pragma once
 
 #include "required.hpp"
-#include "unfair_recursive_mutex.hpp"
+#include "unfair_mutex.hpp"
 #include "coroutine.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <vector>
 #include <tuple>
@@ -19,8 +22,13 @@ class notifier {
 };
 
 /** A notifier which can be used to call a set of registered callbacks.
- * This class is thread-safe; however you must not use this object
- * from within the callback.
+ *
+ * The registered callbacks are kept in an immutable list which is replaced on each
+ * `subscribe()` and `unsubscribe()`. Calling the notifier only loads the current list;
+ * it does not lock or allocate, and callbacks may subscribe and unsubscribe while they
+ * are being called. Expired callbacks are removed when the list is replaced.
+ *
+ * This class is thread-safe.
  *
  * @tparam Result The result of calling the callback.
  * @tparam Args The argument types of the callback function.
@@ -43,15 +51,19 @@ public:
      */
     callback_ptr_type subscribe(callback_ptr_type const &callback_ptr) noexcept
     {
-        auto lock = std::scoped_lock(_mutex);
+        ttlet lock = std::scoped_lock(_mutex);
 
-        ttlet i = std::find_if(_callbacks.cbegin(), _callbacks.cend(), [&callback_ptr](ttlet &item) {
-            return item.lock() == callback_ptr;
-        });
+        if (ttlet callbacks = _callbacks.load(std::memory_order::relaxed)) {
+            ttlet i = std::find_if(callbacks->cbegin(), callbacks->cend(), [&callback_ptr](ttlet &item) {
+                return is_same_callback(item, callback_ptr);
+            });
 
-        if (i == _callbacks.cend()) {
-            _callbacks.emplace_back(callback_ptr);
+            if (i != callbacks->cend()) {
+                return callback_ptr;
+            }
         }
+
+        replace_callbacks_with_lock_held(nullptr, callback_ptr);
         return callback_ptr;
     }
 
@@ -63,13 +75,13 @@ public:
      * @param callback The callback-function to register.
      * @return A shared_ptr to a function object holding the callback.
      */
-    template<typename Callback> requires (std::is_invocable_v<Callback>)
+    template<typename Callback> requires (std::is_invocable_v<Callback, Args const &...>)
     [[nodiscard]] callback_ptr_type subscribe(Callback &&callback) noexcept
     {
         auto callback_ptr = std::make_shared<callback_type>(std::forward<decltype(callback)>(callback));
 
-        auto lock = std::scoped_lock(_mutex);
-        _callbacks.emplace_back(callback_ptr);
+        ttlet lock = std::scoped_lock(_mutex);
+        replace_callbacks_with_lock_held(nullptr, callback_ptr);
         return callback_ptr;
     }
 
@@ -78,37 +90,35 @@ public:
      */
     void unsubscribe(callback_ptr_type const &callback_ptr) noexcept
     {
-        auto lock = std::scoped_lock(_mutex);
-
-        ttlet new_end = std::remove_if(_callbacks.begin(), _callbacks.end(), [&callback_ptr](ttlet &item) {
-            return item.expired() || item.lock() == callback_ptr;
-        });
-        _callbacks.erase(new_end, _callbacks.cend());
+        ttlet lock = std::scoped_lock(_mutex);
+        replace_callbacks_with_lock_held(callback_ptr, nullptr);
     }
 
+    /** Get a copy of the list of callbacks.
+     */
     std::vector<std::weak_ptr<callback_type>> callbacks() const noexcept
     {
-        auto lock = std::scoped_lock(_mutex);
-
-        // Clean up all the callbacks that expired.
-        std::erase_if(_callbacks, [](auto &x){ return x.expired(); });
-
-        return _callbacks;
+        if (ttlet callbacks = _callbacks.load(std::memory_order::acquire)) {
+            return *callbacks;
+        } else {
+            return {};
+        }
     }
 
     /** Call the subscribed callbacks with the given arguments.
-     * The callbacks will be run from the main thread, asynchronously.
-     * 
+     * The callbacks will be called from the current thread.
+     *
      * @param args The arguments to pass with the invocation of the callback
      */
     void operator()(Args const &...args) const noexcept requires(std::is_same_v<result_type, void>)
     {
-        auto callbacks_ = callbacks();
-        for (auto &callback : callbacks_) {
-            if (auto callback_ = callback.lock()) {
-                (*callback_)(args...);
+        if (ttlet callbacks = _callbacks.load(std::memory_order::acquire)) {
+            for (ttlet &callback : *callbacks) {
+                if (auto callback_ = callback.lock()) {
+                    (*callback_)(args...);
+                }
             }
-        };
+        }
     }
 
     /** Call the subscribed callbacks with the given arguments.
@@ -119,17 +129,59 @@ public:
      */
     generator<result_type> operator()(Args const &...args) const noexcept requires(not std::is_same_v<result_type,void>)
     {
-        auto callbacks_ = callbacks();
-        for (auto &callback : callbacks_) {
-            if (auto callback_ = callback.lock()) {
-                co_yield (*callback_)(args...);
+        if (ttlet callbacks = _callbacks.load(std::memory_order::acquire)) {
+            for (ttlet &callback : *callbacks) {
+                if (auto callback_ = callback.lock()) {
+                    co_yield (*callback_)(args...);
+                }
             }
-        };
+        }
     }
 
 private:
-    mutable unfair_recursive_mutex _mutex;
-    mutable std::vector<std::weak_ptr<callback_type>> _callbacks;
+    using callbacks_type = std::vector<std::weak_ptr<callback_type>>;
+
+    /** Serializes the replacement of the callback list.
+     */
+    mutable unfair_mutex _mutex{unfair_mutex_statistics_of<"notifier">};
+
+    /** The immutable list of callbacks.
+     */
+    std::atomic<std::shared_ptr<callbacks_type const>> _callbacks;
+
+    /** Check if a registered callback is owned by the same shared_ptr as `callback_ptr`.
+     *
+     * The weak_ptr is compared by owner instead of being locked, so that the callback
+     * is not destroyed while `_mutex` is held when the last other owner released it.
+     */
+    [[nodiscard]] static bool is_same_callback(std::weak_ptr<callback_type> const &item, callback_ptr_type const &callback_ptr) noexcept
+    {
+        return not item.owner_before(callback_ptr) and not callback_ptr.owner_before(item);
+    }
+
+    /** Replace the callback list with a copy without the expired callbacks.
+     *
+     * @param remove A callback to leave out of the new list, or nullptr.
+     * @param add A callback to add to the new list, or nullptr.
+     */
+    void replace_callbacks_with_lock_held(callback_ptr_type const &remove, callback_ptr_type const &add) noexcept
+    {
+        auto new_callbacks = std::make_shared<callbacks_type>();
+
+        if (ttlet callbacks = _callbacks.load(std::memory_order::relaxed)) {
+            new_callbacks->reserve(callbacks->size() + 1);
+            for (ttlet &item : *callbacks) {
+                if (not item.expired() and not (remove and is_same_callback(item, remove))) {
+                    new_callbacks->push_back(item);
+                }
+            }
+        }
+
+        if (add) {
+            new_callbacks->push_back(add);
+        }
+        _callbacks.store(std::move(new_callbacks), std::memory_order::release);
+    }
 };
 
 } // namespace tt
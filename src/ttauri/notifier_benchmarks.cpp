@@ -0,0 +1,50 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/notifier.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace tt;
+
+/** Call a notifier; the argument is the number of subscribed callbacks.
+ */
+static void notifier_call(benchmark::State &state)
+{
+    auto n = notifier<void(int)>{};
+    auto count = 0;
+
+    auto callbacks = std::vector<notifier<void(int)>::callback_ptr_type>{};
+    for (auto i = 0; i != state.range(0); ++i) {
+        callbacks.push_back(n.subscribe([&count](int x) {
+            count += x;
+        }));
+    }
+
+    for (auto _ : state) {
+        n(1);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(notifier_call)->Arg(0)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+/** Subscribe and unsubscribe a callback; the argument is the number of other subscribed callbacks.
+ */
+static void notifier_subscribe_unsubscribe(benchmark::State &state)
+{
+    auto n = notifier<void()>{};
+
+    auto callbacks = std::vector<notifier<void()>::callback_ptr_type>{};
+    for (auto i = 0; i != state.range(0); ++i) {
+        callbacks.push_back(n.subscribe([] {}));
+    }
+
+    auto callback_ptr = std::make_shared<notifier<void()>::callback_type>([] {});
+    for (auto _ : state) {
+        n.subscribe(callback_ptr);
+        n.unsubscribe(callback_ptr);
+    }
+}
+BENCHMARK(notifier_subscribe_unsubscribe)->Arg(0)->Arg(16)->Arg(256);
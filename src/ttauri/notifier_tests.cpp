@@ -0,0 +1,113 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/notifier.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+using namespace std;
+using namespace tt;
+
+TEST(notifier, subscribe_call)
+{
+    auto n = notifier<void(int)>{};
+    auto a = 0;
+    auto b = 0;
+
+    auto a_ptr = n.subscribe([&a](int x) {
+        a += x;
+    });
+    auto b_ptr = n.subscribe([&b](int x) {
+        b += x;
+    });
+
+    n(1);
+    ASSERT_EQ(a, 1);
+    ASSERT_EQ(b, 1);
+
+    n.unsubscribe(a_ptr);
+    n(2);
+    ASSERT_EQ(a, 1);
+    ASSERT_EQ(b, 3);
+
+    // Subscribing the same callback twice does not call it twice.
+    n.subscribe(b_ptr);
+    n(4);
+    ASSERT_EQ(b, 7);
+}
+
+TEST(notifier, expired)
+{
+    auto n = notifier<void()>{};
+    auto a = 0;
+    auto b = 0;
+
+    auto a_ptr = n.subscribe([&a] {
+        ++a;
+    });
+    auto b_ptr = n.subscribe([&b] {
+        ++b;
+    });
+
+    a_ptr.reset();
+    n();
+    ASSERT_EQ(a, 0);
+    ASSERT_EQ(b, 1);
+
+    // Expired callbacks are removed when the list is replaced.
+    ASSERT_EQ(n.callbacks().size(), 2);
+    auto c_ptr = n.subscribe([] {});
+    ASSERT_EQ(n.callbacks().size(), 2);
+}
+
+TEST(notifier, subscribe_in_callback)
+{
+    auto n = notifier<void()>{};
+    auto a = 0;
+    auto b = 0;
+
+    auto b_ptr = notifier<void()>::callback_ptr_type{};
+    auto a_ptr = n.subscribe([&] {
+        ++a;
+        if (not b_ptr) {
+            b_ptr = n.subscribe([&b] {
+                ++b;
+            });
+        }
+    });
+
+    // The callback that is added is called from the next notification.
+    n();
+    ASSERT_EQ(a, 1);
+    ASSERT_EQ(b, 0);
+
+    n();
+    ASSERT_EQ(a, 2);
+    ASSERT_EQ(b, 1);
+}
+
+TEST(notifier, release_while_replacing)
+{
+    auto n = notifier<void()>{};
+    auto other_ptr = n.subscribe([] {});
+
+    auto releaser = std::thread([&] {
+        for (auto i = 0; i != 10000; ++i) {
+            // A callback which unsubscribes from the notifier when it is destroyed, this would
+            // dead-lock if the notifier destroyed the callback while replacing the list.
+            auto guard = std::shared_ptr<void>(nullptr, [&n, other_ptr](void *) {
+                n.unsubscribe(other_ptr);
+            });
+            auto ptr = n.subscribe([guard = std::move(guard)] {});
+            ptr.reset();
+        }
+    });
+
+    for (auto i = 0; i != 10000; ++i) {
+        n.subscribe(other_ptr);
+    }
+    releaser.join();
+}
@@ -16,6 +16,7 @@
 #include <type_traits>
 #include <vector>
 #include <atomic>
+#include <unordered_map>
 
 namespace tt {
 template<typename T>
@@ -23,6 +24,86 @@ class observable;
 
 namespace detail {
 
+/** The notifications of observables that are delayed by an `observable_batch` on this thread.
+ *
+ * Each observable is queued at most once; notifications that are caused while the queue is
+ * flushed are queued as well, so that a listener which depends on many changed observables
+ * is notified once.
+ */
+class observable_batch_queue {
+public:
+    using function_type = void (*)(void *) noexcept;
+
+    [[nodiscard]] static bool active() noexcept
+    {
+        return depth != 0;
+    }
+
+    static void begin() noexcept
+    {
+        ++depth;
+    }
+
+    static void end() noexcept
+    {
+        tt_axiom(depth != 0);
+        if (depth == 1) {
+            flush();
+        }
+        --depth;
+    }
+
+    /** Queue a notification, unless the object is already queued.
+     */
+    static void push(void *object, function_type function) noexcept
+    {
+        tt_axiom(active());
+        if (index.try_emplace(object, queue.size()).second) {
+            queue.push_back({object, function});
+        }
+    }
+
+    /** Remove the queued notification of an object that is being destroyed.
+     */
+    static void remove(void *object) noexcept
+    {
+        if (ttlet i = index.find(object); i != index.end()) {
+            queue[i->second].object = nullptr;
+            index.erase(i);
+        }
+    }
+
+private:
+    struct entry_type {
+        void *object;
+        function_type function;
+    };
+
+    thread_local inline static size_t depth = 0;
+    thread_local inline static std::vector<entry_type> queue;
+
+    /** The index in `queue` of each object which is waiting to be notified.
+     */
+    thread_local inline static std::unordered_map<void *, size_t> index;
+
+    static void flush() noexcept
+    {
+        // The queue grows while it is flushed; notifications are delivered in the order they were queued.
+        for (auto i = size_t{0}; i != queue.size(); ++i) {
+            ttlet entry = queue[i];
+            if (entry.object != nullptr) {
+                // An object that changes again after it was notified is queued again.
+                index.erase(entry.object);
+                entry.function(entry.object);
+            }
+        }
+
+        // Keep the allocations for the next batch.
+        queue.clear();
+        index.clear();
+    }
+};
+
 /** Observable abstract base class.
  * Objects of the observable_base class will notify listeners through
  * callbacks of changes of its value.
@@ -47,7 +128,12 @@ public:
 
     virtual ~observable_base()
     {
-        replace_with(_listeners, nullptr);
+        if (observable_batch_queue::active()) {
+            observable_batch_queue::remove(this);
+        }
+        if (ttlet listeners = _listeners.load()) {
+            replace_with(*listeners, nullptr);
+        }
     }
 
     observable_base(observable_base const &) = delete;
@@ -75,19 +161,18 @@ public:
      */
     virtual bool store(value_type const &new_value) noexcept = 0;
 
+    /** Notify the listeners and the owner that the value has changed.
+     * Inside an `observable_batch` the notification is delayed until the end of the batch.
+     */
     void notify() noexcept
     {
-        _mutex.lock();
-        ttlet listeners = _listeners;
-        ttlet owner = _owner;
-        _mutex.unlock();
-
-        for (ttlet &listener : listeners) {
-            tt_axiom(listener);
-            listener->notify();
+        if (observable_batch_queue::active()) {
+            observable_batch_queue::push(this, [](void *self) noexcept {
+                static_cast<observable_base *>(self)->notify_now();
+            });
+        } else {
+            notify_now();
         }
-        tt_axiom(owner);
-        owner->notify();
     }
 
     /** Replace the operands.
@@ -98,36 +183,70 @@ public:
      */
     void replace_with(observable_base *other) noexcept
     {
-        _mutex.lock();
-        ttlet listeners = _listeners;
-        _mutex.unlock();
-        return replace_with(std::move(listeners), other);
+        if (ttlet listeners = _listeners.load()) {
+            replace_with(*listeners, other);
+        } else {
+            replace_with(listeners_type{}, other);
+        }
     }
 
     void add_listener(observable_base *listener)
     {
         tt_axiom(listener);
         ttlet lock = std::scoped_lock(_mutex);
-        _listeners.push_back(listener);
+
+        ttlet listeners = _listeners.load(std::memory_order::relaxed);
+        auto new_listeners = listeners ? std::make_shared<listeners_type>(*listeners) : std::make_shared<listeners_type>();
+        new_listeners->push_back(listener);
+        _listeners.store(std::move(new_listeners));
     }
 
     void remove_listener(observable_base *listener)
     {
         tt_axiom(listener);
         ttlet lock = std::scoped_lock(_mutex);
-        std::erase(_listeners, listener);
+
+        if (ttlet listeners = _listeners.load(std::memory_order::relaxed)) {
+            auto new_listeners = std::make_shared<listeners_type>(*listeners);
+            std::erase(*new_listeners, listener);
+            _listeners.store(std::move(new_listeners));
+        }
     }
 
 protected:
-    mutable unfair_mutex _mutex;
-    observable<value_type> *_owner;
-    std::vector<observable_base *> _listeners;
+    using listeners_type = std::vector<observable_base *>;
+
+    /** Protects the value of subclasses, and serializes changes to the listeners.
+     */
+    mutable unfair_mutex _mutex{unfair_mutex_statistics_of<"observable">};
+    std::atomic<observable<value_type> *> _owner;
+
+    /** An immutable list of listeners, which is replaced when a listener is added or removed.
+     * This allows `notify()` to read the listeners without locking `_mutex` or copying the list.
+     * Loading the atomic shared_ptr is not lock-free with libstdc++ and MSVC; it is guarded by a
+     * short internal spin-lock, which is only held while the reference count is incremented.
+     */
+    std::atomic<std::shared_ptr<listeners_type const>> _listeners;
 
 private:
-    void replace_with(std::vector<observable_base *> listeners, observable_base *other) noexcept
+    void notify_now() noexcept
+    {
+        if (ttlet listeners = _listeners.load()) {
+            for (ttlet &listener : *listeners) {
+                tt_axiom(listener);
+                listener->notify();
+            }
+        }
+
+        ttlet owner = _owner.load(std::memory_order::acquire);
+        tt_axiom(owner);
+        owner->notify();
+    }
+
+    void replace_with(listeners_type const &listeners, observable_base *other) noexcept
     {
         if (other) {
-            other->_owner = std::exchange(_owner, nullptr);
+            other->_owner.store(_owner.exchange(nullptr, std::memory_order::acq_rel), std::memory_order::release);
         }
         for (auto listener : listeners) {
             listener->replace_operand(this, other);
@@ -267,6 +386,39 @@ private:
 
 } // namespace detail
 
+/** Delay the notifications of observables that are modified on this thread.
+ *
+ * While a batch is active, each observable that is modified is notified once when the
+ * outermost batch ends, instead of on every modification. Listeners that depend on many
+ * of the modified observables are also notified once.
+ *
+ * ```
+ * {
+ *     auto batch = observable_batch{};
+ *     for (auto &item : items) {
+ *         item = new_value;
+ *     }
+ * } // Subscribed callbacks are called here.
+ * ```
+ */
+class observable_batch {
+public:
+    observable_batch() noexcept
+    {
+        detail::observable_batch_queue::begin();
+    }
+
+    ~observable_batch()
+    {
+        detail::observable_batch_queue::end();
+    }
+
+    observable_batch(observable_batch const &) = delete;
+    observable_batch(observable_batch &&) = delete;
+    observable_batch &operator=(observable_batch const &) = delete;
+    observable_batch &operator=(observable_batch &&) = delete;
+};
+
 /** An observable value.
  *
  * An observable-value will notify listeners when a value changes. An
@@ -0,0 +1,75 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/observable.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <optional>
+#include <vector>
+
+using namespace tt;
+
+static constexpr int nr_observables = 10'000;
+
+/** A source observable observed by a chain of 10k observables, each with a subscribed callback.
+ * The source is modified 16 times in bulk; the argument enables the batch.
+ */
+static void observable_chain_bulk_update(benchmark::State &state)
+{
+    ttlet batched = state.range(0) != 0;
+
+    auto count = int64_t{0};
+    auto source = observable<int>{};
+    auto chain = std::vector<std::unique_ptr<observable<int>>>{};
+    auto callbacks = std::vector<observable<int>::callback_ptr_type>{};
+    for (auto i = 0; i != nr_observables; ++i) {
+        chain.push_back(std::make_unique<observable<int>>(source));
+        callbacks.push_back(chain.back()->subscribe([&count] {
+            ++count;
+        }));
+    }
+
+    auto value = 0;
+    for (auto _ : state) {
+        count = 0;
+        auto batch = batched ? std::make_optional<observable_batch>() : std::nullopt;
+        for (auto i = 0; i != 16; ++i) {
+            source = ++value;
+        }
+        batch.reset();
+        benchmark::DoNotOptimize(count);
+    }
+    state.counters["notifications"] = static_cast<double>(count);
+}
+BENCHMARK(observable_chain_bulk_update)->Arg(0)->Arg(1);
+
+/** 10k independent observables, each with a subscribed callback, all modified once in bulk.
+ * This shows the overhead of a batch when there is nothing to deduplicate; the argument enables the batch.
+ */
+static void observable_independent_bulk_update(benchmark::State &state)
+{
+    ttlet batched = state.range(0) != 0;
+
+    auto count = int64_t{0};
+    auto observables = std::vector<observable<int>>(nr_observables);
+    auto callbacks = std::vector<observable<int>::callback_ptr_type>{};
+    for (auto &item : observables) {
+        callbacks.push_back(item.subscribe([&count] {
+            ++count;
+        }));
+    }
+
+    auto value = 0;
+    for (auto _ : state) {
+        ++value;
+        auto batch = batched ? std::make_optional<observable_batch>() : std::nullopt;
+        for (auto &item : observables) {
+            item = value;
+        }
+        batch.reset();
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * nr_observables);
+}
+BENCHMARK(observable_independent_bulk_update)->Arg(0)->Arg(1);
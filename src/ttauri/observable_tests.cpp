@@ -278,4 +278,86 @@ TEST(observable, chain3)
     a_modified = false;
     b_modified = false;
     c_modified = false;
-}
\ No newline at end of file
+}
+
+TEST(observable, batch)
+{
+    int a_count = 0;
+    int b_count = 0;
+
+    observable<int> a;
+    observable<int> b = a;
+    auto a_callback = a.subscribe([&a_count]() {
+        ++a_count;
+    });
+    auto b_callback = b.subscribe([&b_count]() {
+        ++b_count;
+    });
+    a_count = 0;
+    b_count = 0;
+
+    {
+        auto batch = observable_batch{};
+        a = 1;
+        a = 2;
+        b = 3;
+        ASSERT_EQ(a_count, 0);
+        ASSERT_EQ(b_count, 0);
+        ASSERT_EQ(a, 3);
+
+        {
+            auto nested_batch = observable_batch{};
+            a = 4;
+        }
+        ASSERT_EQ(a_count, 0);
+    }
+    ASSERT_EQ(a_count, 1);
+    ASSERT_EQ(b_count, 1);
+    ASSERT_EQ(b, 4);
+
+    a = 5;
+    ASSERT_EQ(a_count, 2);
+    ASSERT_EQ(b_count, 2);
+}
+
+TEST(observable, batch_store_in_callback)
+{
+    int b_count = 0;
+
+    observable<int> a;
+    observable<int> b;
+    auto a_callback = a.subscribe([&]() {
+        b = *a * 2;
+    });
+    auto b_callback = b.subscribe([&b_count]() {
+        ++b_count;
+    });
+    b_count = 0;
+
+    {
+        auto batch = observable_batch{};
+        a = 1;
+        a = 2;
+    }
+    ASSERT_EQ(b, 4);
+    ASSERT_EQ(b_count, 1);
+}
+
+TEST(observable, batch_destroy)
+{
+    int a_count = 0;
+
+    observable<int> a;
+    auto a_callback = a.subscribe([&a_count]() {
+        ++a_count;
+    });
+    a_count = 0;
+
+    {
+        auto batch = observable_batch{};
+        auto tmp = observable<int>{};
+        tmp = 1;
+        a = 1;
+    }
+    ASSERT_EQ(a_count, 1);
+}
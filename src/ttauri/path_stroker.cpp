@@ -0,0 +1,185 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "path_stroker.hpp"
+#include "bezier.hpp"
+#include "cast.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace tt {
+
+/** The maximum ratio between the length of a miter and the stroke width.
+ * When a miter-join would be longer, a bevel-join is used instead; the same
+ * default limit as used by SVG.
+ */
+constexpr float path_stroker_miter_limit = 4.0f;
+
+void path_stroker::flatten(graphic_path const &path, float tolerance) noexcept
+{
+    tt_assert(!path.hasLayers());
+    tt_assert(!path.isContourOpen());
+    tt_axiom(tolerance > 0.0f);
+
+    _points.clear();
+    _contour_end_points.clear();
+
+    for (ssize_t contour_nr = 0; contour_nr != path.numberOfContours(); ++contour_nr) {
+        ttlet curves = path.getBeziersOfContour(contour_nr);
+        if (curves.empty()) {
+            continue;
+        }
+
+        ttlet contour_begin = std::ssize(_points);
+        _points.push_back(curves.front().P1);
+        for (ttlet &curve : curves) {
+            curve.flatten(_points, tolerance);
+        }
+
+        // Remove consecutive duplicate points, including the closing point that
+        // is the same as the first point of the contour.
+        ttlet new_end = std::unique(_points.begin() + contour_begin, _points.end());
+        _points.erase(new_end, _points.end());
+        if (std::ssize(_points) - contour_begin > 1 and _points.back() == _points[contour_begin]) {
+            _points.pop_back();
+        }
+
+        if (std::ssize(_points) - contour_begin < 2) {
+            // A contour that collapsed into a single point has no direction to stroke.
+            _points.resize(contour_begin);
+        } else {
+            _contour_end_points.push_back(std::ssize(_points) - 1);
+        }
+    }
+}
+
+void path_stroker::stroke(
+    graphic_path &r,
+    graphic_path const &path,
+    float strokeWidth,
+    LineJoinStyle lineJoinStyle,
+    float tolerance) noexcept
+{
+    tt_assert(!r.isContourOpen());
+
+    flatten(path, tolerance);
+
+    ttlet starboard_offset = strokeWidth * 0.5f;
+    ttlet port_offset = -starboard_offset;
+
+    ssize_t contour_begin = 0;
+    for (ttlet contour_end : _contour_end_points) {
+        ttlet contour = std::span{_points.data() + contour_begin, narrow_cast<size_t>(contour_end + 1 - contour_begin)};
+        contour_begin = contour_end + 1;
+
+        offset_contour(contour, starboard_offset, lineJoinStyle, tolerance);
+        for (ttlet &P : _offset_points) {
+            r.points.emplace_back(P, bezier_point::Type::Anchor);
+        }
+        r.closeContour();
+
+        offset_contour(contour, port_offset, lineJoinStyle, tolerance);
+        for (auto it = _offset_points.rbegin(); it != _offset_points.rend(); ++it) {
+            r.points.emplace_back(*it, bezier_point::Type::Anchor);
+        }
+        r.closeContour();
+    }
+}
+
+void path_stroker::offset_contour(
+    std::span<point2 const> contour,
+    float offset,
+    LineJoinStyle lineJoinStyle,
+    float tolerance) noexcept
+{
+    tt_axiom(contour.size() >= 2);
+
+    _offset_points.clear();
+
+    auto prev_P = contour.back();
+    auto n0 = normal(contour.front() - prev_P);
+    for (size_t i = 0; i != contour.size(); ++i) {
+        ttlet P = contour[i];
+        ttlet next_P = contour[i + 1 == contour.size() ? 0 : i + 1];
+        ttlet n1 = normal(next_P - P);
+
+        join(P, prev_P, next_P, n0, n1, offset, lineJoinStyle, tolerance);
+
+        prev_P = P;
+        n0 = n1;
+    }
+
+    if (_offset_points.size() > 1 and _offset_points.back() == _offset_points.front()) {
+        _offset_points.pop_back();
+    }
+}
+
+void path_stroker::join(
+    point2 P,
+    point2 prev_P,
+    point2 next_P,
+    vector2 n0,
+    vector2 n1,
+    float offset,
+    LineJoinStyle lineJoinStyle,
+    float tolerance) noexcept
+{
+    ttlet cos_angle = dot(n0, n1);
+    ttlet sin_angle = cross(n0, n1);
+
+    // The normals point to the port side of the line-segments. A positive offset on a
+    // turn to port, or a negative offset on a turn to starboard, is on the inside of the corner.
+    ttlet is_inner = sin_angle * offset >= 0.0f;
+
+    if (is_inner) {
+        // The offset line-segments overlap, cut them off at their intersection.
+        if (ttlet intersection = getIntersectionPoint(prev_P + n0 * offset, P + n0 * offset, P + n1 * offset, next_P + n1 * offset)) {
+            push_offset_point(*intersection);
+        } else {
+            push_offset_point(P + n0 * offset);
+            push_offset_point(P + n1 * offset);
+        }
+        return;
+    }
+
+    switch (lineJoinStyle) {
+    case LineJoinStyle::Miter:
+        // The miter point is on the bisector of the normals, at 1 / cos(angle / 2) times the offset.
+        if (1.0f + cos_angle >= 2.0f / (path_stroker_miter_limit * path_stroker_miter_limit)) {
+            push_offset_point(P + (n0 + n1) * (offset / (1.0f + cos_angle)));
+            return;
+        }
+        [[fallthrough]];
+
+    case LineJoinStyle::Bevel:
+        push_offset_point(P + n0 * offset);
+        push_offset_point(P + n1 * offset);
+        return;
+
+    case LineJoinStyle::Rounded: {
+        ttlet radius = std::abs(offset);
+        ttlet angle = std::atan2(sin_angle, cos_angle);
+
+        // The maximum angle of a single step on the arc to stay within tolerance.
+        ttlet max_step_angle = 2.0f * std::acos(std::max(0.0f, 1.0f - tolerance / radius));
+        ttlet nr_steps = std::clamp(static_cast<int>(std::ceil(std::abs(angle) / max_step_angle)), 1, 256);
+        ttlet step_angle = angle / static_cast<float>(nr_steps);
+        ttlet step_cos = std::cos(step_angle);
+        ttlet step_sin = std::sin(step_angle);
+
+        auto n = n0;
+        push_offset_point(P + n * offset);
+        for (int i = 1; i != nr_steps; ++i) {
+            n = vector2{n.x() * step_cos - n.y() * step_sin, n.x() * step_sin + n.y() * step_cos};
+            push_offset_point(P + n * offset);
+        }
+        push_offset_point(P + n1 * offset);
+    } return;
+
+    default:
+        tt_no_default();
+    }
+}
+
+} // namespace tt
@@ -0,0 +1,126 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "graphic_path.hpp"
+#include "bezier_curve.hpp"
+#include "geometry/point.hpp"
+#include "geometry/vector.hpp"
+#include <span>
+#include <vector>
+
+namespace tt {
+
+/** Converts the contours of a path into the outline of a stroke.
+ *
+ * The contours are first flattened into closed polylines, with each line-segment
+ * within a tolerance of the original curves. Each polyline is then offset to
+ * both sides and the offset line-segments are joined at each vertex.
+ *
+ * The stroker retains its buffers between calls, so that a stroker that is
+ * used repeatedly does not need to allocate memory for the intermediate results.
+ */
+class path_stroker {
+public:
+    path_stroker() noexcept = default;
+    path_stroker(path_stroker const &) noexcept = default;
+    path_stroker(path_stroker &&) noexcept = default;
+    path_stroker &operator=(path_stroker const &) noexcept = default;
+    path_stroker &operator=(path_stroker &&) noexcept = default;
+
+    /** Flatten the contours of a path into closed polylines.
+     * The result is available through `points()` and `contour_end_points()`.
+     *
+     * Consecutive duplicate points are removed, and the last point of a polyline
+     * is implicitly connected to its first point. Contours that collapse into a
+     * single point are removed.
+     *
+     * @param path A path without layers and without an open contour.
+     * @param tolerance The maximum distance between the polylines and the curves.
+     */
+    void flatten(graphic_path const &path, float tolerance) noexcept;
+
+    /** The points of all the polylines of the last flattened path.
+     */
+    [[nodiscard]] std::vector<point2> const &points() const noexcept
+    {
+        return _points;
+    }
+
+    /** An index into `points()` of the last point of each polyline.
+     */
+    [[nodiscard]] std::vector<ssize_t> const &contour_end_points() const noexcept
+    {
+        return _contour_end_points;
+    }
+
+    /** Stroke a path.
+     * For each contour two contours are appended to `r`: the starboard contour
+     * and the inverse of the port contour.
+     *
+     * @param r The path to append the contours of the stroke to.
+     * @param path A path without layers and without an open contour.
+     * @param strokeWidth The width of the stroke.
+     * @param lineJoinStyle The style of how outside corners of a stroke are drawn.
+     * @param tolerance The maximum distance between the stroke and the exact offset
+     *                  of the curves.
+     */
+    void stroke(
+        graphic_path &r,
+        graphic_path const &path,
+        float strokeWidth,
+        LineJoinStyle lineJoinStyle,
+        float tolerance) noexcept;
+
+private:
+    /** The points of the flattened contours.
+     */
+    std::vector<point2> _points;
+
+    /** An index into `_points` of the last point of each flattened contour.
+     */
+    std::vector<ssize_t> _contour_end_points;
+
+    /** The points of the current offset contour.
+     */
+    std::vector<point2> _offset_points;
+
+    /** Make a closed polyline at an offset from a closed polyline.
+     * The result is written into `_offset_points`.
+     *
+     * @param contour The points of a closed polyline, at least two.
+     * @param offset positive means the offset polyline will be on the starboard side.
+     * @param lineJoinStyle How the gaps between line segments are joined together.
+     * @param tolerance The maximum error of the rounded joins.
+     */
+    void offset_contour(std::span<point2 const> contour, float offset, LineJoinStyle lineJoinStyle, float tolerance) noexcept;
+
+    /** Append the join between two offset line-segments to `_offset_points`.
+     *
+     * @param P The vertex between the line-segments.
+     * @param prev_P The start of the incoming line-segment.
+     * @param next_P The end of the outgoing line-segment.
+     * @param n0 The normal of the incoming line-segment.
+     * @param n1 The normal of the outgoing line-segment.
+     */
+    void join(
+        point2 P,
+        point2 prev_P,
+        point2 next_P,
+        vector2 n0,
+        vector2 n1,
+        float offset,
+        LineJoinStyle lineJoinStyle,
+        float tolerance) noexcept;
+
+    void push_offset_point(point2 P) noexcept
+    {
+        if (_offset_points.empty() or _offset_points.back() != P) {
+            _offset_points.push_back(P);
+        }
+    }
+};
+
+} // namespace tt
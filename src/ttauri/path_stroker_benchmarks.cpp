@@ -0,0 +1,85 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/path_stroker.hpp"
+#include "ttauri/graphic_path.hpp"
+#include "ttauri/bezier_curve.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace tt;
+
+/** A glyph-like path made of quadratic curves, like a TrueType 'o'.
+ */
+[[nodiscard]] static graphic_path make_glyph_path(float size) noexcept
+{
+    auto path = graphic_path{};
+    path.moveTo(point2{size * 0.5f, size * 0.1f});
+    path.quadraticCurveTo(point2{size * 0.9f, size * 0.1f}, point2{size * 0.9f, size * 0.5f});
+    path.quadraticCurveTo(point2{size * 0.9f, size * 0.9f}, point2{size * 0.5f, size * 0.9f});
+    path.quadraticCurveTo(point2{size * 0.1f, size * 0.9f}, point2{size * 0.1f, size * 0.5f});
+    path.quadraticCurveTo(point2{size * 0.1f, size * 0.1f}, point2{size * 0.5f, size * 0.1f});
+    path.closeContour();
+
+    path.moveTo(point2{size * 0.5f, size * 0.25f});
+    path.quadraticCurveTo(point2{size * 0.25f, size * 0.25f}, point2{size * 0.25f, size * 0.5f});
+    path.quadraticCurveTo(point2{size * 0.25f, size * 0.75f}, point2{size * 0.5f, size * 0.75f});
+    path.quadraticCurveTo(point2{size * 0.75f, size * 0.75f}, point2{size * 0.75f, size * 0.5f});
+    path.quadraticCurveTo(point2{size * 0.75f, size * 0.25f}, point2{size * 0.5f, size * 0.25f});
+    path.closeContour();
+    return path;
+}
+
+[[nodiscard]] static graphic_path make_circle_path(float size) noexcept
+{
+    auto path = graphic_path{};
+    path.addCircle(point2{size * 0.5f, size * 0.5f}, size * 0.4f);
+    return path;
+}
+
+[[nodiscard]] static graphic_path make_rounded_rectangle_path(float size) noexcept
+{
+    auto path = graphic_path{};
+    path.addRectangle(aarectangle{size * 0.1f, size * 0.1f, size * 0.8f, size * 0.8f}, corner_shapes{size * 0.2f});
+    return path;
+}
+
+/** Stroke by offsetting the subdivided bezier curves of each contour.
+ */
+static void stroke_subdivide(benchmark::State &state, graphic_path (*make_path)(float))
+{
+    ttlet path = make_path(static_cast<float>(state.range(0)));
+
+    for (auto _ : state) {
+        auto r = graphic_path{};
+        for (ssize_t i = 0; i != path.numberOfContours(); ++i) {
+            ttlet contour = path.getBeziersOfContour(i);
+            r.addContour(makeParallelContour(contour, 1.0f, LineJoinStyle::Miter, 0.05f));
+            r.addContour(makeInverseContour(makeParallelContour(contour, -1.0f, LineJoinStyle::Miter, 0.05f)));
+        }
+        benchmark::DoNotOptimize(r.points.data());
+    }
+}
+
+/** Stroke by offsetting the flattened contours, reusing the buffers of the stroker.
+ */
+static void stroke_flatten(benchmark::State &state, graphic_path (*make_path)(float))
+{
+    ttlet path = make_path(static_cast<float>(state.range(0)));
+
+    auto stroker = path_stroker{};
+    auto r = graphic_path{};
+    for (auto _ : state) {
+        r.points.clear();
+        r.contourEndPoints.clear();
+        stroker.stroke(r, path, 2.0f, LineJoinStyle::Miter, 0.1f);
+        benchmark::DoNotOptimize(r.points.data());
+    }
+}
+
+BENCHMARK_CAPTURE(stroke_subdivide, glyph, make_glyph_path)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK_CAPTURE(stroke_flatten, glyph, make_glyph_path)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK_CAPTURE(stroke_subdivide, circle, make_circle_path)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK_CAPTURE(stroke_flatten, circle, make_circle_path)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK_CAPTURE(stroke_subdivide, rounded_rectangle, make_rounded_rectangle_path)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK_CAPTURE(stroke_flatten, rounded_rectangle, make_rounded_rectangle_path)->RangeMultiplier(4)->Range(16, 1024);
@@ -0,0 +1,85 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/path_stroker.hpp"
+#include "ttauri/graphic_path.hpp"
+#include <gtest/gtest.h>
+#include <numbers>
+
+using namespace std;
+using namespace tt;
+
+/** The signed area of the polygons formed by the anchors of each contour.
+ */
+[[nodiscard]] static float polygon_area(graphic_path const &path) noexcept
+{
+    auto r = 0.0f;
+    for (ssize_t contour_nr = 0; contour_nr != path.numberOfContours(); ++contour_nr) {
+        ttlet first = path.beginContour(contour_nr);
+        ttlet last = path.endContour(contour_nr);
+        for (auto it = first; it != last; ++it) {
+            ttlet next = it + 1 == last ? first : it + 1;
+            r += cross(it->p - point2{}, next->p - point2{});
+        }
+    }
+    return r * 0.5f;
+}
+
+[[nodiscard]] static graphic_path make_square(float x, float y, float size) noexcept
+{
+    auto path = graphic_path{};
+    path.moveTo(point2{x, y});
+    path.lineTo(point2{x + size, y});
+    path.lineTo(point2{x + size, y + size});
+    path.lineTo(point2{x, y + size});
+    path.closeContour();
+    return path;
+}
+
+TEST(path_stroker, flattenCircle)
+{
+    auto path = graphic_path{};
+    path.addCircle(point2{50.0f, 50.0f}, 40.0f);
+
+    auto stroker = path_stroker{};
+    stroker.flatten(path, 0.1f);
+
+    ASSERT_EQ(stroker.contour_end_points().size(), 1);
+    ASSERT_EQ(stroker.contour_end_points().back() + 1, std::ssize(stroker.points()));
+    ASSERT_GE(stroker.points().size(), 8);
+    for (ttlet &P : stroker.points()) {
+        ASSERT_NEAR(hypot(P - point2{50.0f, 50.0f}), 40.0f, 0.1f);
+    }
+}
+
+TEST(path_stroker, strokeSquare)
+{
+    ttlet path = make_square(5.0f, 5.0f, 10.0f);
+    auto stroker = path_stroker{};
+
+    auto miter = graphic_path{};
+    stroker.stroke(miter, path, 2.0f, LineJoinStyle::Miter, 0.01f);
+    ASSERT_EQ(miter.numberOfContours(), 2);
+    ASSERT_NEAR(std::abs(polygon_area(miter)), 12.0f * 12.0f - 8.0f * 8.0f, 0.001f);
+
+    auto bevel = graphic_path{};
+    stroker.stroke(bevel, path, 2.0f, LineJoinStyle::Bevel, 0.01f);
+    ASSERT_NEAR(std::abs(polygon_area(bevel)), 12.0f * 12.0f - 4.0f * 0.5f - 8.0f * 8.0f, 0.001f);
+
+    auto rounded = graphic_path{};
+    stroker.stroke(rounded, path, 2.0f, LineJoinStyle::Rounded, 0.01f);
+    ASSERT_NEAR(std::abs(polygon_area(rounded)), 10.0f * 10.0f + 4.0f * 10.0f + std::numbers::pi_v<float> - 8.0f * 8.0f, 0.05f);
+}
+
+TEST(path_stroker, strokeCircle)
+{
+    auto path = graphic_path{};
+    path.addCircle(point2{50.0f, 50.0f}, 40.0f);
+
+    ttlet stroke = path.toStroke(4.0f, LineJoinStyle::Miter, 0.01f);
+    ASSERT_EQ(stroke.numberOfContours(), 2);
+
+    ttlet expected = std::numbers::pi_v<float> * (42.0f * 42.0f - 38.0f * 38.0f);
+    ASSERT_NEAR(std::abs(polygon_area(stroke)), expected, expected * 0.01f);
+}
@@ -5,22 +5,31 @@
 #include "pixel_map.inl"
 #include "endian.hpp"
 #include <algorithm>
+#if defined(TT_X86_64_V2)
+#include <immintrin.h>
+#endif
 
 namespace tt {
 
-
-
-
-
 void mergeMaximum(pixel_map<uint8_t> &dst, pixel_map<uint8_t> const &src) noexcept
 {
     tt_assert(src.width() >= dst.width());
     tt_assert(src.height() >= dst.height());
 
-    for (auto rowNr = 0; rowNr < dst.height(); rowNr++) {
+    for (ssize_t rowNr = 0; rowNr < dst.height(); rowNr++) {
         auto dstRow = dst[rowNr];
         ttlet srcRow = src[rowNr];
-        for (auto columnNr = 0; columnNr < dstRow.width(); columnNr++) {
+        ssize_t columnNr = 0;
+
+#if defined(TT_X86_64_V2)
+        for (; columnNr + 16 <= dstRow.width(); columnNr += 16) {
+            auto dstPixels = reinterpret_cast<__m128i *>(dstRow.data() + columnNr);
+            ttlet srcPixels = reinterpret_cast<__m128i const *>(srcRow.data() + columnNr);
+            _mm_storeu_si128(dstPixels, _mm_max_epu8(_mm_loadu_si128(dstPixels), _mm_loadu_si128(srcPixels)));
+        }
+#endif
+
+        for (; columnNr < dstRow.width(); columnNr++) {
             auto &dstPixel = dstRow[columnNr];
             ttlet srcPixel = srcRow[columnNr];
             dstPixel = std::max(dstPixel, srcPixel);
@@ -9,6 +9,8 @@
 #include "geometry/extent.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <span>
 #include <string>
 #include <vector>
@@ -93,6 +95,12 @@ private:
     ssize_t _width;
 };
 
+template<typename T>
+class pixel_map;
+
+template<typename T>
+void copy(pixel_map<T> const &src, pixel_map<T> &dst) noexcept;
+
 /** A 2D canvas of pixels.
  * This class may either allocate its own memory, or gives access
  * to memory allocated by another API, such as a Vulkan texture.
@@ -160,16 +168,10 @@ public:
     {
         if (_self_allocated) {
             auto r = pixel_map(_width, _height);
-
-            for (ssize_t y = 0; y != _height; ++y) {
-                ttlet src_row = (*this)[y];
-                auto dst_row = r[y];
-                for (ssize_t x = 0; x != _width; ++x) {
-                    dst_row[x] = src_row[x];
-                }
-            }
+            tt::copy(*this, r);
 
             r._hash = _hash;
+            r._row_hashes = _row_hashes;
             return r;
         } else {
             return submap(0, 0, _width, _height);
@@ -182,6 +184,7 @@ public:
         _height(other._height),
         _stride(other._stride),
         _hash(other._hash),
+        _row_hashes(std::move(other._row_hashes)),
         _self_allocated(other._self_allocated)
     {
         tt_axiom(this != &other);
@@ -228,6 +231,7 @@ public:
         _height = other._height;
         _stride = other._stride;
         _hash = other._hash;
+        _row_hashes = std::move(other._row_hashes);
         _self_allocated = other._self_allocated;
         other._self_allocated = false;
         return *this;
@@ -291,20 +295,72 @@ public:
 
     /** Update the hash value of the pixmap.
      * Since this is an expensive operation the calculation must be called explicitly.
+     *
+     * Each row is hashed as a block of memory, excluding the padding beyond the width
+     * of a row. The hash of each row is retained so that the hash can be updated
+     * incrementally when only part of the image is modified.
      */
     void update_hash() noexcept
     {
-        size_t h = hash_mix(_width, _height);
+        _row_hashes.resize(narrow_cast<size_t>(_height));
         for (ssize_t row_nr = 0; row_nr != _height; ++row_nr) {
-            ttlet &row = (*this)[row_nr];
+            _row_hashes[row_nr] = hash_row(row_nr);
+        }
+        _hash = combine_row_hashes();
+    }
+
+    /** Update the hash value of the pixmap after modifying part of the image.
+     * Only the rows that overlap the rectangle are hashed again. When the hash
+     * was never calculated the hash over the whole image is calculated.
+     *
+     * @param first_row The first row that was modified.
+     * @param last_row One beyond the last row that was modified.
+     */
+    void update_hash(ssize_t first_row, ssize_t last_row) noexcept
+    {
+        if (std::ssize(_row_hashes) != _height) {
+            return update_hash();
+        }
+
+        tt_axiom(first_row >= 0 && first_row <= last_row && last_row <= _height);
+        for (ssize_t row_nr = first_row; row_nr != last_row; ++row_nr) {
+            _row_hashes[row_nr] = hash_row(row_nr);
+        }
+        _hash = combine_row_hashes();
+    }
+
+    /** Update the hash value of the pixmap after modifying part of the image.
+     *
+     * @param rectangle The rectangle that was modified.
+     */
+    void update_hash(aarectangle rectangle) noexcept
+    {
+        ttlet first_row = std::clamp(narrow_cast<ssize_t>(std::floor(rectangle.bottom())), ssize_t{0}, _height);
+        ttlet last_row = std::clamp(narrow_cast<ssize_t>(std::ceil(rectangle.top())), first_row, _height);
+        update_hash(first_row, last_row);
+    }
+
+private:
+    [[nodiscard]] uint64_t hash_row(ssize_t row_nr) const noexcept
+    {
+        ttlet row = (*this)[row_nr];
+        if constexpr (std::has_unique_object_representations_v<T>) {
+            return hash_bytes(row.data(), narrow_cast<size_t>(_width) * sizeof(T));
+        } else {
+            size_t h = 0;
             for (ssize_t col_nr = 0; col_nr != _width; ++col_nr) {
                 h = hash_mix(h, row[col_nr]);
             }
+            return h;
         }
-        _hash = h;
     }
 
-private:
+    [[nodiscard]] size_t combine_row_hashes() const noexcept
+    {
+        ttlet seed = hash_mix(_width, _height);
+        return static_cast<size_t>(hash_bytes(_row_hashes.data(), _row_hashes.size() * sizeof(uint64_t), seed));
+    }
+
     /** Pointer to a 2D canvas of pixels.
      */
     T *_pixels;
@@ -326,6 +382,10 @@ private:
      */
     size_t _hash;
 
+    /** Hash value of each row, used for incremental updates of the hash.
+     */
+    std::vector<uint64_t> _row_hashes;
+
     /** True if the memory was allocated by this class, false if the canvas was received from another API.
      */
     bool _self_allocated;
@@ -340,15 +400,45 @@ void copy(pixel_map<T> const &src, pixel_map<T> &dst) noexcept
     for (ssize_t y = 0; y != height; ++y) {
         ttlet src_row = src[y];
         auto dst_row = dst[y];
-        for (ssize_t x = 0; x != width; ++x) {
-            dst_row[x] = src_row[x];
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(dst_row.data(), src_row.data(), width * sizeof(T));
+        } else {
+            for (ssize_t x = 0; x != width; ++x) {
+                dst_row[x] = src_row[x];
+            }
         }
     }
 }
 
+/** Split a pixel-map in horizontal bands and call a function on each band in parallel.
+ *
+ * The number of bands is limited by the number of threads of the global thread pool and
+ * by the minimum number of pixels in each band; small images are processed by the current
+ * thread. The first band is always processed by the current thread, the other bands are
+ * executed as tasks on `thread_pool::global()`.
+ *
+ * @param pixels The pixel-map to split in bands.
+ * @param func A function `void(pixel_map<T> &band, ssize_t band_y)` called for each band,
+ *             where `band_y` is the row of `pixels` where the band starts.
+ * @param min_band_size The minimum number of pixels in each band.
+ */
+template<typename T, typename Func>
+void parallel_for_each_band(pixel_map<T> &pixels, Func const &func, ssize_t min_band_size = 0x10000) noexcept;
+
 template<int KERNEL_SIZE, typename KERNEL>
 void horizontalFilterRow(pixel_row<uint8_t> row, KERNEL kernel) noexcept;
 
+/** Filter each row of an image with a kernel over a sliding window of pixels.
+ *
+ * The image is split in bands with `parallel_for_each_band()`, so the kernel may be
+ * called from several threads at once. Within a row the filter stays scalar: the kernel is
+ * a user function of the packed window of `KERNEL_SIZE` pixels, which can not be vectorised
+ * across pixels without knowing the kernel.
+ *
+ * @param pixels The image to filter in place.
+ * @param kernel A function `uint8_t(uint64_t values)` which returns the filtered pixel
+ *               from the window, with the newest pixel in the low byte.
+ */
 template<int KERNEL_SIZE, typename T, typename KERNEL>
 void horizontalFilter(pixel_map<T> &pixels, KERNEL kernel) noexcept;
 
@@ -363,11 +453,15 @@ template<typename T>
 void fill(pixel_map<T> &dst, T color) noexcept;
 
 /*! Rotate an image 90 degrees counter-clockwise.
+ * The image is transposed in tiles, so that both the source and destination
+ * rows of a tile stay in the cache.
  */
 template<typename T>
 void rotate90(pixel_map<T> &dst, pixel_map<T> const &src) noexcept;
 
 /*! Rotate an image 270 degrees counter-clockwise.
+ * The image is transposed in tiles, so that both the source and destination
+ * rows of a tile stay in the cache.
  */
 template<typename T>
 void rotate270(pixel_map<T> &dst, pixel_map<T> const &src) noexcept;
@@ -4,9 +4,16 @@
 #pragma once
 
 #include "pixel_map.hpp"
+#include "thread_pool.hpp"
 
 namespace tt {
 
+/** The size of the square tiles used when transposing an image.
+ * A tile of 16 rows of 64 bytes fits easily in the L1 cache.
+ */
+template<typename T>
+constexpr ssize_t pixel_map_transpose_tile_size = std::max(ssize_t{8}, static_cast<ssize_t>(64 / sizeof(T)));
+
 template<int KERNEL_SIZE, typename KERNEL>
 inline void horizontalFilterRow(pixel_row<uint8_t> row, KERNEL kernel) noexcept
 {
@@ -31,7 +38,7 @@ inline void horizontalFilterRow(pixel_row<uint8_t> row, KERNEL kernel) noexcept
 
     // Execute the kernel on all the pixels upto the right edge.
     // The values are still looked up ahead.
-    ttlet lastX = row.width - LOOK_AHEAD_SIZE;
+    ttlet lastX = row.width() - LOOK_AHEAD_SIZE;
     for (; x < lastX; x++) {
         values <<= 8;
         values |= row[LOOK_AHEAD_SIZE + x];
@@ -40,8 +47,8 @@ inline void horizontalFilterRow(pixel_row<uint8_t> row, KERNEL kernel) noexcept
     }
 
     // Finish up to the right edge.
-    ttlet rightEdgeValue = row[row.width - 1];
-    for (; x < row.width; x++) {
+    ttlet rightEdgeValue = row[row.width() - 1];
+    for (; x < row.width(); x++) {
         values <<= 8;
         values |= rightEdgeValue;
 
@@ -52,10 +59,13 @@ inline void horizontalFilterRow(pixel_row<uint8_t> row, KERNEL kernel) noexcept
 template<int KERNEL_SIZE, typename T, typename KERNEL>
 inline void horizontalFilter(pixel_map<T>& pixels, KERNEL kernel) noexcept
 {
-    for (int rowNr = 0; rowNr < pixels.height; rowNr++) {
-        auto row = pixels.at(rowNr);
-        horizontalFilterRow<KERNEL_SIZE>(row, kernel);
-    }
+    // The rows are filtered independently, so each band is filtered on its own thread.
+    parallel_for_each_band(pixels, [&kernel](pixel_map<T> &band, ssize_t) {
+        for (ssize_t rowNr = 0; rowNr < band.height(); rowNr++) {
+            auto row = band.at(rowNr);
+            horizontalFilterRow<KERNEL_SIZE>(row, kernel);
+        }
+    });
 }
 
 template<typename T>
@@ -71,26 +81,33 @@ inline void fill(pixel_map<T> &dst) noexcept
 template<typename T>
 inline void fill(pixel_map<T> &dst, T color) noexcept
 {
-    for (int rowNr = 0; rowNr < dst.height; rowNr++) {
+    for (ssize_t rowNr = 0; rowNr < dst.height(); rowNr++) {
         auto row = dst.at(rowNr);
-        for (int columnNr = 0; columnNr < row.width; columnNr++) {
-            row[columnNr] = color;
-        }
+        std::fill_n(row.data(), row.width(), color);
     }
 }
 
 template<typename T>
 inline void rotate90(pixel_map<T> &dst, pixel_map<T> const &src) noexcept
 {
-    assert(dst.width() >= src.height());
-    assert(dst.height() >= src.width());
-
-    for (int rowNr = 0; rowNr < src.height(); rowNr++) {
-        ttlet row = src.at(rowNr);
-        ttlet dstColumnNr = src.height() - rowNr - 1;
-        auto dstRowNr = 0;
-        for (int columnNr = 0; columnNr < row.width(); columnNr++) {
-            dst[dstRowNr++][dstColumnNr] = row[columnNr];
+    tt_assert(dst.width() >= src.height());
+    tt_assert(dst.height() >= src.width());
+
+    constexpr auto tile_size = pixel_map_transpose_tile_size<T>;
+
+    for (ssize_t tileRowNr = 0; tileRowNr < src.height(); tileRowNr += tile_size) {
+        ttlet lastRowNr = std::min(tileRowNr + tile_size, src.height());
+
+        for (ssize_t tileColumnNr = 0; tileColumnNr < src.width(); tileColumnNr += tile_size) {
+            ttlet lastColumnNr = std::min(tileColumnNr + tile_size, src.width());
+
+            // Write a full destination row of the tile at a time.
+            for (ssize_t columnNr = tileColumnNr; columnNr != lastColumnNr; ++columnNr) {
+                auto dstRow = dst[columnNr];
+                for (ssize_t rowNr = tileRowNr; rowNr != lastRowNr; ++rowNr) {
+                    dstRow[src.height() - rowNr - 1] = src[rowNr][columnNr];
+                }
+            }
         }
     }
 }
@@ -98,19 +115,54 @@ inline void rotate90(pixel_map<T> &dst, pixel_map<T> const &src) noexcept
 template<typename T>
 inline void rotate270(pixel_map<T> &dst, pixel_map<T> const &src) noexcept
 {
-    assert(dst.width() >= src.height());
-    assert(dst.height() >= src.width());
-
-    for (int rowNr = 0; rowNr < src.height(); rowNr++) {
-        ttlet row = src.at(rowNr);
-        ttlet dstColumnNr = rowNr;
-        auto dstRowNr = row.width() - 1;
-        for (int columnNr = 0; columnNr < row.width(); columnNr++) {
-            dst[dstRowNr--][dstColumnNr] = row[columnNr];
+    tt_assert(dst.width() >= src.height());
+    tt_assert(dst.height() >= src.width());
+
+    constexpr auto tile_size = pixel_map_transpose_tile_size<T>;
+
+    for (ssize_t tileRowNr = 0; tileRowNr < src.height(); tileRowNr += tile_size) {
+        ttlet lastRowNr = std::min(tileRowNr + tile_size, src.height());
+
+        for (ssize_t tileColumnNr = 0; tileColumnNr < src.width(); tileColumnNr += tile_size) {
+            ttlet lastColumnNr = std::min(tileColumnNr + tile_size, src.width());
+
+            // Write a full destination row of the tile at a time.
+            for (ssize_t columnNr = tileColumnNr; columnNr != lastColumnNr; ++columnNr) {
+                auto dstRow = dst[src.width() - columnNr - 1];
+                for (ssize_t rowNr = tileRowNr; rowNr != lastRowNr; ++rowNr) {
+                    dstRow[rowNr] = src[rowNr][columnNr];
+                }
+            }
         }
     }
 }
 
+template<typename T, typename Func>
+inline void parallel_for_each_band(pixel_map<T> &pixels, Func const &func, ssize_t min_band_size) noexcept
+{
+    if (pixels.width() == 0 or pixels.height() == 0) {
+        return;
+    }
+
+    auto &pool = thread_pool::global();
+    ttlet nr_cpus = narrow_cast<ssize_t>(pool.size() + 1);
+    ttlet min_band_height = std::max(ssize_t{1}, min_band_size / pixels.width());
+    ttlet nr_bands = std::clamp(pixels.height() / min_band_height, ssize_t{1}, nr_cpus);
+    ttlet band_height = (pixels.height() + nr_bands - 1) / nr_bands;
+
+    auto group = task_group{pool};
+    for (auto band_y = band_height; band_y < pixels.height(); band_y += band_height) {
+        group.run([&pixels, &func, band_y, band_height] {
+            auto band = pixels.submap(0, band_y, pixels.width(), std::min(band_height, pixels.height() - band_y));
+            func(band, band_y);
+        });
+    }
+
+    auto band = pixels.submap(0, 0, pixels.width(), std::min(band_height, pixels.height()));
+    func(band, ssize_t{0});
+    group.wait();
+}
+
 template<typename T>
 inline void makeTransparentBorder(pixel_map<T> & pixel_map) noexcept
 {
@@ -0,0 +1,120 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/pixel_map.inl"
+#include "ttauri/rapid/sdf_r8.hpp"
+#include "ttauri/rapid/sfloat_rgba16.hpp"
+#include "ttauri/rapid/srgb_abgr8_pack.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace tt;
+
+template<typename T>
+static void copy_benchmark(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    auto src = pixel_map<T>(size, size);
+    auto dst = pixel_map<T>(size, size);
+
+    for (auto _ : state) {
+        copy(src, dst);
+        benchmark::DoNotOptimize(dst[0].data());
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * sizeof(T));
+}
+
+template<typename T>
+static void fill_benchmark(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    auto dst = pixel_map<T>(size, size);
+
+    for (auto _ : state) {
+        fill(dst, T{});
+        benchmark::DoNotOptimize(dst[0].data());
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * sizeof(T));
+}
+
+template<typename T>
+static void rotate90_benchmark(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    auto src = pixel_map<T>(size, size);
+    auto dst = pixel_map<T>(size, size);
+
+    for (auto _ : state) {
+        rotate90(dst, src);
+        benchmark::DoNotOptimize(dst[0].data());
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * sizeof(T));
+}
+
+static void mergeMaximum_benchmark(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    auto src = pixel_map<uint8_t>(size, size);
+    auto dst = pixel_map<uint8_t>(size, size);
+    fill(src);
+    fill(dst);
+
+    for (auto _ : state) {
+        mergeMaximum(dst, src);
+        benchmark::DoNotOptimize(dst[0].data());
+    }
+    state.SetBytesProcessed(state.iterations() * size * size);
+}
+
+static void parallel_mergeMaximum_benchmark(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    auto src = pixel_map<uint8_t>(size, size);
+    auto dst = pixel_map<uint8_t>(size, size);
+    fill(src);
+    fill(dst);
+
+    for (auto _ : state) {
+        parallel_for_each_band(dst, [&src](pixel_map<uint8_t> &band, ssize_t band_y) {
+            ttlet src_band = src.submap(0, band_y, band.width(), band.height());
+            mergeMaximum(band, src_band);
+        });
+        benchmark::DoNotOptimize(dst[0].data());
+    }
+    state.SetBytesProcessed(state.iterations() * size * size);
+}
+
+template<typename T>
+static void parallel_rotate90_benchmark(benchmark::State &state)
+{
+    ttlet size = static_cast<ssize_t>(state.range(0));
+    auto src = pixel_map<T>(size, size);
+    auto dst = pixel_map<T>(size, size);
+
+    for (auto _ : state) {
+        // Each band of rows of the source becomes a band of columns in the destination.
+        parallel_for_each_band(src, [&dst, size](pixel_map<T> &band, ssize_t band_y) {
+            auto dst_band = dst.submap(size - band_y - band.height(), 0, band.height(), size);
+            rotate90(dst_band, band);
+        });
+        benchmark::DoNotOptimize(dst[0].data());
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * sizeof(T));
+}
+
+#define TT_PIXEL_MAP_BENCHMARK(name) BENCHMARK(name)->RangeMultiplier(4)->Range(64, 4096)->UseRealTime()
+
+TT_PIXEL_MAP_BENCHMARK(copy_benchmark<uint8_t>);
+TT_PIXEL_MAP_BENCHMARK(copy_benchmark<sdf_r8>);
+TT_PIXEL_MAP_BENCHMARK(copy_benchmark<sfloat_rgba16>);
+TT_PIXEL_MAP_BENCHMARK(copy_benchmark<srgb_abgr8_pack>);
+TT_PIXEL_MAP_BENCHMARK(fill_benchmark<uint8_t>);
+TT_PIXEL_MAP_BENCHMARK(fill_benchmark<sfloat_rgba16>);
+TT_PIXEL_MAP_BENCHMARK(rotate90_benchmark<uint8_t>);
+TT_PIXEL_MAP_BENCHMARK(rotate90_benchmark<sdf_r8>);
+TT_PIXEL_MAP_BENCHMARK(rotate90_benchmark<sfloat_rgba16>);
+TT_PIXEL_MAP_BENCHMARK(rotate90_benchmark<srgb_abgr8_pack>);
+TT_PIXEL_MAP_BENCHMARK(parallel_rotate90_benchmark<uint8_t>);
+TT_PIXEL_MAP_BENCHMARK(parallel_rotate90_benchmark<sfloat_rgba16>);
+TT_PIXEL_MAP_BENCHMARK(mergeMaximum_benchmark);
+TT_PIXEL_MAP_BENCHMARK(parallel_mergeMaximum_benchmark);
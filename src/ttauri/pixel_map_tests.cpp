@@ -81,3 +81,152 @@ TEST(pixel_map_tests, renderMaskFromPath) {
 }
 
 
+
+TEST(pixel_map_tests, renderMaskFromPathAccumulate) {
+    auto mask = pixel_map<uint8_t>(9, 3);
+    fill(mask);
+
+    auto path = graphic_path();
+    path.moveTo(point2{1, 1});
+    path.lineTo(point2{2, 1});
+    path.lineTo(point2{2, 2});
+    path.lineTo(point2{1, 2});
+    path.closeContour();
+
+    auto beziers = path.getBeziers();
+    for (auto &&bezier: beziers) {
+        bezier = scale2(3.0, 1.0) * bezier;
+    }
+
+    fill(mask, beziers, fill_algorithm::accumulate);
+    for (auto y = 0; y != 3; ++y) {
+        for (auto x = 0; x != 9; ++x) {
+            ASSERT_EQ(mask[y][x], (y == 1 and x >= 3 and x < 6) ? 255 : 0);
+        }
+    }
+}
+
+TEST(pixel_map_tests, renderMaskCoverage) {
+    auto path = graphic_path();
+    path.addCircle(point2{16.3f, 16.1f}, 10.0f);
+    ttlet beziers = path.getBeziers();
+    ttlet expected_area = 3.14159265f * 10.0f * 10.0f;
+
+    for (ttlet algorithm : {fill_algorithm::super_sample, fill_algorithm::accumulate}) {
+        auto mask = pixel_map<uint8_t>(33, 33);
+        fill(mask);
+        fill(mask, beziers, algorithm);
+
+        auto area = 0.0f;
+        for (auto y = 0; y != mask.height(); ++y) {
+            for (auto x = 0; x != mask.width(); ++x) {
+                area += mask[y][x] / 255.0f;
+            }
+        }
+        ASSERT_NEAR(area, expected_area, expected_area * 0.01f);
+    }
+}
+
+TEST(pixel_map_tests, rotateTiled) {
+    // Larger than a single tile, and not a multiple of the tile size.
+    auto src = pixel_map<uint8_t>(37, 21);
+    for (auto y = 0; y != src.height(); ++y) {
+        for (auto x = 0; x != src.width(); ++x) {
+            src[y][x] = static_cast<uint8_t>(y * src.width() + x);
+        }
+    }
+
+    auto r90 = pixel_map<uint8_t>(21, 37);
+    rotate90(r90, src);
+    auto r270 = pixel_map<uint8_t>(21, 37);
+    rotate270(r270, src);
+
+    for (auto y = 0; y != src.height(); ++y) {
+        for (auto x = 0; x != src.width(); ++x) {
+            ASSERT_EQ(r90[x][src.height() - y - 1], src[y][x]);
+            ASSERT_EQ(r270[src.width() - x - 1][y], src[y][x]);
+        }
+    }
+}
+
+TEST(pixel_map_tests, parallelForEachBand) {
+    auto dst = pixel_map<uint8_t>(300, 1000);
+    auto src = pixel_map<uint8_t>(300, 1000);
+    for (auto y = 0; y != src.height(); ++y) {
+        for (auto x = 0; x != src.width(); ++x) {
+            dst[y][x] = static_cast<uint8_t>(x);
+            src[y][x] = static_cast<uint8_t>(y);
+        }
+    }
+
+    parallel_for_each_band(
+        dst,
+        [&src](pixel_map<uint8_t> &band, ssize_t band_y) {
+            ttlet src_band = src.submap(0, band_y, band.width(), band.height());
+            mergeMaximum(band, src_band);
+        },
+        1000);
+
+    for (auto y = 0; y != dst.height(); ++y) {
+        for (auto x = 0; x != dst.width(); ++x) {
+            ASSERT_EQ(dst[y][x], std::max(static_cast<uint8_t>(x), static_cast<uint8_t>(y)));
+        }
+    }
+}
+
+TEST(pixel_map_tests, horizontalFilter) {
+    auto pixels = pixel_map<uint8_t>(300, 1000);
+    auto expected = pixel_map<uint8_t>(300, 1000);
+    for (auto y = 0; y != pixels.height(); ++y) {
+        for (auto x = 0; x != pixels.width(); ++x) {
+            pixels[y][x] = expected[y][x] = static_cast<uint8_t>(x * 7 + y * 3);
+        }
+    }
+
+    // The maximum of a pixel and its two neighbours.
+    ttlet kernel = [](uint64_t values) {
+        return std::max({static_cast<uint8_t>(values), static_cast<uint8_t>(values >> 8), static_cast<uint8_t>(values >> 16)});
+    };
+
+    for (auto y = 0; y != expected.height(); ++y) {
+        horizontalFilterRow<3>(expected.at(y), kernel);
+    }
+    horizontalFilter<3>(pixels, kernel);
+
+    for (auto y = 0; y != pixels.height(); ++y) {
+        for (auto x = 0; x != pixels.width(); ++x) {
+            ASSERT_EQ(pixels[y][x], expected[y][x]);
+        }
+    }
+}
+
+TEST(pixel_map_tests, hash) {
+    auto a = pixel_map<uint8_t>(100, 50);
+    auto b = pixel_map<uint8_t>(120, 60);
+    for (auto y = 0; y != b.height(); ++y) {
+        for (auto x = 0; x != b.width(); ++x) {
+            b[y][x] = static_cast<uint8_t>(x * 3 + y);
+        }
+    }
+    for (auto y = 0; y != a.height(); ++y) {
+        for (auto x = 0; x != a.width(); ++x) {
+            a[y][x] = b[y + 5][x + 10];
+        }
+    }
+
+    // The padding beyond the width of a row of a sub-map must not change the hash.
+    auto b_sub = b.submap(10, 5, 100, 50);
+    a.update_hash();
+    b_sub.update_hash();
+    ASSERT_NE(a.hash(), 0);
+    ASSERT_EQ(a.hash(), b_sub.hash());
+
+    // An incremental update must give the same hash as a full update.
+    a[20][30] = 0xff;
+    a.update_hash(aarectangle{20.0f, 18.0f, 20.0f, 4.0f});
+    ttlet incremental_hash = a.hash();
+    ASSERT_NE(incremental_hash, b_sub.hash());
+
+    a.update_hash();
+    ASSERT_EQ(a.hash(), incremental_hash);
+}
@@ -114,23 +114,101 @@ inline void composit(pixel_map<sfloat_rgba16> &under, pixel_map<sfloat_rgba16> c
     }
 }
 
+/** Composit a color onto a row of pixels using a row of coverage values as mask.
+ *
+ * On CPUs with AVX and F16C 8 pixels are converted from half-float, blended and
+ * converted back to half-float per iteration.
+ *
+ * @param under The row of pixels to composit onto.
+ * @param over The color to composit.
+ * @param mask The row of coverage values, 255 is fully covered.
+ */
+inline void composit(pixel_row<sfloat_rgba16> under, color over, pixel_row<uint8_t> const mask) noexcept
+{
+    tt_axiom(mask.width() >= under.width());
+
+    ssize_t columnNr = 0;
+
+#if defined(TT_X86_64_V2_5)
+    static_assert(sizeof(sfloat_rgba16) == 8);
+
+    ttlet over_f32 = static_cast<f32x4>(over);
+    ttlet over_color_128 = over_f32.xyz1().reg();
+    ttlet over_color = _mm256_insertf128_ps(_mm256_castps128_ps256(over_color_128), over_color_128, 1);
+    ttlet alpha_scale = _mm_set1_ps(over_f32.a() / 255.0f);
+    ttlet one = _mm256_set1_ps(1.0f);
+    ttlet zero = _mm256_setzero_ps();
+
+    auto under_ptr = reinterpret_cast<std::byte *>(under.data());
+    auto mask_ptr = mask.data();
+
+    // Blend two pixels that are held in a single 256 bit register.
+    auto blend2 = [&](__m256 under_pixels, __m256 over_alpha) {
+        ttlet under_alpha = _mm256_permute_ps(under_pixels, _MM_SHUFFLE(3, 3, 3, 3));
+        ttlet under_color = _mm256_blend_ps(under_pixels, one, 0b1000'1000);
+
+        ttlet out = _mm256_add_ps(
+            _mm256_mul_ps(over_color, over_alpha),
+            _mm256_mul_ps(_mm256_mul_ps(under_color, under_alpha), _mm256_sub_ps(one, over_alpha)));
+        ttlet out_alpha = _mm256_permute_ps(out, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // Un-premultiply the color; the alpha itself is divided by one, like `www1()` in the scalar composit().
+        ttlet divisor = _mm256_blend_ps(out_alpha, one, 0b1000'1000);
+
+        // When the result is fully transparent, keep the original pixel.
+        return _mm256_blendv_ps(_mm256_div_ps(out, divisor), under_pixels, _mm256_cmp_ps(out_alpha, zero, _CMP_EQ_OQ));
+    };
+
+    // Broadcast the alpha of two adjacent pixels, each to their own 128 bit lane.
+    auto alpha2 = [](__m128 alpha_lo, __m128 alpha_hi) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(alpha_lo), alpha_hi, 1);
+    };
+
+    for (; columnNr + 8 <= under.width(); columnNr += 8) {
+        ttlet mask_u8 = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(mask_ptr + columnNr));
+        if (_mm_cvtsi128_si64(mask_u8) == 0) {
+            // Nothing to composit in these 8 pixels.
+            continue;
+        }
+
+        ttlet alpha_0123 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(mask_u8)), alpha_scale);
+        ttlet alpha_4567 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(mask_u8, 4))), alpha_scale);
+
+        auto ptr = under_ptr + columnNr * sizeof(sfloat_rgba16);
+        ttlet p01 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const *>(ptr)));
+        ttlet p23 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const *>(ptr + 16)));
+        ttlet p45 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const *>(ptr + 32)));
+        ttlet p67 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const *>(ptr + 48)));
+
+        ttlet r01 = blend2(p01, alpha2(_mm_shuffle_ps(alpha_0123, alpha_0123, 0x00), _mm_shuffle_ps(alpha_0123, alpha_0123, 0x55)));
+        ttlet r23 = blend2(p23, alpha2(_mm_shuffle_ps(alpha_0123, alpha_0123, 0xaa), _mm_shuffle_ps(alpha_0123, alpha_0123, 0xff)));
+        ttlet r45 = blend2(p45, alpha2(_mm_shuffle_ps(alpha_4567, alpha_4567, 0x00), _mm_shuffle_ps(alpha_4567, alpha_4567, 0x55)));
+        ttlet r67 = blend2(p67, alpha2(_mm_shuffle_ps(alpha_4567, alpha_4567, 0xaa), _mm_shuffle_ps(alpha_4567, alpha_4567, 0xff)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ptr), _mm256_cvtps_ph(r01, _MM_FROUND_TO_NEAREST_INT));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ptr + 16), _mm256_cvtps_ph(r23, _MM_FROUND_TO_NEAREST_INT));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ptr + 32), _mm256_cvtps_ph(r45, _MM_FROUND_TO_NEAREST_INT));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ptr + 48), _mm256_cvtps_ph(r67, _MM_FROUND_TO_NEAREST_INT));
+    }
+#endif
+
+    auto maskPixel = color{1.0f, 1.0f, 1.0f, 1.0f};
+    for (; columnNr != under.width(); ++columnNr) {
+        ttlet maskValue = mask[columnNr] / 255.0f;
+        maskPixel.a() = maskValue;
+
+        auto &pixel = under[columnNr];
+        pixel = composit(static_cast<color>(pixel), over * maskPixel);
+    }
+}
+
 inline void composit(pixel_map<sfloat_rgba16> &under, color over, pixel_map<uint8_t> const &mask) noexcept
 {
     tt_assert(mask.height() >= under.height());
     tt_assert(mask.width() >= under.width());
 
-    auto maskPixel = color{1.0f, 1.0f, 1.0f, 1.0f};
-
     for (ssize_t rowNr = 0; rowNr != under.height(); ++rowNr) {
-        ttlet maskRow = mask.at(rowNr);
-        auto underRow = under.at(rowNr);
-        for (ssize_t columnNr = 0; columnNr != under.width(); ++columnNr) {
-            ttlet maskValue = maskRow[columnNr] / 255.0f;
-            maskPixel.a() = maskValue;
-
-            auto &pixel = underRow[columnNr];
-            pixel = composit(static_cast<color>(pixel), over * maskPixel);
-        }
+        composit(under.at(rowNr), over, mask.at(rowNr));
     }
 }
 
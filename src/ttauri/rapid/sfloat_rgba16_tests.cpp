@@ -0,0 +1,46 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "sfloat_rgba16.hpp"
+#include "ttauri/pixel_map.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+/** Composit a color with partial coverage onto a transparent row and compare with the scalar composit().
+ * The row is wide enough to use both the 8 pixel wide path and the remainder loop.
+ */
+TEST(sfloat_rgba16, composit_row_transparent)
+{
+    constexpr auto width = 19;
+
+    ttlet over = color{1.0f, 0.0f, 0.0f, 1.0f};
+
+    auto pixels = std::vector<sfloat_rgba16>(width, sfloat_rgba16{f32x4{0.0f, 0.0f, 0.0f, 0.0f}});
+    auto coverage = std::vector<uint8_t>(width);
+    for (auto i = 0; i != width; ++i) {
+        coverage[i] = static_cast<uint8_t>(i * 17 % 256);
+    }
+    // Leave an uncovered pixel in a partly covered block of 8 pixels.
+    coverage[3] = 0;
+
+    composit(pixel_row<sfloat_rgba16>{pixels.data(), width}, over, pixel_row<uint8_t>{coverage.data(), width});
+
+    for (auto i = 0; i != width; ++i) {
+        auto over_pixel = over;
+        over_pixel.a() = coverage[i] / 255.0f;
+        ttlet expected = composit(f32x4{0.0f, 0.0f, 0.0f, 0.0f}, static_cast<f32x4>(over_pixel));
+        ttlet result = static_cast<f32x4>(pixels[i]);
+
+        for (auto j = 0_uz; j != 4; ++j) {
+            ASSERT_NEAR(result[j], expected[j], 0.005f) << "pixel " << i << " channel " << j;
+        }
+    }
+
+    // 50% red over a transparent pixel stays 50% transparent.
+    ASSERT_NEAR(static_cast<f32x4>(pixels[8]).a(), 136.0f / 255.0f, 0.005f);
+}
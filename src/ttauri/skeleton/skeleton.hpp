@@ -23,6 +23,18 @@ namespace tt {
     return parse_skeleton(std::move(url), text.cbegin(), text.cend());
 }
 
+/** Parse a skeleton in an arena.
+ * The nodes of the skeleton and the temporary tokens are allocated from the memory resource,
+ * which must outlive the returned skeleton. The strings and lists of child nodes held by
+ * the nodes are still allocated from the heap.
+ */
+[[nodiscard]] inline std::unique_ptr<skeleton_node>
+parse_skeleton(URL url, std::string_view text, std::pmr::memory_resource &resource)
+{
+    auto scope = arena_scope(resource);
+    return parse_skeleton(std::move(url), text);
+}
+
 [[nodiscard]] inline std::unique_ptr<skeleton_node> parse_skeleton(URL url)
 {
     ttlet fv = url.loadView();
@@ -7,13 +7,17 @@
 #include "../formula/formula.hpp"
 #include "../strings.hpp"
 #include "../algorithm.hpp"
+#include "../arena_memory_resource.hpp"
 #include <memory>
 #include <string_view>
 #include <optional>
 
 namespace tt {
 
-struct skeleton_node {
+/** A node of a parsed skeleton.
+ * Nodes are allocated from the memory resource of the current `arena_scope`.
+ */
+struct skeleton_node : arena_allocated {
     using statement_vector = typename std::vector<std::unique_ptr<skeleton_node>>;
 
     parse_location location;
@@ -0,0 +1,256 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include "architecture.hpp"
+#include "double_mapped_memory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+namespace tt {
+
+/** A contiguous part of a ring buffer, split in two at the end of the buffer.
+ */
+template<typename T>
+struct spsc_ring_buffer_region {
+    std::span<T> first;
+
+    /** The part that wrapped around to the start of the buffer, empty when the buffer is double mapped.
+     */
+    std::span<T> second;
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return first.size() + second.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+};
+
+/** A wait-free single-producer/single-consumer ring buffer of bytes or samples.
+ *
+ * The producer and consumer get direct access to the free and filled parts of the buffer,
+ * so that blocks of samples can be moved between an audio callback and another thread
+ * without locks, allocations or extra copies:
+ *
+ * ```
+ * auto region = buffer.write_regions(nr_samples);
+ * // fill region.first and region.second
+ * buffer.commit_write(region.size());
+ * ```
+ *
+ * Each side keeps a cached copy of the index of the other side and only reloads it when
+ * the cached copy shows too little room, which keeps the cache line of the other side from
+ * bouncing between cores.
+ *
+ * When double mapped, the memory of the buffer is mapped a second time directly after
+ * the first mapping, so that every region is a single contiguous span.
+ *
+ * Except for the constructor and destructor all functions are real-time safe.
+ *
+ * @tparam T A trivially copyable type, such as `std::byte` or `float`.
+ */
+template<typename T>
+class spsc_ring_buffer {
+public:
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    using value_type = T;
+    using write_region_type = spsc_ring_buffer_region<T>;
+    using read_region_type = spsc_ring_buffer_region<T const>;
+
+    /** Create a ring buffer.
+     *
+     * @param capacity The minimum number of items in the buffer, it is rounded up to a power of two;
+     *                 and when double mapped, to a multiple of `double_mapped_memory::granularity()`.
+     * @param double_mapped Map the memory twice so that regions don't wrap.
+     * @throw os_error When the memory could not be double mapped.
+     */
+    spsc_ring_buffer(size_t capacity, bool double_mapped = false) : _capacity(std::bit_ceil(std::max(capacity, size_t{1})))
+    {
+        if (double_mapped) {
+            tt_axiom(std::has_single_bit(sizeof(T)));
+            _capacity = std::max(_capacity, double_mapped_memory::granularity() / sizeof(T));
+            _mapped_memory.emplace(_capacity * sizeof(T));
+            _data = reinterpret_cast<T *>(_mapped_memory->data());
+        } else {
+            _heap_memory = std::make_unique<T[]>(_capacity);
+            _data = _heap_memory.get();
+        }
+    }
+
+    spsc_ring_buffer(spsc_ring_buffer const &) = delete;
+    spsc_ring_buffer(spsc_ring_buffer &&) = delete;
+    spsc_ring_buffer &operator=(spsc_ring_buffer const &) = delete;
+    spsc_ring_buffer &operator=(spsc_ring_buffer &&) = delete;
+
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    [[nodiscard]] bool double_mapped() const noexcept
+    {
+        return _mapped_memory.has_value();
+    }
+
+    /** The number of items in the buffer.
+     * This value is approximate when called while the other side is active.
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        ttlet tail = _tail.load(std::memory_order::acquire);
+        ttlet head = _head.load(std::memory_order::acquire);
+        return head - tail;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /** Get the free part of the buffer.
+     * May only be called by the producer.
+     *
+     * @param minimum The number of items the producer wants to write, used to decide
+     *                if the cached index of the consumer needs to be reloaded.
+     * @return The free part of the buffer, which may be smaller than `minimum`.
+     */
+    [[nodiscard]] write_region_type write_regions(size_t minimum = 1) noexcept
+    {
+        ttlet head = _head.load(std::memory_order::relaxed);
+        if (_capacity - (head - _cached_tail) < minimum) {
+            _cached_tail = _tail.load(std::memory_order::acquire);
+        }
+        return make_region<T>(_data, head, _capacity - (head - _cached_tail));
+    }
+
+    /** Make items written in the free part available to the consumer.
+     * May only be called by the producer.
+     *
+     * @param count The number of items written, at most the size of the last `write_regions()`.
+     */
+    void commit_write(size_t count) noexcept
+    {
+        ttlet head = _head.load(std::memory_order::relaxed);
+        tt_axiom(count <= _capacity - (head - _cached_tail));
+        _head.store(head + count, std::memory_order::release);
+    }
+
+    /** Get the filled part of the buffer.
+     * May only be called by the consumer.
+     *
+     * @param minimum The number of items the consumer wants to read, used to decide
+     *                if the cached index of the producer needs to be reloaded.
+     * @return The filled part of the buffer, which may be smaller than `minimum`.
+     */
+    [[nodiscard]] read_region_type read_regions(size_t minimum = 1) noexcept
+    {
+        ttlet tail = _tail.load(std::memory_order::relaxed);
+        if (_cached_head - tail < minimum) {
+            _cached_head = _head.load(std::memory_order::acquire);
+        }
+        return make_region<T const>(_data, tail, _cached_head - tail);
+    }
+
+    /** Release items read from the filled part back to the producer.
+     * May only be called by the consumer.
+     *
+     * @param count The number of items read, at most the size of the last `read_regions()`.
+     */
+    void commit_read(size_t count) noexcept
+    {
+        ttlet tail = _tail.load(std::memory_order::relaxed);
+        tt_axiom(count <= _cached_head - tail);
+        _tail.store(tail + count, std::memory_order::release);
+    }
+
+    /** Copy items into the buffer.
+     * May only be called by the producer.
+     *
+     * @return The number of items copied, less than the number of items when the buffer is full.
+     */
+    size_t write(std::span<T const> items) noexcept
+    {
+        ttlet region = write_regions(items.size());
+        ttlet count = std::min(items.size(), region.size());
+        ttlet first_count = std::min(count, region.first.size());
+
+        if (count == 0) {
+            return 0;
+        }
+
+        std::memcpy(region.first.data(), items.data(), first_count * sizeof(T));
+        if (count != first_count) {
+            std::memcpy(region.second.data(), items.data() + first_count, (count - first_count) * sizeof(T));
+        }
+        commit_write(count);
+        return count;
+    }
+
+    /** Copy items out of the buffer.
+     * May only be called by the consumer.
+     *
+     * @return The number of items copied, less than the number of items when the buffer is empty.
+     */
+    size_t read(std::span<T> items) noexcept
+    {
+        ttlet region = read_regions(items.size());
+        ttlet count = std::min(items.size(), region.size());
+        ttlet first_count = std::min(count, region.first.size());
+
+        if (count == 0) {
+            return 0;
+        }
+
+        std::memcpy(items.data(), region.first.data(), first_count * sizeof(T));
+        if (count != first_count) {
+            std::memcpy(items.data() + first_count, region.second.data(), (count - first_count) * sizeof(T));
+        }
+        commit_read(count);
+        return count;
+    }
+
+private:
+    T *_data = nullptr;
+    size_t _capacity;
+    std::unique_ptr<T[]> _heap_memory;
+    std::optional<double_mapped_memory> _mapped_memory;
+
+    /** The index of the next item to write, and the producer's copy of `_tail`.
+     */
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> _head = 0;
+    size_t _cached_tail = 0;
+
+    /** The index of the next item to read, and the consumer's copy of `_head`.
+     */
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> _tail = 0;
+    size_t _cached_head = 0;
+
+    template<typename U>
+    [[nodiscard]] spsc_ring_buffer_region<U> make_region(T *data, size_t index, size_t count) const noexcept
+    {
+        ttlet offset = index & (_capacity - 1);
+        if (double_mapped()) {
+            return {std::span<U>{data + offset, count}, {}};
+        }
+
+        ttlet first_count = std::min(count, _capacity - offset);
+        return {std::span<U>{data + offset, first_count}, std::span<U>{data, count - first_count}};
+    }
+};
+
+} // namespace tt
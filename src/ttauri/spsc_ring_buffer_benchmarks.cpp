@@ -0,0 +1,109 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/spsc_ring_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace tt;
+
+/** A producer thread writes blocks of samples while the consumer reads them.
+ * The first argument is the number of samples per block, the second enables double mapping.
+ */
+static void spsc_ring_buffer_throughput(benchmark::State &state)
+{
+    ttlet block_size = static_cast<size_t>(state.range(0));
+    ttlet double_mapped = state.range(1) != 0;
+    constexpr size_t nr_samples = 16 * 1024 * 1024;
+
+    auto buffer = spsc_ring_buffer<float>(64 * 1024, double_mapped);
+    auto input = std::vector<float>(block_size, 1.0f);
+    auto output = std::vector<float>(block_size);
+
+    for (auto _ : state) {
+        auto producer = std::jthread([&] {
+            auto todo = nr_samples;
+            while (todo != 0) {
+                ttlet count = buffer.write({input.data(), std::min(todo, block_size)});
+                if (count == 0) {
+                    std::this_thread::yield();
+                }
+                todo -= count;
+            }
+        });
+
+        auto todo = nr_samples;
+        while (todo != 0) {
+            ttlet count = buffer.read({output.data(), std::min(todo, block_size)});
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+            todo -= count;
+        }
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * nr_samples);
+    state.SetBytesProcessed(state.iterations() * nr_samples * sizeof(float));
+}
+
+/** Two threads bounce a block of samples back and forth through two ring buffers.
+ * Reports the latency percentiles of a single hop.
+ */
+static void spsc_ring_buffer_latency(benchmark::State &state)
+{
+    using namespace std::chrono;
+
+    ttlet block_size = static_cast<size_t>(state.range(0));
+    constexpr int nr_round_trips = 10000;
+
+    auto ping = spsc_ring_buffer<float>(4096);
+    auto pong = spsc_ring_buffer<float>(4096);
+    auto block = std::vector<float>(block_size, 1.0f);
+    auto latencies = std::vector<int64_t>{};
+    latencies.reserve(nr_round_trips);
+
+    for (auto _ : state) {
+        latencies.clear();
+
+        auto echo = std::jthread([&] {
+            auto echo_block = std::vector<float>(block_size);
+            for (auto i = 0; i != nr_round_trips; ++i) {
+                while (ping.read_regions(block_size).size() < block_size) {
+                    std::this_thread::yield();
+                }
+                ping.read(echo_block);
+                pong.write(echo_block);
+            }
+        });
+
+        for (auto i = 0; i != nr_round_trips; ++i) {
+            ttlet start = steady_clock::now();
+            ping.write(block);
+            while (pong.read_regions(block_size).size() < block_size) {
+                std::this_thread::yield();
+            }
+            pong.read(block);
+            latencies.push_back(duration_cast<nanoseconds>(steady_clock::now() - start).count() / 2);
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    ttlet percentile = [&latencies](double fraction) {
+        return static_cast<double>(latencies[static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1))]);
+    };
+
+    state.SetItemsProcessed(state.iterations() * nr_round_trips * 2);
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.counters["max_ns"] = percentile(1.0);
+}
+
+BENCHMARK(spsc_ring_buffer_throughput)->ArgsProduct({{64, 256, 1024}, {0, 1}})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(spsc_ring_buffer_latency)->Arg(1)->Arg(256)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,134 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/spsc_ring_buffer.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <array>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+TEST(spsc_ring_buffer, write_read)
+{
+    auto buffer = spsc_ring_buffer<int>(6);
+    ASSERT_EQ(buffer.capacity(), 8);
+    ASSERT_TRUE(buffer.empty());
+
+    auto input = std::array<int, 5>{1, 2, 3, 4, 5};
+    ASSERT_EQ(buffer.write(input), 5);
+    ASSERT_EQ(buffer.size(), 5);
+
+    // Only three items fit.
+    ASSERT_EQ(buffer.write(input), 3);
+    ASSERT_EQ(buffer.size(), 8);
+    ASSERT_EQ(buffer.write(input), 0);
+
+    auto output = std::array<int, 4>{};
+    ASSERT_EQ(buffer.read(output), 4);
+    ASSERT_EQ(output, (std::array<int, 4>{1, 2, 3, 4}));
+    ASSERT_EQ(buffer.read(output), 4);
+    ASSERT_EQ(output, (std::array<int, 4>{5, 1, 2, 3}));
+    ASSERT_EQ(buffer.read(output), 0);
+    ASSERT_TRUE(buffer.empty());
+}
+
+TEST(spsc_ring_buffer, regions)
+{
+    auto buffer = spsc_ring_buffer<int>(8);
+
+    auto region = buffer.write_regions();
+    ASSERT_EQ(region.first.size(), 8);
+    ASSERT_EQ(region.second.size(), 0);
+    std::iota(region.first.begin(), region.first.begin() + 6, 0);
+    buffer.commit_write(6);
+
+    auto read_region = buffer.read_regions();
+    ASSERT_EQ(read_region.size(), 6);
+    buffer.commit_read(4);
+
+    // The free part wraps around the end of the buffer.
+    region = buffer.write_regions(6);
+    ASSERT_EQ(region.first.size(), 2);
+    ASSERT_EQ(region.second.size(), 4);
+    ASSERT_EQ(region.second.data(), region.first.data() - 6);
+    region.first[0] = 6;
+    region.first[1] = 7;
+    region.second[0] = 8;
+    buffer.commit_write(3);
+
+    read_region = buffer.read_regions(5);
+    ASSERT_EQ(read_region.first.size(), 4);
+    ASSERT_EQ(read_region.second.size(), 1);
+    ASSERT_EQ(read_region.first[0], 4);
+    ASSERT_EQ(read_region.first[3], 7);
+    ASSERT_EQ(read_region.second[0], 8);
+    buffer.commit_read(read_region.size());
+    ASSERT_TRUE(buffer.empty());
+}
+
+TEST(spsc_ring_buffer, double_mapped)
+{
+    auto buffer = spsc_ring_buffer<float>(16, true);
+    ASSERT_TRUE(buffer.double_mapped());
+    ASSERT_GE(buffer.capacity(), 16);
+    ttlet capacity = buffer.capacity();
+
+    auto input = std::vector<float>(capacity - 2, 1.0f);
+    ASSERT_EQ(buffer.write(input), capacity - 2);
+    auto output = std::vector<float>(capacity - 2);
+    ASSERT_EQ(buffer.read(output), capacity - 2);
+
+    // The free part crosses the end of the buffer, but is returned as a single span.
+    auto region = buffer.write_regions(capacity);
+    ASSERT_EQ(region.first.size(), capacity);
+    ASSERT_EQ(region.second.size(), 0);
+    std::iota(region.first.begin(), region.first.begin() + 4, 10.0f);
+    buffer.commit_write(4);
+
+    ttlet read_region = buffer.read_regions();
+    ASSERT_EQ(read_region.first.size(), 4);
+    ASSERT_EQ(read_region.first[0], 10.0f);
+    ASSERT_EQ(read_region.first[3], 13.0f);
+    buffer.commit_read(4);
+}
+
+TEST(spsc_ring_buffer, producer_consumer)
+{
+    constexpr size_t nr_items = 100'000;
+
+    for (ttlet double_mapped : {false, true}) {
+        auto buffer = spsc_ring_buffer<uint32_t>(1024, double_mapped);
+
+        auto producer = std::thread([&buffer] {
+            auto next = uint32_t{0};
+            while (next != nr_items) {
+                auto region = buffer.write_regions(64);
+                auto count = std::min(region.size(), nr_items - next);
+                for (auto i = size_t{0}; i != count; ++i) {
+                    if (i < region.first.size()) {
+                        region.first[i] = next++;
+                    } else {
+                        region.second[i - region.first.size()] = next++;
+                    }
+                }
+                buffer.commit_write(count);
+            }
+        });
+
+        auto expected = uint32_t{0};
+        auto block = std::array<uint32_t, 100>{};
+        while (expected != nr_items) {
+            ttlet count = buffer.read(block);
+            for (auto i = size_t{0}; i != count; ++i) {
+                ASSERT_EQ(block[i], expected++);
+            }
+        }
+        producer.join();
+        ASSERT_TRUE(buffer.empty());
+    }
+}
@@ -6,6 +6,10 @@
 #include "logger.hpp"
 #include "counters.hpp"
 #include "trace.hpp"
+#include "unfair_mutex.hpp"
+#include <mutex>
+#include <format>
+#include <condition_variable>
 
 namespace tt {
 
@@ -24,33 +28,70 @@ static void statistics_flush_counters() noexcept
 static void statistics_flush_traces() noexcept
 {
     ttlet keys = trace_statistics_map.keys();
+    tt_log_statistics(
+        "{:>18} {:>9} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}", "total", "delta", "mean", "peak", "p50", "p90", "p99", "p99.9");
     for (ttlet &tag : keys) {
         auto *stat = trace_statistics_map.get(tag, nullptr);
         tt_assert(stat != nullptr);
         ttlet stat_result = stat->read();
 
         if (stat_result.last_count <= 0) {
-            tt_log_statistics("{:18d} {:+9d} {:10} {:10} {}", stat_result.count, stat_result.last_count, "", "", tag);
+            tt_log_statistics("{:18d} {:+9d} {:10} {:10} {:43} {}", stat_result.count, stat_result.last_count, "", "", "", tag);
 
         } else {
-            // XXX not perfect at all.
             ttlet duration_per_iter = format_engineering(stat_result.last_duration / stat_result.last_count);
             ttlet duration_peak = format_engineering(stat_result.peak_duration);
+
+            // Formatted here, so that the log message fits in a slot of the log fifo.
+            ttlet &histogram = stat_result.last_histogram;
+            ttlet percentiles = std::format(
+                "{:>10} {:>10} {:>10} {:>10}",
+                format_engineering(histogram.percentile(0.5)),
+                format_engineering(histogram.percentile(0.9)),
+                format_engineering(histogram.percentile(0.99)),
+                format_engineering(histogram.percentile(0.999)));
+
             tt_log_statistics(
-                "{:18d} {:+9d} {:>10} {:>10} {}",
+                "{:18d} {:+9d} {:>10} {:>10} {} {}",
                 stat_result.count,
                 stat_result.last_count,
                 duration_per_iter,
                 duration_peak,
+                percentiles,
                 tag);
         }
     }
 }
 
+static void statistics_flush_mutexes() noexcept
+{
+    ttlet keys = unfair_mutex_statistics_map.keys();
+    tt_log_statistics("{:>18} {:>9} {:>10} {:>10}", "contended", "delta", "mean wait", "wait");
+    for (ttlet &name : keys) {
+        auto *stat = unfair_mutex_statistics_map.get(name, nullptr);
+        tt_assert(stat != nullptr);
+        ttlet stat_result = stat->read();
+
+        if (stat_result.last_count <= 0) {
+            tt_log_statistics("{:18d} {:+9d} {:10} {:10} {}", stat_result.count, stat_result.last_count, "", "", name);
+
+        } else {
+            tt_log_statistics(
+                "{:18d} {:+9d} {:>10} {:>10} {}",
+                stat_result.count,
+                stat_result.last_count,
+                format_engineering(stat_result.last_duration / stat_result.last_count),
+                format_engineering(stat_result.last_duration),
+                name);
+        }
+    }
+}
+
 static void statistics_flush() noexcept
 {
     statistics_flush_counters();
     statistics_flush_traces();
+    statistics_flush_mutexes();
 }
 
 static void statistics_loop(std::stop_token stop_token) noexcept
@@ -59,6 +100,10 @@ static void statistics_loop(std::stop_token stop_token) noexcept
 
     auto next_time = std::chrono::ceil<std::chrono::minutes>(hires_utc_clock::now());
 
+    // Sleep until the next flush, or until the thread is stopped.
+    auto mutex = std::mutex{};
+    auto condition = std::condition_variable_any{};
+
     while (!stop_token.stop_requested()) {
         auto current_time = hires_utc_clock::now();
         if (current_time >= next_time) {
@@ -66,7 +111,10 @@ static void statistics_loop(std::stop_token stop_token) noexcept
             next_time = std::chrono::ceil<std::chrono::minutes>(current_time + 1s);
         }
 
-        std::this_thread::sleep_for(100ms);
+        auto lock = std::unique_lock(mutex);
+        condition.wait_for(lock, stop_token, next_time - current_time, [] {
+            return false;
+        });
     }
 }
 
@@ -0,0 +1,732 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace tt {
+
+template<typename T = void>
+class task;
+
+namespace detail {
+
+/** Set when the coroutine_frame_cache of the current thread has been destroyed.
+ * This variable is trivially destructible so that it can be checked during thread exit.
+ */
+inline thread_local bool coroutine_frame_cache_destroyed = false;
+
+/** A per-thread cache of coroutine frames.
+ *
+ * Frames up to 1 kByte are recycled through a free-list for each size-class,
+ * so that after a short warm up creating a task does not allocate from the heap.
+ * A frame that is freed on a different thread than where it was allocated is
+ * added to the cache of the thread that frees it.
+ */
+class coroutine_frame_cache {
+public:
+    static constexpr size_t granularity = 64;
+    static constexpr size_t nr_size_classes = 16;
+    static constexpr size_t max_nr_frames = 64;
+
+    coroutine_frame_cache() noexcept = default;
+    coroutine_frame_cache(coroutine_frame_cache const &) = delete;
+    coroutine_frame_cache(coroutine_frame_cache &&) = delete;
+    coroutine_frame_cache &operator=(coroutine_frame_cache const &) = delete;
+    coroutine_frame_cache &operator=(coroutine_frame_cache &&) = delete;
+
+    ~coroutine_frame_cache()
+    {
+        for (auto frame : _free_lists) {
+            while (frame != nullptr) {
+                auto next = frame->next;
+                ::operator delete(frame);
+                frame = next;
+            }
+        }
+        coroutine_frame_cache_destroyed = true;
+    }
+
+    [[nodiscard]] static void *allocate(size_t size)
+    {
+        ttlet size_class = (size - 1) / granularity;
+        if (size_class >= nr_size_classes or coroutine_frame_cache_destroyed) {
+            return ::operator new(size);
+        }
+
+        auto &self = local();
+        if (auto frame = self._free_lists[size_class]) {
+            self._free_lists[size_class] = frame->next;
+            --self._nr_frames[size_class];
+            return frame;
+        } else {
+            return ::operator new((size_class + 1) * granularity);
+        }
+    }
+
+    static void deallocate(void *ptr, size_t size) noexcept
+    {
+        ttlet size_class = (size - 1) / granularity;
+        if (size_class < nr_size_classes and not coroutine_frame_cache_destroyed) {
+            auto &self = local();
+            if (self._nr_frames[size_class] < max_nr_frames) {
+                self._free_lists[size_class] = new (ptr) free_frame{self._free_lists[size_class]};
+                ++self._nr_frames[size_class];
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+private:
+    struct free_frame {
+        free_frame *next;
+    };
+
+    std::array<free_frame *, nr_size_classes> _free_lists = {};
+    std::array<size_t, nr_size_classes> _nr_frames = {};
+
+    [[nodiscard]] static coroutine_frame_cache &local() noexcept
+    {
+        thread_local coroutine_frame_cache r;
+        return r;
+    }
+};
+
+/** The part of the promise of a task that is independent of the return type.
+ */
+class task_promise_base {
+public:
+    [[nodiscard]] static void *operator new(size_t size)
+    {
+        return coroutine_frame_cache::allocate(size);
+    }
+
+    static void operator delete(void *ptr, size_t size) noexcept
+    {
+        coroutine_frame_cache::deallocate(ptr, size);
+    }
+
+    /** A task does not start until it is awaited on.
+     */
+    std::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    /** On completion the coroutine that awaited the task is resumed directly.
+     */
+    struct final_awaiter {
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            if (auto continuation = handle.promise()._continuation) {
+                return continuation;
+            } else {
+                return std::noop_coroutine();
+            }
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    final_awaiter final_suspend() noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        _exception = std::current_exception();
+    }
+
+    void set_continuation(std::coroutine_handle<> continuation) noexcept
+    {
+        _continuation = continuation;
+    }
+
+protected:
+    std::coroutine_handle<> _continuation;
+    std::exception_ptr _exception;
+
+    void rethrow_exception() const
+    {
+        if (_exception) {
+            std::rethrow_exception(_exception);
+        }
+    }
+};
+
+template<typename T>
+class task_promise : public task_promise_base {
+public:
+    task<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U &&value) noexcept(std::is_nothrow_constructible_v<T, U &&>) requires(std::is_constructible_v<T, U &&>)
+    {
+        _value.emplace(std::forward<U>(value));
+    }
+
+    [[nodiscard]] T result()
+    {
+        rethrow_exception();
+        tt_axiom(_value);
+        return std::move(*_value);
+    }
+
+private:
+    std::optional<T> _value;
+};
+
+template<>
+class task_promise<void> : public task_promise_base {
+public:
+    task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result()
+    {
+        rethrow_exception();
+    }
+};
+
+} // namespace detail
+
+/** A lazily started asynchronous coroutine.
+ *
+ * A task-function is a coroutine which returns a `task<T>`. The task starts
+ * executing when it is `co_await`-ed, and when it completes the awaiting coroutine
+ * is resumed directly through symmetric transfer, so that long chains of tasks do
+ * not grow the stack. An exception thrown from the task-function is rethrown
+ * from the `co_await` expression.
+ *
+ * The coroutine frames of tasks are allocated from a per-thread cache, so that
+ * creating a task normally does not allocate from the heap.
+ *
+ * @tparam T The type of the value returned with `co_return`.
+ */
+template<typename T>
+class task {
+public:
+    using value_type = T;
+    using promise_type = detail::task_promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    task() noexcept = default;
+
+    explicit task(handle_type coroutine) noexcept : _coroutine(coroutine) {}
+
+    ~task()
+    {
+        if (_coroutine) {
+            _coroutine.destroy();
+        }
+    }
+
+    task(task const &) = delete;
+    task &operator=(task const &) = delete;
+
+    task(task &&other) noexcept : _coroutine(std::exchange(other._coroutine, {})) {}
+
+    task &operator=(task &&other) noexcept
+    {
+        tt_return_on_self_assignment(other);
+        if (_coroutine) {
+            _coroutine.destroy();
+        }
+        _coroutine = std::exchange(other._coroutine, {});
+        return *this;
+    }
+
+    /** Check if the task has completed.
+     */
+    [[nodiscard]] bool done() const noexcept
+    {
+        return not _coroutine or _coroutine.done();
+    }
+
+    /** Start the task and suspend the awaiting coroutine until the task completes.
+     */
+    [[nodiscard]] auto operator co_await() && noexcept
+    {
+        struct awaiter {
+            handle_type coroutine;
+
+            bool await_ready() noexcept
+            {
+                return not coroutine or coroutine.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                coroutine.promise().set_continuation(awaiting);
+                return coroutine;
+            }
+
+            decltype(auto) await_resume()
+            {
+                tt_axiom(coroutine);
+                return coroutine.promise().result();
+            }
+        };
+
+        return awaiter{_coroutine};
+    }
+
+private:
+    handle_type _coroutine;
+};
+
+namespace detail {
+
+template<typename T>
+inline task<T> task_promise<T>::get_return_object() noexcept
+{
+    return task<T>{std::coroutine_handle<task_promise<T>>::from_promise(*this)};
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept
+{
+    return task<void>{std::coroutine_handle<task_promise<void>>::from_promise(*this)};
+}
+
+/** The type used to store the result of a task in a tuple or variant.
+ */
+template<typename T>
+using task_result_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+/** Await a task and store its result or exception.
+ */
+template<typename T, typename Coroutine>
+Coroutine task_store_result(task<T> t, std::optional<task_result_t<T>> &result, std::exception_ptr &exception)
+{
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(t);
+            result.emplace();
+        } else {
+            result.emplace(co_await std::move(t));
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+}
+
+/** Blocks a thread until a coroutine has completed.
+ */
+struct sync_wait_state {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done = false;
+};
+
+/** The coroutine started by `sync_wait()` which awaits the task.
+ */
+class sync_wait_task {
+public:
+    struct promise_type {
+        sync_wait_state *state = nullptr;
+
+        sync_wait_task get_return_object() noexcept
+        {
+            return sync_wait_task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct awaiter {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    auto &state = *handle.promise().state;
+                    // Notify while holding the lock, so that the waiting thread can not
+                    // destroy the state before the notification is complete.
+                    ttlet lock = std::scoped_lock(state.mutex);
+                    state.done = true;
+                    state.condition.notify_all();
+                }
+
+                void await_resume() noexcept {}
+            };
+            return awaiter{};
+        }
+
+        void return_void() noexcept {}
+
+        [[noreturn]] void unhandled_exception() noexcept
+        {
+            // Exceptions are caught by `task_store_result()`.
+            std::terminate();
+        }
+    };
+
+    explicit sync_wait_task(std::coroutine_handle<promise_type> coroutine) noexcept : _coroutine(coroutine) {}
+
+    sync_wait_task(sync_wait_task const &) = delete;
+    sync_wait_task &operator=(sync_wait_task const &) = delete;
+
+    ~sync_wait_task()
+    {
+        if (_coroutine) {
+            _coroutine.destroy();
+        }
+    }
+
+    /** Start the coroutine and wait until it has completed.
+     */
+    void run() noexcept
+    {
+        auto state = sync_wait_state{};
+        _coroutine.promise().state = &state;
+        _coroutine.resume();
+
+        auto lock = std::unique_lock(state.mutex);
+        state.condition.wait(lock, [&state] {
+            return state.done;
+        });
+    }
+
+private:
+    std::coroutine_handle<promise_type> _coroutine;
+};
+
+/** Counts the tasks of `when_all()` or `when_any()` that still need to arrive.
+ *
+ * The count starts with one extra for the coroutine that starts the tasks, so that
+ * the awaiting coroutine is not resumed before all tasks have been started.
+ */
+class task_latch {
+public:
+    /** Create a latch.
+     *
+     * @param nr_tasks The number of tasks that will arrive.
+     * @param any When true only the first task to arrive is counted.
+     */
+    task_latch(size_t nr_tasks, bool any) noexcept : _count((any ? 1 : nr_tasks) + 1), _any(any) {}
+
+    /** The index of the first task that arrived.
+     */
+    [[nodiscard]] size_t first_index() const noexcept
+    {
+        return _first_index.load(std::memory_order::acquire);
+    }
+
+    /** Start the tasks.
+     * @param awaiting The coroutine to resume when the tasks have arrived.
+     */
+    void set_continuation(std::coroutine_handle<> awaiting) noexcept
+    {
+        _continuation = awaiting;
+    }
+
+    /** Arrive at the latch.
+     *
+     * @param index The index of the task that arrives.
+     * @return The awaiting coroutine when this was the last arrival, otherwise a noop-coroutine.
+     */
+    [[nodiscard]] std::coroutine_handle<> arrive(size_t index) noexcept
+    {
+        auto expected = std::numeric_limits<size_t>::max();
+        if (not _first_index.compare_exchange_strong(expected, index, std::memory_order::acq_rel) and _any) {
+            return std::noop_coroutine();
+        }
+
+        return count_down() ? _continuation : std::noop_coroutine();
+    }
+
+    /** Arrive for the coroutine that started the tasks.
+     *
+     * @return True when this was the last arrival.
+     */
+    [[nodiscard]] bool count_down() noexcept
+    {
+        return _count.fetch_sub(1, std::memory_order::acq_rel) == 1;
+    }
+
+private:
+    std::atomic<size_t> _count;
+    std::atomic<size_t> _first_index = std::numeric_limits<size_t>::max();
+    std::coroutine_handle<> _continuation;
+    bool _any;
+};
+
+/** A coroutine started by `when_all()` or `when_any()` for each task.
+ * On completion it arrives at a latch, resuming the awaiting coroutine when it is the last to arrive.
+ *
+ * @tparam Detached When true the coroutine frame is destroyed on completion, otherwise
+ *                  it is destroyed by the owner of the `task_helper`.
+ */
+template<bool Detached>
+class task_helper {
+public:
+    struct promise_type : task_promise_base {
+        /** Ownership of the state shared with the helper, for detached helpers.
+         */
+        std::shared_ptr<void> keep_alive;
+        task_latch *latch = nullptr;
+        size_t index = 0;
+
+        task_helper get_return_object() noexcept
+        {
+            return task_helper{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct awaiter {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    auto &promise = handle.promise();
+                    tt_axiom(promise.latch != nullptr);
+                    ttlet next = promise.latch->arrive(promise.index);
+                    if constexpr (Detached) {
+                        handle.destroy();
+                    }
+                    return next;
+                }
+
+                void await_resume() noexcept {}
+            };
+            return awaiter{};
+        }
+
+        void return_void() noexcept {}
+
+        [[noreturn]] void unhandled_exception() noexcept
+        {
+            // Exceptions are caught by `task_store_result()`.
+            std::terminate();
+        }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    task_helper() noexcept = default;
+    explicit task_helper(handle_type coroutine) noexcept : _coroutine(coroutine) {}
+
+    task_helper(task_helper const &) = delete;
+    task_helper &operator=(task_helper const &) = delete;
+    task_helper(task_helper &&other) noexcept : _coroutine(std::exchange(other._coroutine, {})) {}
+    task_helper &operator=(task_helper &&other) noexcept
+    {
+        tt_return_on_self_assignment(other);
+        reset();
+        _coroutine = std::exchange(other._coroutine, {});
+        return *this;
+    }
+
+    ~task_helper()
+    {
+        reset();
+    }
+
+    /** Start the helper.
+     *
+     * @param latch The latch to arrive at on completion.
+     * @param index The index of the task.
+     * @param keep_alive Ownership of shared data that must outlive a detached helper.
+     */
+    void start(task_latch &latch, size_t index, std::shared_ptr<void> keep_alive) noexcept
+    {
+        tt_axiom(_coroutine);
+        auto &promise = _coroutine.promise();
+        promise.latch = &latch;
+        promise.index = index;
+        promise.keep_alive = std::move(keep_alive);
+        if constexpr (Detached) {
+            std::exchange(_coroutine, {}).resume();
+        } else {
+            _coroutine.resume();
+        }
+    }
+
+private:
+    handle_type _coroutine;
+
+    void reset() noexcept
+    {
+        if (_coroutine) {
+            _coroutine.destroy();
+            _coroutine = {};
+        }
+    }
+};
+
+/** Start each helper and suspend until they have arrived at the latch.
+ */
+template<bool Detached, size_t N>
+struct task_latch_awaiter {
+    task_latch &latch;
+    std::array<task_helper<Detached>, N> &helpers;
+    std::shared_ptr<void> keep_alive;
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        latch.set_continuation(awaiting);
+        for (size_t i = 0; i != N; ++i) {
+            helpers[i].start(latch, i, keep_alive);
+        }
+
+        // When every helper has already arrived the awaiting coroutine continues without suspending.
+        return not latch.count_down();
+    }
+
+    void await_resume() noexcept {}
+};
+
+/** The state shared between `when_any()` and its detached helpers.
+ */
+template<typename... Ts>
+struct when_any_state {
+    task_latch latch{sizeof...(Ts), true};
+    std::tuple<std::optional<task_result_t<Ts>>...> results;
+    std::array<std::exception_ptr, sizeof...(Ts)> exceptions;
+};
+
+} // namespace detail
+
+/** Block the current thread until a task has completed.
+ *
+ * @param t The task to start and wait on.
+ * @return The value returned by the task.
+ * @throw Any exception thrown by the task.
+ */
+template<typename T>
+T sync_wait(task<T> t)
+{
+    auto result = std::optional<detail::task_result_t<T>>{};
+    auto exception = std::exception_ptr{};
+
+    detail::task_store_result<T, detail::sync_wait_task>(std::move(t), result, exception).run();
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    if constexpr (not std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
+
+/** Start several tasks and wait until all of them have completed.
+ *
+ * The tasks are started one after the other on the current thread; tasks that
+ * suspend, for example to resume on an executor, will run concurrently.
+ *
+ * @param tasks The tasks to start.
+ * @return A tuple with the results of each task; `std::monostate` for a task<void>.
+ * @throw The exception of the first task, in argument order, which threw an exception.
+ */
+template<typename... Ts>
+[[nodiscard]] task<std::tuple<detail::task_result_t<Ts>...>> when_all(task<Ts>... tasks)
+{
+    constexpr auto nr_tasks = sizeof...(Ts);
+
+    auto results = std::tuple<std::optional<detail::task_result_t<Ts>>...>{};
+    auto exceptions = std::array<std::exception_ptr, nr_tasks>{};
+    auto latch = detail::task_latch{nr_tasks, false};
+
+    auto helpers = [&]<size_t... I>(std::index_sequence<I...>) {
+        return std::array<detail::task_helper<false>, nr_tasks>{
+            detail::task_store_result<Ts, detail::task_helper<false>>(std::move(tasks), std::get<I>(results), exceptions[I])...};
+    }(std::index_sequence_for<Ts...>{});
+
+    auto awaiter = detail::task_latch_awaiter<false, nr_tasks>{latch, helpers, {}};
+    co_await awaiter;
+
+    for (ttlet &exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    auto r = [&]<size_t... I>(std::index_sequence<I...>) {
+        return std::tuple<detail::task_result_t<Ts>...>{std::move(*std::get<I>(results))...};
+    }(std::index_sequence_for<Ts...>{});
+    co_return r;
+}
+
+/** Start several tasks and wait until the first of them has completed.
+ *
+ * The other tasks are not cancelled; they keep running until they complete
+ * and their results are discarded.
+ *
+ * @param tasks The tasks to start.
+ * @return A variant with the result of the first task to complete, where the
+ *         index of the variant is the index of the task.
+ * @throw The exception of the first task to complete, if it threw an exception.
+ */
+template<typename... Ts>
+[[nodiscard]] task<std::variant<detail::task_result_t<Ts>...>> when_any(task<Ts>... tasks)
+{
+    constexpr auto nr_tasks = sizeof...(Ts);
+    using result_type = std::variant<detail::task_result_t<Ts>...>;
+
+    // The state is shared with the detached helpers, which may outlive this coroutine.
+    auto state = std::make_shared<detail::when_any_state<Ts...>>();
+
+    auto helpers = [&]<size_t... I>(std::index_sequence<I...>) {
+        return std::array<detail::task_helper<true>, nr_tasks>{detail::task_store_result<Ts, detail::task_helper<true>>(
+            std::move(tasks), std::get<I>(state->results), state->exceptions[I])...};
+    }(std::index_sequence_for<Ts...>{});
+
+    // The awaiter is a named variable; some compilers destroy a temporary
+    // aggregate in a co_await expression twice, releasing the state too early.
+    auto awaiter = detail::task_latch_awaiter<true, nr_tasks>{state->latch, helpers, state};
+    co_await awaiter;
+
+    ttlet index = state->latch.first_index();
+    if (state->exceptions[index]) {
+        std::rethrow_exception(state->exceptions[index]);
+    }
+
+    auto r = [&]<size_t... I>(std::index_sequence<I...>) {
+        auto tmp = std::optional<result_type>{};
+        ((I == index ? (tmp.emplace(std::in_place_index<I>, std::move(*std::get<I>(state->results))), 0) : 0), ...);
+        return std::move(*tmp);
+    }(std::index_sequence_for<Ts...>{});
+    co_return r;
+}
+
+} // namespace tt
@@ -0,0 +1,85 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/task.hpp"
+#include "ttauri/executor.hpp"
+#include "ttauri/thread_pool.hpp"
+#include <benchmark/benchmark.h>
+#include <functional>
+
+using namespace tt;
+
+[[nodiscard]] static task<int> identity(int value)
+{
+    co_return value;
+}
+
+[[nodiscard]] static task<int> sum_of_identities(int count)
+{
+    auto r = 0;
+    for (auto i = 0; i != count; ++i) {
+        r += co_await identity(i);
+    }
+    co_return r;
+}
+
+/** Awaiting a task that completes immediately.
+ * This measures creating a coroutine frame and switching into and out of it.
+ */
+static void task_await(benchmark::State &state)
+{
+    constexpr int count = 1000;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sync_wait(sum_of_identities(count)));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+[[nodiscard]] static task<> hop(executor &executor, int count)
+{
+    for (auto i = 0; i != count; ++i) {
+        co_await executor.schedule();
+    }
+}
+
+/** Resuming a coroutine on a worker of a thread pool.
+ * This measures the cost of a context switch through an executor.
+ */
+static void task_schedule(benchmark::State &state)
+{
+    auto pool = thread_pool{1, false};
+    auto executor = thread_pool_executor{pool};
+
+    constexpr int count = 1000;
+    for (auto _ : state) {
+        sync_wait(hop(executor, count));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+/** Baseline for `task_schedule`, submitting a function that submits the next function.
+ */
+static void thread_pool_submit(benchmark::State &state)
+{
+    auto pool = thread_pool{1, false};
+
+    constexpr int count = 1000;
+    for (auto _ : state) {
+        auto group = task_group{pool};
+        auto remaining = count;
+        auto next = std::function<void()>{};
+        next = [&] {
+            if (--remaining != 0) {
+                group.run(next);
+            }
+        };
+        group.run(next);
+        group.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(task_await);
+BENCHMARK(task_schedule)->UseRealTime();
+BENCHMARK(thread_pool_submit)->UseRealTime();
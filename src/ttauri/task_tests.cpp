@@ -0,0 +1,113 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/task.hpp"
+#include "ttauri/executor.hpp"
+#include "ttauri/thread_pool.hpp"
+#include "ttauri/timer.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+using namespace tt;
+
+[[nodiscard]] static task<int> forty_two()
+{
+    co_return 42;
+}
+
+[[nodiscard]] static task<int> add_forty_two(int value)
+{
+    co_return value + co_await forty_two();
+}
+
+[[nodiscard]] static task<> nothing()
+{
+    co_return;
+}
+
+[[nodiscard]] static task<int> thrower()
+{
+    throw std::runtime_error("thrower");
+    co_return 0;
+}
+
+[[nodiscard]] static task<int> count_down(int n)
+{
+    if (n == 0) {
+        co_return 0;
+    }
+    co_return 1 + co_await count_down(n - 1);
+}
+
+/** Resume on the executor and return the thread it resumed on.
+ */
+[[nodiscard]] static task<std::thread::id> thread_id_on(executor &executor)
+{
+    co_await executor.schedule();
+    co_return std::this_thread::get_id();
+}
+
+[[nodiscard]] static task<int> value_on(executor &executor, int value)
+{
+    co_await executor.schedule();
+    co_return value;
+}
+
+TEST(task, sync_wait)
+{
+    ASSERT_EQ(sync_wait(forty_two()), 42);
+    ASSERT_EQ(sync_wait(add_forty_two(1)), 43);
+    ASSERT_NO_THROW(sync_wait(nothing()));
+}
+
+TEST(task, exception)
+{
+    ASSERT_THROW(sync_wait(thrower()), std::runtime_error);
+}
+
+TEST(task, deep_chain)
+{
+    ASSERT_EQ(sync_wait(count_down(1000)), 1000);
+}
+
+TEST(task, thread_pool_executor)
+{
+    auto pool = thread_pool{2, false};
+    auto executor = thread_pool_executor{pool};
+
+    ASSERT_NE(sync_wait(thread_id_on(executor)), std::this_thread::get_id());
+}
+
+TEST(task, timer_executor)
+{
+    auto timer = tt::timer{"task_tests"};
+    auto executor = timer_executor{timer};
+
+    ASSERT_NE(sync_wait(thread_id_on(executor)), std::this_thread::get_id());
+}
+
+TEST(task, when_all)
+{
+    auto pool = thread_pool{2, false};
+    auto executor = thread_pool_executor{pool};
+
+    ttlet[a, b, c] = sync_wait(when_all(forty_two(), nothing(), value_on(executor, 5)));
+    ASSERT_EQ(a, 42);
+    ASSERT_EQ(b, std::monostate{});
+    ASSERT_EQ(c, 5);
+
+    ASSERT_THROW(sync_wait(when_all(forty_two(), thrower())), std::runtime_error);
+}
+
+TEST(task, when_any)
+{
+    // The first task completes without suspending, so it always wins.
+    ttlet r = sync_wait(when_any(forty_two(), add_forty_two(1)));
+    ASSERT_EQ(r.index(), 0);
+    ASSERT_EQ(std::get<0>(r), 42);
+
+    ASSERT_THROW(sync_wait(when_any(thrower(), forty_two())), std::runtime_error);
+}
@@ -7,9 +7,27 @@
 #include "exception.hpp"
 #include "GUI/gui_system.hpp"
 #include <bit>
+#include <mutex>
+#include <unordered_map>
 
 namespace tt {
 
+static std::mutex thread_names_mutex;
+static std::unordered_map<thread_id, std::string> thread_names;
+
+void detail::register_thread_name(std::string_view name) noexcept
+{
+    ttlet lock = std::scoped_lock(thread_names_mutex);
+    thread_names[current_thread_id()] = name;
+}
+
+std::string get_thread_name(thread_id id) noexcept
+{
+    ttlet lock = std::scoped_lock(thread_names_mutex);
+    ttlet it = thread_names.find(id);
+    return it != thread_names.end() ? it->second : std::string{};
+}
+
 [[nodiscard]] bool is_gui_thread() noexcept
 {
     return gui_system::global().is_gui_thread();
@@ -8,13 +8,17 @@
 #include "architecture.hpp"
 #if TT_OPERATING_SYSTEM == TT_OS_WINDOWS
 #include <intrin.h>
+#elif TT_OPERATING_SYSTEM == TT_OS_LINUX
+#include <sched.h>
 #endif
 #include <thread>
+#include <string>
 #include <string_view>
 #include <functional>
 #include <atomic>
 #include <chrono>
 #include <bit>
+#include <vector>
 
 namespace tt {
 
@@ -56,6 +60,22 @@ inline thread_local thread_id current_thread_id_dummy = 0;
 #endif
 }
 
+/** Get the name of a thread.
+ *
+ * @param id The id of the thread, as returned by `current_thread_id()` on that thread.
+ * @return The name given with `set_thread_name()`, or empty when the thread was not named.
+ */
+[[nodiscard]] std::string get_thread_name(thread_id id) noexcept;
+
+namespace detail {
+
+/** Remember the name of the current thread for `get_thread_name()`.
+ * Called by `set_thread_name()`.
+ */
+void register_thread_name(std::string_view name) noexcept;
+
+} // namespace detail
+
 /** True if the current thread is the gui thread.
  */
 [[nodiscard]] bool is_gui_thread() noexcept;
@@ -112,6 +132,80 @@ size_t advance_thread_affinity(size_t &cpu) noexcept;
  */
 [[nodiscard]] size_t current_cpu_id() noexcept;
 
+/** The scheduling policy of a real-time thread.
+ */
+enum class realtime_policy {
+    /** Run at a fixed priority until the thread blocks or a thread with a higher priority becomes runnable.
+     */
+    fifo,
+
+    /** Like fifo, but threads with the same priority take turns.
+     */
+    round_robin,
+
+    /** Earliest deadline first, with a budget of runtime in each period that is enforced by the kernel.
+     */
+    deadline
+};
+
+/** The parameters for real-time scheduling of a thread.
+ */
+struct realtime_parameters {
+    realtime_policy policy = realtime_policy::fifo;
+
+    /** The priority for the fifo and round_robin policies, from 1 (lowest) to 99 (highest).
+     */
+    int priority = 50;
+
+    /** The amount of CPU time the thread needs in each period, for the deadline policy.
+     */
+    std::chrono::nanoseconds runtime = std::chrono::nanoseconds{0};
+
+    /** The period of the thread, for the deadline policy.
+     */
+    std::chrono::nanoseconds period = std::chrono::nanoseconds{0};
+
+    /** The time within each period at which the runtime must have completed, for the deadline policy.
+     * Zero means the end of the period.
+     */
+    std::chrono::nanoseconds deadline = std::chrono::nanoseconds{0};
+
+    /** The number of bytes of stack below the current stack frame to lock in memory.
+     * The locked stack will not cause page faults. Zero disables locking.
+     */
+    size_t stack_lock_size = 256 * 1024;
+
+    /** The maximum fraction of a CPU that the thread may use before the watchdog demotes it.
+     * The watchdog measures the CPU time of the thread in intervals of 250 ms, a thread that runs away
+     * is set back to normal scheduling so that it can not starve the rest of the system.
+     * Zero disables the watchdog. Threads with the deadline policy are limited by the kernel instead.
+     *
+     * The watchdog is only available on Linux.
+     */
+    float watchdog_utilization = 0.9f;
+};
+
+/** Request real-time scheduling for the current thread.
+ *
+ * On Windows the thread priority is raised instead, the deadline policy is not supported.
+ * Real-time scheduling is not supported on macOS.
+ * Threads and processes created by a real-time thread are started with normal scheduling.
+ * The achieved configuration is logged.
+ *
+ * @param parameters The real-time scheduling parameters.
+ * @throw tt::os_error When the scheduling could not be changed, for example because the
+ *        process lacks the privilege.
+ */
+void set_thread_realtime(realtime_parameters const &parameters);
+
+/** Set the current thread back to normal scheduling.
+ */
+void clear_thread_realtime() noexcept;
+
+/** Check if the current thread uses real-time scheduling.
+ * This returns false after the watchdog has demoted the thread.
+ */
+[[nodiscard]] bool is_thread_realtime() noexcept;
 
 }
 
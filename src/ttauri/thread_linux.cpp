@@ -0,0 +1,408 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "thread.hpp"
+#include "logger.hpp"
+#include "exception.hpp"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include <alloca.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <format>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+#ifndef SCHED_FLAG_RESET_ON_FORK
+#define SCHED_FLAG_RESET_ON_FORK 0x01
+#endif
+
+namespace tt {
+
+void set_thread_name(std::string_view name)
+{
+    // The name of a thread on Linux is limited to 15 characters.
+    ttlet name_ = std::string{name.substr(0, 15)};
+    pthread_setname_np(pthread_self(), name_.c_str());
+    detail::register_thread_name(name);
+}
+
+static std::vector<bool> mask_set_to_vec(cpu_set_t const &rhs) noexcept
+{
+    auto r = std::vector<bool>{};
+
+    r.resize(CPU_SETSIZE);
+    for (size_t i = 0; i != r.size(); ++i) {
+        r[i] = static_cast<bool>(CPU_ISSET(i, &rhs));
+    }
+
+    return r;
+}
+
+static cpu_set_t mask_vec_to_set(std::vector<bool> const &rhs) noexcept
+{
+    cpu_set_t r;
+    CPU_ZERO(&r);
+    for (size_t i = 0; i != rhs.size() and i != CPU_SETSIZE; ++i) {
+        if (rhs[i]) {
+            CPU_SET(i, &r);
+        }
+    }
+    return r;
+}
+
+[[nodiscard]] std::vector<bool> process_affinity_mask() noexcept
+{
+    cpu_set_t process_mask;
+    if (sched_getaffinity(getpid(), sizeof(process_mask), &process_mask) != 0) {
+        tt_log_fatal("Could not get process affinity mask: {}", get_last_error_message());
+    }
+
+    return mask_set_to_vec(process_mask);
+}
+
+std::vector<bool> set_thread_affinity_mask(std::vector<bool> const &mask)
+{
+    ttlet mask_ = mask_vec_to_set(mask);
+
+    cpu_set_t old_mask;
+    if (sched_getaffinity(0, sizeof(old_mask), &old_mask) != 0) {
+        throw os_error("Could not get the thread affinity. '{}'", get_last_error_message());
+    }
+
+    // On Linux a pid of zero selects the calling thread, not the whole process.
+    if (sched_setaffinity(0, sizeof(mask_), &mask_) != 0) {
+        throw os_error("Could not set the thread affinity. '{}'", get_last_error_message());
+    }
+
+    return mask_set_to_vec(old_mask);
+}
+
+[[nodiscard]] size_t current_cpu_id() noexcept
+{
+    ttlet index = sched_getcpu();
+    tt_axiom(index >= 0);
+    return static_cast<size_t>(index);
+}
+
+/** The argument of the sched_setattr() system call, for which glibc has no wrapper.
+ */
+struct linux_sched_attr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+/** A real-time thread that is watched for using too much CPU time.
+ */
+struct realtime_watchdog_entry {
+    thread_id id;
+    pthread_t handle;
+    clockid_t clock;
+    float utilization;
+    std::chrono::nanoseconds cpu_time;
+    std::chrono::nanoseconds time;
+};
+
+static std::mutex realtime_watchdog_mutex;
+static std::condition_variable_any realtime_watchdog_condition;
+static std::vector<realtime_watchdog_entry> realtime_watchdog_entries;
+static std::jthread realtime_watchdog_thread;
+static std::atomic<bool> realtime_watchdog_ready = false;
+
+[[nodiscard]] static std::chrono::nanoseconds clock_time(clockid_t clock) noexcept
+{
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return std::chrono::nanoseconds{0};
+    }
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+static void realtime_watchdog_proc(std::stop_token stop_token) noexcept
+{
+    using namespace std::chrono_literals;
+
+    set_thread_name("rt_watchdog");
+
+    // The watchdog needs to be able to run while a real-time thread is running away. If it can not
+    // get the highest priority, it relies on the kernel to reserve some CPU time for normal threads.
+    ttlet param = sched_param{sched_get_priority_max(SCHED_FIFO)};
+    if (auto r = pthread_setschedparam(pthread_self(), SCHED_FIFO | SCHED_RESET_ON_FORK, &param); r != 0) {
+        tt_log_warning("The real-time watchdog runs with normal scheduling. '{}'", std::strerror(r));
+    }
+    realtime_watchdog_ready.store(true);
+    realtime_watchdog_ready.notify_all();
+
+    constexpr auto interval = 250ms;
+    auto lock = std::unique_lock(realtime_watchdog_mutex);
+    while (true) {
+        realtime_watchdog_condition.wait_for(lock, stop_token, interval, [] {
+            return false;
+        });
+        if (stop_token.stop_requested()) {
+            break;
+        }
+
+        std::erase_if(realtime_watchdog_entries, [&](auto &entry) {
+            ttlet cpu_time = clock_time(entry.clock);
+            ttlet time = clock_time(CLOCK_MONOTONIC);
+            ttlet elapsed = time - std::exchange(entry.time, time);
+            ttlet used = cpu_time - std::exchange(entry.cpu_time, cpu_time);
+            if (elapsed <= 0ns) {
+                return false;
+            }
+
+            ttlet utilization = static_cast<float>(used / 1us) / static_cast<float>(elapsed / 1us);
+
+            if (utilization <= entry.utilization) {
+                return false;
+            }
+
+            ttlet normal_param = sched_param{0};
+            if (auto r = pthread_setschedparam(entry.handle, SCHED_OTHER, &normal_param); r != 0) {
+                tt_log_error("Could not demote real-time thread '{}'. '{}'", get_thread_name(entry.id), std::strerror(r));
+                return false;
+            }
+            tt_log_error(
+                "Demoted real-time thread '{}' to normal scheduling, it used {:.0f}% of a CPU.",
+                get_thread_name(entry.id),
+                utilization * 100.0f);
+            return true;
+        });
+    }
+}
+
+static void realtime_watchdog_remove(thread_id id) noexcept
+{
+    ttlet lock = std::scoped_lock(realtime_watchdog_mutex);
+    std::erase_if(realtime_watchdog_entries, [id](auto const &entry) {
+        return entry.id == id;
+    });
+}
+
+/** Start the watchdog thread if it is not running yet.
+ *
+ * This waits until the watchdog has raised its own priority; it must be called before the
+ * current thread becomes real-time, otherwise the current thread could prevent the watchdog
+ * from starting.
+ */
+static void realtime_watchdog_start() noexcept
+{
+    {
+        ttlet lock = std::scoped_lock(realtime_watchdog_mutex);
+        if (not realtime_watchdog_thread.joinable()) {
+            realtime_watchdog_thread = std::jthread{realtime_watchdog_proc};
+        }
+    }
+    realtime_watchdog_ready.wait(false);
+}
+
+static void realtime_watchdog_add(float utilization)
+{
+    /** Removes the thread from the watchdog when the thread exits.
+     */
+    struct registration_type {
+        bool registered = false;
+
+        ~registration_type()
+        {
+            if (registered) {
+                realtime_watchdog_remove(current_thread_id());
+            }
+        }
+    };
+    thread_local registration_type registration;
+
+    clockid_t clock;
+    if (auto r = pthread_getcpuclockid(pthread_self(), &clock); r != 0) {
+        throw os_error("Could not get the CPU-time clock of the thread. '{}'", std::strerror(r));
+    }
+
+    ttlet lock = std::scoped_lock(realtime_watchdog_mutex);
+    std::erase_if(realtime_watchdog_entries, [](auto const &entry) {
+        return entry.id == current_thread_id();
+    });
+    realtime_watchdog_entries.emplace_back(
+        current_thread_id(), pthread_self(), clock, utilization, clock_time(clock), clock_time(CLOCK_MONOTONIC));
+    registration.registered = true;
+}
+
+/** Lock the stack of the current thread from `size` bytes below the current stack frame up to the top of the stack.
+ *
+ * @return The number of bytes that were locked.
+ */
+[[nodiscard]] static size_t lock_thread_stack(size_t size)
+{
+    pthread_attr_t attr;
+    if (auto r = pthread_getattr_np(pthread_self(), &attr); r != 0) {
+        throw os_error("Could not get the attributes of the thread. '{}'", std::strerror(r));
+    }
+
+    void *stack_addr;
+    size_t stack_size;
+    ttlet r = pthread_attr_getstack(&attr, &stack_addr, &stack_size);
+    pthread_attr_destroy(&attr);
+    if (r != 0) {
+        throw os_error("Could not get the stack of the thread. '{}'", std::strerror(r));
+    }
+
+    ttlet page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    ttlet stack_bottom = reinterpret_cast<uintptr_t>(stack_addr);
+    ttlet stack_top = stack_bottom + stack_size;
+
+    // The stack grows down, lock the part below the current frame which the thread is about to use.
+    // The stack of the main thread only grows when it is touched, so first reserve and touch that part.
+    // A margin is kept above the guard page for the calls made by this function and its callers.
+    constexpr uintptr_t margin_pages = 16;
+    ttlet current = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    ttlet margin = margin_pages * page_size;
+    size = std::min(size, current > stack_bottom + margin ? current - stack_bottom - margin : 0);
+    auto *reserve = static_cast<volatile char *>(alloca(size));
+    for (size_t i = 0; i < size; i += page_size) {
+        reserve[i] = 0;
+    }
+    ttlet first = reinterpret_cast<uintptr_t>(reserve) & ~(page_size - 1);
+
+    if (mlock(reinterpret_cast<void *>(first), stack_top - first) != 0) {
+        throw os_error("Could not lock the stack of the thread. '{}'", get_last_error_message());
+    }
+    return stack_top - first;
+}
+
+[[nodiscard]] static char const *sched_policy_name(int policy) noexcept
+{
+    switch (policy & ~SCHED_RESET_ON_FORK) {
+    case SCHED_OTHER: return "SCHED_OTHER";
+    case SCHED_FIFO: return "SCHED_FIFO";
+    case SCHED_RR: return "SCHED_RR";
+    case SCHED_BATCH: return "SCHED_BATCH";
+    case SCHED_IDLE: return "SCHED_IDLE";
+    case SCHED_DEADLINE: return "SCHED_DEADLINE";
+    default: return "unknown";
+    }
+}
+
+void set_thread_realtime(realtime_parameters const &parameters)
+{
+    using namespace std::chrono_literals;
+
+    if (parameters.policy == realtime_policy::deadline) {
+        tt_axiom(parameters.runtime > 0ns);
+        tt_axiom(parameters.runtime <= parameters.period);
+
+        auto attr = linux_sched_attr{};
+        attr.size = sizeof(attr);
+        attr.sched_policy = SCHED_DEADLINE;
+        attr.sched_flags = SCHED_FLAG_RESET_ON_FORK;
+        attr.sched_runtime = narrow_cast<uint64_t>(parameters.runtime / 1ns);
+        attr.sched_period = narrow_cast<uint64_t>(parameters.period / 1ns);
+        attr.sched_deadline =
+            narrow_cast<uint64_t>((parameters.deadline > 0ns ? parameters.deadline : parameters.period) / 1ns);
+
+        if (syscall(SYS_sched_setattr, 0, &attr, 0) != 0) {
+            throw os_error("Could not set SCHED_DEADLINE scheduling of the thread. '{}'", get_last_error_message());
+        }
+
+        // The kernel enforces the runtime budget of a deadline thread.
+        realtime_watchdog_remove(current_thread_id());
+
+    } else {
+        if (parameters.watchdog_utilization > 0.0f) {
+            realtime_watchdog_start();
+        }
+
+        ttlet policy = parameters.policy == realtime_policy::fifo ? SCHED_FIFO : SCHED_RR;
+        ttlet param = sched_param{
+            std::clamp(parameters.priority, sched_get_priority_min(policy), sched_get_priority_max(policy))};
+
+        if (auto r = pthread_setschedparam(pthread_self(), policy | SCHED_RESET_ON_FORK, &param); r != 0) {
+            throw os_error("Could not set {} scheduling of the thread. '{}'", sched_policy_name(policy), std::strerror(r));
+        }
+
+        if (parameters.watchdog_utilization > 0.0f) {
+            realtime_watchdog_add(parameters.watchdog_utilization);
+        } else {
+            realtime_watchdog_remove(current_thread_id());
+        }
+    }
+
+    size_t stack_locked = 0;
+    if (parameters.stack_lock_size != 0) {
+        try {
+            stack_locked = lock_thread_stack(parameters.stack_lock_size);
+        } catch (os_error const &e) {
+            tt_log_warning("{}", e.what());
+        }
+    }
+
+    // Log what the kernel actually configured.
+    auto attr = linux_sched_attr{};
+    if (syscall(SYS_sched_getattr, 0, &attr, sizeof(attr), 0) != 0) {
+        tt_log_warning("Could not get the scheduling of the thread. '{}'", get_last_error_message());
+        return;
+    }
+
+    ttlet name = get_thread_name(current_thread_id());
+    cpu_set_t thread_mask;
+    ttlet num_cpus = sched_getaffinity(0, sizeof(thread_mask), &thread_mask) == 0 ? CPU_COUNT(&thread_mask) : 0;
+    if (attr.sched_policy == SCHED_DEADLINE) {
+        tt_log_info(
+            "Thread '{}' runs with SCHED_DEADLINE runtime={}us deadline={}us period={}us on {} CPUs, {} KiB of stack locked.",
+            name,
+            attr.sched_runtime / 1000,
+            attr.sched_deadline / 1000,
+            attr.sched_period / 1000,
+            num_cpus,
+            stack_locked / 1024);
+    } else {
+        ttlet watchdog = parameters.watchdog_utilization > 0.0f ?
+            std::format("watchdog at {:.0f}% CPU", parameters.watchdog_utilization * 100.0f) :
+            std::string{"no watchdog"};
+        tt_log_info(
+            "Thread '{}' runs with {} priority={} on {} CPUs, {} KiB of stack locked, {}.",
+            name,
+            sched_policy_name(narrow_cast<int>(attr.sched_policy)),
+            attr.sched_priority,
+            num_cpus,
+            stack_locked / 1024,
+            watchdog);
+    }
+}
+
+void clear_thread_realtime() noexcept
+{
+    realtime_watchdog_remove(current_thread_id());
+
+    ttlet param = sched_param{0};
+    if (auto r = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param); r != 0) {
+        tt_log_error("Could not set normal scheduling of the thread. '{}'", std::strerror(r));
+    }
+}
+
+[[nodiscard]] bool is_thread_realtime() noexcept
+{
+    ttlet policy = sched_getscheduler(0) & ~SCHED_RESET_ON_FORK;
+    return policy == SCHED_FIFO or policy == SCHED_RR or policy == SCHED_DEADLINE;
+}
+
+} // namespace tt
@@ -4,6 +4,7 @@
 
 #include "thread.hpp"
 #include "strings.hpp"
+#include "exception.hpp"
 #include "application.hpp"
 
 #include <pthread.h>
@@ -15,6 +16,19 @@ static std::atomic<uint32_t> thread_id_count = 0;
 void set_thread_name(std::string_view name)
 {
     pthread_setname_np(name.data());
+    detail::register_thread_name(name);
+}
+
+void set_thread_realtime(realtime_parameters const &)
+{
+    throw os_error("Real-time scheduling is not supported on macOS.");
+}
+
+void clear_thread_realtime() noexcept {}
+
+[[nodiscard]] bool is_thread_realtime() noexcept
+{
+    return false;
 }
 
 }
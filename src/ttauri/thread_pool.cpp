@@ -0,0 +1,203 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "thread_pool.hpp"
+#include "thread.hpp"
+#include "counters.hpp"
+#include "exception.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+namespace tt {
+
+/** The thread pool that owns the worker running on the current thread.
+ */
+static thread_local thread_pool const *thread_pool_current_pool = nullptr;
+
+/** The index of the worker running on the current thread in `thread_pool_current_pool`.
+ */
+static thread_local size_t thread_pool_current_worker = 0;
+
+thread_pool::thread_pool(size_t nr_workers, bool pin_workers) noexcept
+{
+    auto cpus = std::vector<size_t>{};
+    if (pin_workers) {
+        ttlet mask = process_affinity_mask();
+        for (size_t cpu = 0; cpu != mask.size(); ++cpu) {
+            if (mask[cpu]) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+
+    _workers.reserve(nr_workers);
+    for (size_t i = 0; i != nr_workers; ++i) {
+        _workers.push_back(std::make_unique<worker_type>());
+    }
+
+    // Start the threads after all workers exist, since the workers steal from each other.
+    for (size_t i = 0; i != nr_workers; ++i) {
+        ttlet cpu = cpus.empty() ? std::optional<size_t>{} : std::optional<size_t>{cpus[i % cpus.size()]};
+        _workers[i]->thread = std::jthread([this, i, cpu] {
+            worker_loop(i, cpu);
+        });
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    _stop.store(true, std::memory_order::release);
+    _epoch.fetch_add(1, std::memory_order::release);
+    _epoch.notify_all();
+
+    for (auto &worker : _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+ssize_t thread_pool::current_worker_index() const noexcept
+{
+    return thread_pool_current_pool == this ? narrow_cast<ssize_t>(thread_pool_current_worker) : ssize_t{-1};
+}
+
+void thread_pool::submit(task_type task) noexcept
+{
+    ttlet worker_index = current_worker_index();
+    if (worker_index >= 0) {
+        auto &worker = *_workers[worker_index];
+        ttlet lock = std::scoped_lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    } else {
+        ttlet lock = std::scoped_lock(_shared_mutex);
+        _shared_tasks.push_back(std::move(task));
+    }
+
+    // Sequentially consistent with the worker incrementing `_nr_sleeping` before waiting on `_epoch`.
+    ++_epoch;
+    if (_nr_sleeping.load() != 0) {
+        _epoch.notify_one();
+    }
+}
+
+std::optional<thread_pool::task_type> thread_pool::find_task(ssize_t worker_index) noexcept
+{
+    // The newest task of our own queue.
+    if (worker_index >= 0) {
+        auto &worker = *_workers[worker_index];
+        ttlet lock = std::scoped_lock(worker.mutex);
+        if (not worker.tasks.empty()) {
+            auto task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return task;
+        }
+    }
+
+    // The oldest task submitted from outside the pool.
+    {
+        ttlet lock = std::scoped_lock(_shared_mutex);
+        if (not _shared_tasks.empty()) {
+            auto task = std::move(_shared_tasks.front());
+            _shared_tasks.pop_front();
+            return task;
+        }
+    }
+
+    // Steal the oldest task from another worker, starting with our neighbour.
+    ttlet nr_workers = std::ssize(_workers);
+    for (ssize_t i = 1; i <= nr_workers; ++i) {
+        ttlet victim_index = (worker_index + i) % nr_workers;
+        if (victim_index == worker_index) {
+            continue;
+        }
+
+        auto &victim = *_workers[victim_index];
+        ttlet lock = std::scoped_lock(victim.mutex);
+        if (not victim.tasks.empty()) {
+            auto task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            increment_counter<"thread_pool_steal", counter_mode::sharded>();
+            return task;
+        }
+    }
+
+    return {};
+}
+
+bool thread_pool::try_run_one() noexcept
+{
+    if (auto task = find_task(current_worker_index())) {
+        (*task)();
+        increment_counter<"thread_pool_task", counter_mode::sharded>();
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void thread_pool::worker_loop(size_t worker_index, std::optional<size_t> cpu) noexcept
+{
+    using namespace std::chrono;
+
+    set_thread_name(std::format("pool_worker_{}", worker_index));
+    if (cpu) {
+        try {
+            set_thread_affinity(*cpu);
+        } catch (os_error const &e) {
+            tt_log_warning("Could not pin thread pool worker {} to cpu {}: {}", worker_index, *cpu, e.what());
+        }
+    }
+
+    thread_pool_current_pool = this;
+    thread_pool_current_worker = worker_index;
+
+    auto time_stamp = steady_clock::now();
+    while (not _stop.load(std::memory_order::acquire)) {
+        // Read the epoch before searching for tasks, so that a task submitted
+        // after the search wakes up this worker.
+        ttlet epoch = _epoch.load(std::memory_order::acquire);
+
+        if (auto task = find_task(narrow_cast<ssize_t>(worker_index))) {
+            (*task)();
+            increment_counter<"thread_pool_task", counter_mode::sharded>();
+            continue;
+        }
+
+        // Account the time between becoming busy and becoming idle.
+        auto now = steady_clock::now();
+        increment_counter<"thread_pool_busy_ns", counter_mode::sharded>(duration_cast<nanoseconds>(now - time_stamp).count());
+        time_stamp = now;
+
+        ++_nr_sleeping;
+        _epoch.wait(epoch);
+        --_nr_sleeping;
+
+        now = steady_clock::now();
+        increment_counter<"thread_pool_idle_ns", counter_mode::sharded>(duration_cast<nanoseconds>(now - time_stamp).count());
+        time_stamp = now;
+    }
+
+    thread_pool_current_pool = nullptr;
+}
+
+[[nodiscard]] thread_pool *thread_pool::subsystem_init() noexcept
+{
+    ttlet mask = process_affinity_mask();
+    ttlet nr_cpus = narrow_cast<size_t>(std::count(mask.begin(), mask.end(), true));
+    ttlet nr_workers = nr_cpus > 1 ? nr_cpus - 1 : size_t{1};
+
+    return new thread_pool(nr_workers, true);
+}
+
+void thread_pool::subsystem_deinit() noexcept
+{
+    if (auto tmp = _global.exchange(nullptr)) {
+        delete tmp;
+    }
+}
+
+} // namespace tt
@@ -0,0 +1,265 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include "cast.hpp"
+#include "unfair_mutex.hpp"
+#include "subsystem.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <concepts>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace tt {
+
+/** A pool of worker threads that execute tasks.
+ *
+ * Each worker owns a double ended queue of tasks. A worker pushes and pops
+ * tasks it creates itself at the back of its own queue, so that recently
+ * created tasks, which likely share data in the cache, are executed first.
+ * An idle worker steals tasks from the front of the queues of the other workers.
+ * Tasks submitted from a thread outside of the pool are added to a shared queue.
+ *
+ * The pool reports its utilisation through the following sharded counters:
+ *  - `thread_pool_task`: The number of executed tasks.
+ *  - `thread_pool_steal`: The number of tasks stolen from another worker.
+ *  - `thread_pool_busy_ns`: The total amount of time the workers spend executing tasks.
+ *  - `thread_pool_idle_ns`: The total amount of time the workers spend waiting for tasks.
+ */
+class thread_pool {
+public:
+    using task_type = std::function<void()>;
+
+    /** Create a thread pool.
+     *
+     * @param nr_workers The number of worker threads.
+     * @param pin_workers When true each worker is pinned to a different CPU
+     *                    from the process affinity mask.
+     */
+    thread_pool(size_t nr_workers, bool pin_workers) noexcept;
+
+    /** Stop the thread pool.
+     * Tasks that were not started are not executed.
+     */
+    ~thread_pool();
+
+    thread_pool(thread_pool const &) = delete;
+    thread_pool(thread_pool &&) = delete;
+    thread_pool &operator=(thread_pool const &) = delete;
+    thread_pool &operator=(thread_pool &&) = delete;
+
+    /** The number of worker threads.
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _workers.size();
+    }
+
+    /** Submit a task to be executed on the pool.
+     * When called from a worker of this pool the task is added to the worker's
+     * own queue, otherwise to the shared queue.
+     */
+    void submit(task_type task) noexcept;
+
+    /** Execute a single task from the pool on the current thread.
+     * This is used by threads that wait for tasks to complete, so that they
+     * help with the work instead of blocking.
+     *
+     * @return True if a task was executed, false if no task was available.
+     */
+    bool try_run_one() noexcept;
+
+    /** The global thread pool.
+     * The global thread pool has a worker pinned to each CPU available to the process,
+     * except for one CPU, since the thread that waits on the tasks helps executing them.
+     */
+    [[nodiscard]] static thread_pool &global() noexcept
+    {
+        return *start_subsystem_or_terminate(_global, nullptr, subsystem_init, subsystem_deinit);
+    }
+
+private:
+    struct worker_type {
+        unfair_mutex mutex;
+        std::deque<task_type> tasks;
+        std::jthread thread;
+    };
+
+    static inline std::atomic<thread_pool *> _global;
+
+    std::vector<std::unique_ptr<worker_type>> _workers;
+
+    unfair_mutex _shared_mutex;
+    std::deque<task_type> _shared_tasks;
+
+    /** Incremented each time a task is submitted.
+     * Idle workers wait for this value to change.
+     */
+    std::atomic<uint64_t> _epoch = 0;
+
+    /** The number of workers waiting on `_epoch`.
+     */
+    std::atomic<size_t> _nr_sleeping = 0;
+
+    std::atomic<bool> _stop = false;
+
+    /** The index of the worker of this pool running on the current thread, or -1.
+     */
+    [[nodiscard]] ssize_t current_worker_index() const noexcept;
+
+    [[nodiscard]] std::optional<task_type> find_task(ssize_t worker_index) noexcept;
+
+    void worker_loop(size_t worker_index, std::optional<size_t> cpu) noexcept;
+
+    [[nodiscard]] static thread_pool *subsystem_init() noexcept;
+    static void subsystem_deinit() noexcept;
+};
+
+/** A group of tasks that are executed on a thread pool and waited on together.
+ *
+ * The thread that waits on the task group helps executing tasks from the pool,
+ * which makes it possible to fork and join task groups recursively from within tasks.
+ */
+class task_group {
+public:
+    explicit task_group(thread_pool &pool = thread_pool::global()) noexcept : _pool(pool) {}
+
+    /** Wait for all tasks of the group to complete.
+     */
+    ~task_group()
+    {
+        wait();
+    }
+
+    task_group(task_group const &) = delete;
+    task_group(task_group &&) = delete;
+    task_group &operator=(task_group const &) = delete;
+    task_group &operator=(task_group &&) = delete;
+
+    /** Fork a task.
+     * @param func The function to execute on the thread pool. The function must
+     *             remain valid until the task group is waited on.
+     */
+    template<std::invocable Func>
+    void run(Func &&func) noexcept
+    {
+        _nr_pending.fetch_add(1, std::memory_order::relaxed);
+        _pool.submit([this, func = std::forward<Func>(func)]() mutable {
+            func();
+
+            // Decrement and notify while holding the lock. The waiting thread locks the mutex
+            // after it sees zero pending tasks, so it can not destroy the task_group until
+            // this task released the lock, which is its last access to the task_group.
+            ttlet lock = std::scoped_lock(_mutex);
+            if (_nr_pending.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+                _condition.notify_all();
+            }
+        });
+    }
+
+    /** Join all tasks of the group.
+     * While waiting, the current thread executes tasks from the thread pool.
+     */
+    void wait() noexcept
+    {
+        while (_nr_pending.load(std::memory_order::acquire) != 0) {
+            if (not _pool.try_run_one()) {
+                auto lock = std::unique_lock(_mutex);
+                _condition.wait(lock, [this] {
+                    return _nr_pending.load(std::memory_order::acquire) == 0;
+                });
+            }
+        }
+
+        // Wait until the task that made the last decrement released the lock.
+        ttlet lock = std::scoped_lock(_mutex);
+    }
+
+private:
+    thread_pool &_pool;
+    std::atomic<size_t> _nr_pending = 0;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+};
+
+/** Execute a function for each index in a range in parallel.
+ *
+ * The range is split in chunks of at least `grain_size` indices, which are
+ * executed as tasks on the thread pool. The current thread executes tasks
+ * as well until all indices have been processed.
+ *
+ * @param first The first index.
+ * @param last One beyond the last index.
+ * @param func The function to call with each index.
+ * @param grain_size The minimum number of indices in a single task.
+ * @param pool The thread pool to execute the tasks on.
+ */
+template<std::integral T, std::invocable<T> Func>
+void parallel_for(T first, T last, Func const &func, T grain_size = T{1}, thread_pool &pool = thread_pool::global()) noexcept
+{
+    if (last <= first) {
+        return;
+    }
+
+    // Split the work in a few chunks for each thread, so that the load is
+    // balanced by stealing when some chunks take longer than others.
+    ttlet nr_threads = pool.size() + 1;
+    ttlet size = static_cast<size_t>(last - first);
+    ttlet chunk_size = static_cast<T>(std::max(static_cast<size_t>(std::max(grain_size, T{1})), size / (nr_threads * 4)));
+
+    if (nr_threads == 1 or static_cast<size_t>(chunk_size) >= size) {
+        for (auto i = first; i != last; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    auto group = task_group{pool};
+    auto chunk_first = first;
+    for (; last - chunk_first > chunk_size; chunk_first += chunk_size) {
+        group.run([&func, chunk_first, chunk_last = static_cast<T>(chunk_first + chunk_size)] {
+            for (auto i = chunk_first; i != chunk_last; ++i) {
+                func(i);
+            }
+        });
+    }
+
+    // Execute the last chunk on the current thread.
+    for (auto i = chunk_first; i != last; ++i) {
+        func(i);
+    }
+    group.wait();
+}
+
+/** Execute a function for each element in a span in parallel.
+ *
+ * @param span The elements to process.
+ * @param func The function to call with a reference to each element.
+ * @param grain_size The minimum number of elements in a single task.
+ * @param pool The thread pool to execute the tasks on.
+ */
+template<typename T, size_t Extent, std::invocable<T &> Func>
+void parallel_for(std::span<T, Extent> span, Func const &func, size_t grain_size = 1, thread_pool &pool = thread_pool::global()) noexcept
+{
+    parallel_for(
+        size_t{0},
+        span.size(),
+        [&span, &func](size_t i) {
+            func(span[i]);
+        },
+        grain_size,
+        pool);
+}
+
+} // namespace tt
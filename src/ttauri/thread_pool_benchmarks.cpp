@@ -0,0 +1,58 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/thread_pool.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace tt;
+
+/** Compute bound work over a large array.
+ * The number of threads is the number of workers plus the thread waiting on the work.
+ */
+static void parallel_for_scaling(benchmark::State &state)
+{
+    ttlet nr_threads = static_cast<size_t>(state.range(0));
+    auto pool = thread_pool{nr_threads - 1, true};
+
+    auto values = std::vector<float>(1 << 20, 1.0f);
+    for (auto _ : state) {
+        parallel_for(
+            std::span{values},
+            [](float &value) {
+                value = std::sqrt(value * value + 1.0f);
+            },
+            size_t{1024},
+            pool);
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * std::ssize(values));
+}
+
+/** Many small tasks, measuring the overhead of scheduling and stealing.
+ */
+static void task_group_scaling(benchmark::State &state)
+{
+    ttlet nr_threads = static_cast<size_t>(state.range(0));
+    auto pool = thread_pool{nr_threads - 1, true};
+
+    constexpr int nr_tasks = 10000;
+    auto results = std::vector<int>(nr_tasks);
+    for (auto _ : state) {
+        auto group = task_group{pool};
+        for (auto i = 0; i != nr_tasks; ++i) {
+            group.run([&results, i] {
+                results[i] = i * i;
+            });
+        }
+        group.wait();
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * nr_tasks);
+}
+
+BENCHMARK(parallel_for_scaling)->DenseRange(1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))->UseRealTime();
+BENCHMARK(task_group_scaling)->DenseRange(1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))->UseRealTime();
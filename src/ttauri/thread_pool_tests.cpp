@@ -0,0 +1,129 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/thread_pool.hpp"
+#include "ttauri/counters.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+TEST(thread_pool, task_group)
+{
+    auto pool = thread_pool{4, false};
+    auto count = std::atomic<int>{0};
+
+    {
+        auto group = task_group{pool};
+        for (auto i = 0; i != 1000; ++i) {
+            group.run([&count] {
+                ++count;
+            });
+        }
+        group.wait();
+        ASSERT_EQ(count.load(), 1000);
+    }
+
+    ASSERT_GE(read_counter<"thread_pool_task", counter_mode::sharded>(), 1000);
+}
+
+/** Fork recursively from within tasks, which requires waiting threads to help.
+ */
+[[nodiscard]] static int fibonacci(thread_pool &pool, int n) noexcept
+{
+    if (n < 2) {
+        return n;
+    }
+
+    int a = 0;
+    auto group = task_group{pool};
+    group.run([&pool, &a, n] {
+        a = fibonacci(pool, n - 1);
+    });
+    ttlet b = fibonacci(pool, n - 2);
+    group.wait();
+    return a + b;
+}
+
+TEST(thread_pool, short_lived_task_groups)
+{
+    // A group is destroyed as soon as its tasks are complete, while the worker
+    // that ran the last task may still be finishing up.
+    auto pool = thread_pool{4, false};
+    auto count = std::atomic<int>{0};
+
+    for (auto i = 0; i != 10000; ++i) {
+        auto group = std::make_unique<task_group>(pool);
+        group->run([&count] {
+            ++count;
+        });
+        group->wait();
+        group.reset();
+    }
+    ASSERT_EQ(count.load(), 10000);
+}
+
+TEST(thread_pool, nested_task_group)
+{
+    auto pool = thread_pool{2, false};
+    ASSERT_EQ(fibonacci(pool, 20), 6765);
+}
+
+TEST(thread_pool, parallel_for_index)
+{
+    auto pool = thread_pool{3, false};
+    auto values = std::vector<int>(10007, 0);
+
+    parallel_for(
+        size_t{0},
+        values.size(),
+        [&values](size_t i) {
+            values[i] += static_cast<int>(i);
+        },
+        size_t{16},
+        pool);
+
+    for (size_t i = 0; i != values.size(); ++i) {
+        ASSERT_EQ(values[i], static_cast<int>(i));
+    }
+}
+
+TEST(thread_pool, parallel_for_span)
+{
+    auto pool = thread_pool{3, false};
+    auto values = std::vector<int>(5000);
+    std::iota(values.begin(), values.end(), 0);
+
+    parallel_for(
+        std::span{values},
+        [](int &value) {
+            value *= 2;
+        },
+        1,
+        pool);
+
+    for (size_t i = 0; i != values.size(); ++i) {
+        ASSERT_EQ(values[i], static_cast<int>(i * 2));
+    }
+}
+
+TEST(thread_pool, no_workers)
+{
+    // Without workers all tasks are executed by the waiting thread.
+    auto pool = thread_pool{0, false};
+    auto count = 0;
+
+    auto group = task_group{pool};
+    for (auto i = 0; i != 10; ++i) {
+        group.run([&count] {
+            ++count;
+        });
+    }
+    group.wait();
+    ASSERT_EQ(count, 10);
+}
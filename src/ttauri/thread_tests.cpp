@@ -0,0 +1,77 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/thread.hpp"
+#include "ttauri/architecture.hpp"
+#include "ttauri/exception.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace tt;
+using namespace std::chrono_literals;
+
+TEST(thread, affinity)
+{
+    ttlet cpu = current_cpu_id();
+    ttlet prev_mask = set_thread_affinity(cpu);
+    ASSERT_EQ(current_cpu_id(), cpu);
+    set_thread_affinity_mask(prev_mask);
+}
+
+TEST(thread, realtime_fifo)
+{
+    auto parameters = realtime_parameters{};
+    parameters.priority = 10;
+    parameters.watchdog_utilization = 0.0f;
+
+    try {
+        set_thread_realtime(parameters);
+    } catch (os_error const &e) {
+        GTEST_SKIP() << e.what();
+    }
+    ASSERT_TRUE(is_thread_realtime());
+
+    clear_thread_realtime();
+    ASSERT_FALSE(is_thread_realtime());
+}
+
+TEST(thread, realtime_watchdog)
+{
+    if constexpr (operating_system::current != operating_system::linux_) {
+        GTEST_SKIP() << "The real-time watchdog is only implemented on Linux.";
+    }
+
+    auto skipped = false;
+    auto demoted = false;
+
+    // A real-time thread that never blocks is demoted by the watchdog.
+    auto thread = std::thread([&] {
+        auto parameters = realtime_parameters{};
+        parameters.priority = 1;
+        parameters.watchdog_utilization = 0.5f;
+
+        try {
+            set_thread_realtime(parameters);
+        } catch (os_error const &) {
+            skipped = true;
+            return;
+        }
+
+        ttlet end = std::chrono::steady_clock::now() + 5s;
+        while (std::chrono::steady_clock::now() < end) {
+            if (not is_thread_realtime()) {
+                demoted = true;
+                return;
+            }
+        }
+    });
+    thread.join();
+
+    if (skipped) {
+        GTEST_SKIP() << "Not allowed to use real-time scheduling.";
+    }
+    ASSERT_TRUE(demoted);
+}
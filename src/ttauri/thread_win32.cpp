@@ -8,6 +8,7 @@
 #include "exception.hpp"
 #include <Windows.h>
 #include <Synchapi.h>
+#include <algorithm>
 
 namespace tt {
 
@@ -15,6 +16,7 @@ void set_thread_name(std::string_view name)
 {
     ttlet wname = to_wstring(name);
     SetThreadDescription(GetCurrentThread(), wname.data());
+    detail::register_thread_name(name);
 }
 
 static std::vector<bool> mask_int_to_vec(DWORD_PTR rhs) noexcept
@@ -73,6 +75,82 @@ std::vector<bool> set_thread_affinity_mask(std::vector<bool> const &mask)
     return index;
 }
 
+/** Lock the stack of the current thread from `size` bytes below the current stack frame up to the top of the stack.
+ *
+ * @return The number of bytes that were locked.
+ */
+[[nodiscard]] static size_t lock_thread_stack(size_t size)
+{
+    ULONG_PTR stack_low;
+    ULONG_PTR stack_high;
+    GetCurrentThreadStackLimits(&stack_low, &stack_high);
+
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    ttlet page_size = static_cast<ULONG_PTR>(system_info.dwPageSize);
+
+    // The stack grows down, lock the part below the current frame which the thread is about to use.
+    // Pages below the current frame are only reserved, they are committed by touching them from the
+    // top down, which moves the guard page down one page at a time.
+    // A margin is kept above the lowest pages for the calls made by this function and its callers.
+    constexpr ULONG_PTR margin_pages = 16;
+    volatile char marker = 0;
+    ttlet current = reinterpret_cast<ULONG_PTR>(&marker) & ~(page_size - 1);
+    ttlet margin = margin_pages * page_size;
+    size = std::min(size, current > stack_low + margin ? current - stack_low - margin : 0);
+    ttlet first = current - size;
+
+    for (auto address = current; address > first;) {
+        address -= page_size;
+        *reinterpret_cast<volatile char *>(address) = 0;
+    }
+
+    if (not VirtualLock(reinterpret_cast<void *>(first), stack_high - first)) {
+        throw os_error("Could not lock the stack of the thread. '{}'", get_last_error_message());
+    }
+    return stack_high - first;
+}
+
+void set_thread_realtime(realtime_parameters const &parameters)
+{
+    if (parameters.policy == realtime_policy::deadline) {
+        throw os_error("The deadline scheduling policy is not supported on Windows.");
+    }
+
+    // Windows has no separate real-time policies, only the highest thread priorities.
+    ttlet priority = parameters.priority >= 50 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST;
+    if (not SetThreadPriority(GetCurrentThread(), priority)) {
+        throw os_error("Could not set the thread priority. '{}'", get_last_error_message());
+    }
+
+    size_t stack_locked = 0;
+    if (parameters.stack_lock_size != 0) {
+        try {
+            stack_locked = lock_thread_stack(parameters.stack_lock_size);
+        } catch (os_error const &e) {
+            tt_log_warning("{}", e.what());
+        }
+    }
+
+    tt_log_info(
+        "Thread '{}' runs with priority {}, {} KiB of stack locked.",
+        get_thread_name(current_thread_id()),
+        GetThreadPriority(GetCurrentThread()),
+        stack_locked / 1024);
+}
+
+void clear_thread_realtime() noexcept
+{
+    if (not SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL)) {
+        tt_log_error("Could not set the thread priority. '{}'", get_last_error_message());
+    }
+}
+
+[[nodiscard]] bool is_thread_realtime() noexcept
+{
+    return GetThreadPriority(GetCurrentThread()) >= THREAD_PRIORITY_HIGHEST;
+}
+
 
 
 }
@@ -3,6 +3,7 @@
 #include "hires_utc_clock.hpp"
 #include "logger.hpp"
 #include <emmintrin.h>
+#include <algorithm>
 #include <array>
 #include <cstdint>
 
@@ -79,6 +80,14 @@ namespace tt {
 
 void time_stamp_count::populate_aux_values() noexcept
 {
+    if (os_populate_aux_values()) {
+        tt_log_info("Found {} CPUs using the TSC:AUX values of the operating system.", _num_aux_values.load());
+        if (_aux_is_cpu_id.load(std::memory_order::relaxed)) {
+            tt_log_info("Use fast time_stamp_count.cpu_id() implementation.");
+        }
+        return;
+    }
+
     // Keep track of the original thread affinity of the main thread.
     auto prev_mask = set_thread_affinity(current_cpu_id());
 
@@ -113,24 +122,32 @@ void time_stamp_count::populate_aux_values() noexcept
 
 void time_stamp_count::configure_frequency() noexcept
 {
+    if (ttlet frequency = os_frequency(); frequency != 0) {
+        tt_log_info("The frequency of the TSC reported by the operating system is {} Hz.", frequency);
+        time_stamp_count::set_frequency(frequency);
+        return;
+    }
+
     // This function is called from the crt and must therefor be quick as we do not
     // want to keep the user waiting. We are satisfied if the measured frequency is
     // to within 1% accuracy.
 
-    // We take an average over 4 times in case the hires_utc_clock gets reset by a time server.
-    uint64_t frequency = 0;
-    uint64_t num_samples = 0;
-    for (int i = 0; i != 4; ++i) {
-        ttlet f = time_stamp_count::measure_frequency(25ms);
+    // We take the median of 5 samples in case the hires_utc_clock gets adjusted by a time server,
+    // or the thread gets preempted during one of the samples.
+    std::array<uint64_t, 5> frequencies;
+    size_t num_samples = 0;
+    for (auto i = 0; i != 10 and num_samples != frequencies.size(); ++i) {
+        ttlet f = time_stamp_count::measure_frequency(20ms);
         if (f != 0) {
-            frequency += f;
-            ++num_samples;
+            frequencies[num_samples++] = f;
         }
     }
     if (num_samples == 0) {
         tt_log_fatal("Unable the measure the frequency of the TSC. The UTC time did not advance.");
     }
-    frequency /= num_samples;
+    ttlet median = std::next(frequencies.begin(), num_samples / 2);
+    std::nth_element(frequencies.begin(), median, std::next(frequencies.begin(), num_samples));
+    ttlet frequency = *median;
 
     tt_log_info("The measured frequency of the TSC is {} Hz.", frequency);
     time_stamp_count::set_frequency(frequency);
@@ -140,6 +157,12 @@ void time_stamp_count::configure_frequency() noexcept
 {
     configure_frequency();
     populate_aux_values();
+
+    ttlet is_synchronized = os_is_synchronized();
+    _is_synchronized.store(is_synchronized, std::memory_order::relaxed);
+    if (is_synchronized) {
+        tt_log_info("The TSCs of all CPUs are synchronized by the operating system.");
+    }
 }
 
 } // namespace tt
@@ -16,6 +16,7 @@
 #include <intrin.h>
 #elif TT_OPERATING_SYSTEM == TT_OS_LINUX
 #include <x86intrin.h>
+#include <unistd.h>
 #endif
 
 namespace tt {
@@ -51,10 +52,8 @@ public:
     explicit time_stamp_count(time_stamp_count::inplace_with_thread_id) noexcept
     {
         if constexpr (processor::current == processor::x64) {
-            constexpr uint64_t NT_TIB_CurrentThreadID = 0x48;
-
             _count = __rdtscp(&_aux);
-            _thread_id = __readgsdword(NT_TIB_CurrentThreadID);
+            _thread_id = os_thread_id();
         } else {
             tt_not_implemented();
         }
@@ -135,6 +134,16 @@ public:
         _period.store(period, std::memory_order_relaxed);
     }
 
+    /** Check if the TSCs of all CPUs are synchronized.
+     * When true the operating system guarantees that the TSC of each CPU has the same
+     * count at the same time, so that a count taken on one CPU may be compared with
+     * a count taken on another CPU.
+     */
+    [[nodiscard]] static bool is_synchronized() noexcept
+    {
+        return _is_synchronized.load(std::memory_order::relaxed);
+    }
+
     /** Start the time_stamp_count subsystem.
      */
     static void start_subsystem() noexcept;
@@ -161,6 +170,8 @@ private:
 
     inline static std::atomic<bool> _aux_is_cpu_id = false;
 
+    inline static std::atomic<bool> _is_synchronized = false;
+
     /** The number of CPU ids we know of.
      */
     inline static std::atomic<size_t> _num_aux_values = 0;
@@ -182,6 +193,43 @@ private:
      */
     [[nodiscard]] ssize_t cpu_id_fallback() const noexcept;
 
+    /** Get the thread id of the current thread, as used by the operating system.
+     */
+    [[nodiscard]] static uint32_t os_thread_id() noexcept
+    {
+#if TT_OPERATING_SYSTEM == TT_OS_WINDOWS
+        constexpr uint64_t NT_TIB_CurrentThreadID = 0x48;
+        return __readgsdword(NT_TIB_CurrentThreadID);
+#elif TT_OPERATING_SYSTEM == TT_OS_LINUX
+        // gettid() is a system call, so the result is cached for each thread.
+        if (_os_thread_id == 0) [[unlikely]] {
+            _os_thread_id = static_cast<uint32_t>(::gettid());
+        }
+        return _os_thread_id;
+#else
+        return static_cast<uint32_t>(current_thread_id());
+#endif
+    }
+
+    thread_local inline static uint32_t _os_thread_id = 0;
+
+    /** Get the frequency of the TSC as calibrated by the operating system.
+     *
+     * @return The frequency in Hz, or zero when the operating system does not provide it.
+     */
+    [[nodiscard]] static uint64_t os_frequency() noexcept;
+
+    /** Check if the operating system keeps the TSCs of all CPUs synchronized.
+     */
+    [[nodiscard]] static bool os_is_synchronized() noexcept;
+
+    /** Fill the table of aux values using information from the operating system.
+     * This does not need to migrate the current thread to each CPU.
+     *
+     * @return true on success, false if the table must be filled by visiting each CPU.
+     */
+    [[nodiscard]] static bool os_populate_aux_values() noexcept;
+
     static void populate_aux_values() noexcept;
     static void configure_frequency() noexcept;
 };
@@ -0,0 +1,181 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "time_stamp_count.hpp"
+#include "int_carry.hpp"
+#include "thread.hpp"
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cpuid.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+
+namespace tt {
+
+/** Get the TSC frequency from the conversion factors the kernel shares with user-space for perf.
+ *
+ * The kernel publishes `time_mult` and `time_shift` so that user-space can convert a TSC count to
+ * nanoseconds as `(count * time_mult) >> time_shift`; these are the result of the kernel's own
+ * TSC calibration.
+ *
+ * @return The frequency in Hz, or zero when the kernel does not provide it.
+ */
+[[nodiscard]] static uint64_t perf_tsc_frequency() noexcept
+{
+    auto attr = perf_event_attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_DUMMY;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    ttlet fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (fd < 0) {
+        return 0;
+    }
+
+    ttlet page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto *page = mmap(nullptr, page_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED) {
+        return 0;
+    }
+
+    ttlet *info = static_cast<perf_event_mmap_page volatile const *>(page);
+
+    bool cap_user_time;
+    uint32_t time_mult;
+    uint16_t time_shift;
+    uint32_t sequence;
+    do {
+        sequence = info->lock;
+        std::atomic_signal_fence(std::memory_order::acquire);
+        cap_user_time = info->cap_user_time;
+        time_mult = info->time_mult;
+        time_shift = info->time_shift;
+        std::atomic_signal_fence(std::memory_order::acquire);
+    } while (info->lock != sequence);
+
+    munmap(page, page_size);
+
+    if (not cap_user_time or time_mult == 0 or time_shift >= 64) {
+        return 0;
+    }
+
+    // frequency = 1'000'000'000 * 2^time_shift / time_mult
+    ttlet[lo, hi] = wide_mul(uint64_t{1'000'000'000}, uint64_t{1} << time_shift);
+    return wide_div(lo, hi, uint64_t{time_mult});
+}
+
+/** Get the TSC frequency from the crystal clock ratio reported by the CPU.
+ *
+ * @return The frequency in Hz, or zero when the CPU does not report it.
+ */
+[[nodiscard]] static uint64_t cpuid_tsc_frequency() noexcept
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) == 0 or eax < 0x15) {
+        return 0;
+    }
+
+    // EAX: denominator, EBX: numerator, ECX: crystal clock frequency in Hz.
+    __cpuid_count(0x15, 0, eax, ebx, ecx, edx);
+    if (eax == 0 or ebx == 0 or ecx == 0) {
+        return 0;
+    }
+
+    return uint64_t{ecx} * ebx / eax;
+}
+
+[[nodiscard]] uint64_t time_stamp_count::os_frequency() noexcept
+{
+    if (ttlet frequency = perf_tsc_frequency(); frequency != 0) {
+        return frequency;
+    }
+    return cpuid_tsc_frequency();
+}
+
+[[nodiscard]] bool time_stamp_count::os_is_synchronized() noexcept
+{
+    // The kernel only selects the TSC as clock source after it verified that the TSCs of all
+    // CPUs are synchronized and run at a constant rate. If the kernel later finds that the TSC
+    // is unstable it will switch to another clock source.
+    auto file = std::ifstream("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+    auto clock_source = std::string{};
+    file >> clock_source;
+    return clock_source == "tsc";
+}
+
+/** Get the NUMA node of a CPU.
+ *
+ * @return The node, or zero when the system does not have NUMA nodes.
+ */
+[[nodiscard]] static uint32_t cpu_numa_node(size_t cpu_id) noexcept
+{
+    auto ec = std::error_code{};
+    ttlet path = std::filesystem::path{std::format("/sys/devices/system/cpu/cpu{}", cpu_id)};
+    for (auto it = std::filesystem::directory_iterator(path, ec); not ec and it != std::filesystem::directory_iterator{};
+         it.increment(ec)) {
+        ttlet name = it->path().filename().string();
+        if (name.starts_with("node") and name.size() > 4) {
+            try {
+                return narrow_cast<uint32_t>(std::stoul(name.substr(4)));
+            } catch (...) {
+            }
+        }
+    }
+    return 0;
+}
+
+[[nodiscard]] bool time_stamp_count::os_populate_aux_values() noexcept
+{
+    // The kernel writes `(node << 12) | cpu` into the TSC_AUX register of each CPU, which
+    // is also how the vDSO implements getcpu(). Check this on the current CPU; if it holds
+    // the aux values of all other CPUs follow from their NUMA node.
+    for (auto i = 0; i != 10; ++i) {
+        unsigned int cpu;
+        unsigned int node;
+        uint32_t aux1;
+        uint32_t aux2;
+
+        __rdtscp(&aux1);
+        if (getcpu(&cpu, &node) != 0) {
+            return false;
+        }
+        __rdtscp(&aux2);
+
+        if (aux1 != aux2) {
+            // The thread was migrated to another CPU, try again.
+            continue;
+        }
+
+        if (aux1 != ((node << 12) | cpu)) {
+            return false;
+        }
+
+        ttlet process_cpu_mask = process_affinity_mask();
+
+        size_t num_aux_values = 0;
+        for (size_t cpu_id = 0; cpu_id != process_cpu_mask.size() and num_aux_values + 1 < _aux_values.size(); ++cpu_id) {
+            if (process_cpu_mask[cpu_id]) {
+                _aux_values[num_aux_values] = (cpu_numa_node(cpu_id) << 12) | narrow_cast<uint32_t>(cpu_id);
+                _cpu_ids[num_aux_values] = cpu_id;
+                ++num_aux_values;
+            }
+        }
+        _num_aux_values.store(num_aux_values, std::memory_order::release);
+
+        // The CPU-id fits in the lower 12 bits of the aux value.
+        _aux_is_cpu_id.store(maximum_num_cpus <= 4096, std::memory_order::relaxed);
+        return true;
+    }
+    return false;
+}
+
+} // namespace tt
@@ -0,0 +1,26 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "time_stamp_count.hpp"
+
+namespace tt {
+
+[[nodiscard]] uint64_t time_stamp_count::os_frequency() noexcept
+{
+    // macOS does not provide the frequency of the TSC.
+    return 0;
+}
+
+[[nodiscard]] bool time_stamp_count::os_is_synchronized() noexcept
+{
+    return false;
+}
+
+[[nodiscard]] bool time_stamp_count::os_populate_aux_values() noexcept
+{
+    // The TSC_AUX value on macOS is not documented, each CPU needs to be visited.
+    return false;
+}
+
+} // namespace tt
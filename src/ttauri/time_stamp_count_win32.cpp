@@ -1,12 +1,28 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "time_stamp_count.hpp"
 #include <Windows.h>
 #include <profileapi.h>
 
 namespace tt {
-    
 
+[[nodiscard]] uint64_t time_stamp_count::os_frequency() noexcept
+{
+    // QueryPerformanceFrequency() returns the frequency of the performance counter, not of the TSC.
+    return 0;
+}
 
+[[nodiscard]] bool time_stamp_count::os_is_synchronized() noexcept
+{
+    return false;
+}
 
+[[nodiscard]] bool time_stamp_count::os_populate_aux_values() noexcept
+{
+    // The TSC_AUX value on Windows is not documented, each CPU needs to be visited.
+    return false;
 }
 
+} // namespace tt
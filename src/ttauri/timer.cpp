@@ -6,6 +6,7 @@
 #include "thread.hpp"
 #include "logger.hpp"
 #include <algorithm>
+#include <utility>
 
 namespace tt {
 
@@ -36,16 +37,38 @@ void timer::subsystem_deinit() noexcept
     return next_wakeup;
 }
 
-timer::timer(std::string name) noexcept : name(std::move(name)) {}
+timer::timer(std::string name, duration coalescing_window) noexcept :
+    name(std::move(name)), callback_wheel(hires_utc_clock::now(), coalescing_window)
+{
+}
 
 timer::~timer()
 {
     stop();
-    tt_assert(std::ssize(callback_list) == 0);
+    tt_assert(callback_wheel.empty());
 }
 
 void timer::start_with_lock_held() noexcept
 {
+    if (running) {
+        return;
+    }
+
+    // A thread that exited by itself still needs to be joined.
+    if (thread.joinable()) {
+        auto tmp = std::jthread{};
+        std::swap(tmp, thread);
+
+        mutex.unlock();
+        tmp.join();
+        mutex.lock();
+
+        if (running) {
+            return;
+        }
+    }
+
+    running = true;
     thread = std::jthread([this](std::stop_token stop_token) {
         set_thread_name(name);
         return loop(stop_token);
@@ -79,39 +102,44 @@ void timer::stop() noexcept
     mutex.unlock();
 }
 
-[[nodiscard]] std::pair<std::vector<timer::callback_ptr_type>, timer::time_point>
-timer::find_triggered_callbacks(timer::time_point current_time) noexcept
+void timer::find_triggered_callbacks(timer::time_point current_time) noexcept
 {
     ttlet lock = std::scoped_lock(mutex);
 
-    auto triggered_callbacks = std::vector<callback_ptr_type>{};
-    auto next_wakeup = timer::time_point::max();
+    // Protection against clock_settime(), keep the time until each callback triggers.
+    if (current_time < callback_wheel.now()) {
+        callback_wheel.reset(current_time);
+    }
 
-    auto i = callback_list.begin();
-    while (i != callback_list.end()) {
-        auto callback_ptr = i->callback_ptr.lock();
+    callback_wheel.advance(current_time, [&](auto handle, callback_entry &item) -> std::optional<time_point> {
+        if (auto callback_ptr = item.callback_ptr.lock()) {
+            triggered_callbacks.push_back(std::move(callback_ptr));
+            return calculate_next_wakeup(current_time, item.interval);
+        }
 
-        if (callback_ptr) {
-            if (i->next_wakeup <= current_time) {
-                triggered_callbacks.push_back(callback_ptr);
-                i->next_wakeup = calculate_next_wakeup(current_time, i->interval);
-            }
+        if (ttlet i = callback_handles.find(item.key); i != callback_handles.end() and i->second == handle) {
+            callback_handles.erase(i);
+        }
+        return {};
+    });
+}
 
-            // Protection against clock_settime().
-            if (i->next_wakeup > current_time + i->interval) {
-                i->next_wakeup = calculate_next_wakeup(current_time, i->interval);
-            }
+[[nodiscard]] std::vector<std::function<void()>> timer::take_triggered_oneshots(timer::time_point current_time) noexcept
+{
+    ttlet lock = std::scoped_lock(mutex);
 
-            if (i->next_wakeup < next_wakeup) {
-                next_wakeup = i->next_wakeup;
-            }
+    auto triggered_functions = std::vector<std::function<void()>>{};
 
-            ++i;
+    auto i = oneshot_list.begin();
+    while (i != oneshot_list.end()) {
+        if (i->wakeup <= current_time) {
+            triggered_functions.push_back(std::move(i->function));
+            i = oneshot_list.erase(i);
         } else {
-            i = callback_list.erase(i);
+            ++i;
         }
     }
-    return {triggered_callbacks, next_wakeup};
+    return triggered_functions;
 }
 
 void timer::loop(std::stop_token stop_token) noexcept
@@ -120,48 +148,93 @@ void timer::loop(std::stop_token stop_token) noexcept
     while (true) {
         ttlet current_time = hires_utc_clock::now();
 
-        ttlet & [ triggered_callbacks, next_wakeup ] = find_triggered_callbacks(current_time);
-
         // Execute all the triggered callbacks.
+        find_triggered_callbacks(current_time);
         for (ttlet &callback_ptr : triggered_callbacks) {
             (*callback_ptr)(current_time, false);
         }
+        triggered_callbacks.clear();
+
+        for (ttlet &function : take_triggered_oneshots(current_time)) {
+            function();
+        }
+
+        auto lock = std::unique_lock(mutex);
 
-        // Sleep, but not for more than 100ms.
-        ttlet sleep_duration = std::min(next_wakeup - current_time, timer::duration{100ms});
-        if (sleep_duration > 0ms) {
-            std::this_thread::sleep_for(sleep_duration);
+        // Callbacks and one-shot functions that were added while executing are included here,
+        // the ones added while sleeping will wake up the thread when they are due before `next_wakeup`.
+        next_wakeup = callback_wheel.next_expiry();
+        for (ttlet &item : oneshot_list) {
+            next_wakeup = std::min(next_wakeup, item.wakeup);
         }
 
-        ttlet lock = std::scoped_lock(mutex);
-        if (stop_token.stop_requested() or std::ssize(callback_list) == 0) {
+        // Sleep, but not for more than 1s, or until an earlier callback or one-shot function is added.
+        ttlet sleep_duration = std::min(next_wakeup - hires_utc_clock::now(), timer::duration{1s});
+        if (sleep_duration > 0ms and not wakeup_requested) {
+            wakeup_condition.wait_for(lock, stop_token, sleep_duration, [this] {
+                return wakeup_requested;
+            });
+        }
+        wakeup_requested = false;
+        next_wakeup = time_point::min();
+
+        if (stop_token.stop_requested()) {
             break;
         }
+
+        // Exit when there is no more work, while holding the lock, so that a callback
+        // or one-shot function added after this will start a new thread.
+        if (callback_wheel.empty() and oneshot_list.empty()) {
+            running = false;
+            tt_log_info("Timer {}: finished", name);
+            return;
+        }
     }
     tt_log_info("Timer {}: finishing up", name);
 
-    ttlet lock = std::scoped_lock(mutex);
+    auto lock = std::unique_lock(mutex);
 
     ttlet current_time = hires_utc_clock::now();
-    for (ttlet &item : callback_list) {
+    callback_wheel.clear([&](callback_entry &item) {
         if (auto callback_ptr_ = item.callback_ptr.lock()) {
             (*callback_ptr_)(current_time, true);
         }
+    });
+    callback_handles.clear();
+
+    // One-shot functions are executed without holding the lock, since they may add new one-shot functions.
+    while (not oneshot_list.empty()) {
+        auto oneshots = std::exchange(oneshot_list, {});
+        lock.unlock();
+        for (ttlet &item : oneshots) {
+            item.function();
+        }
+        lock.lock();
     }
-    callback_list.clear();
+
+    running = false;
+    lock.unlock();
 
     tt_log_info("Timer {}: finished", name);
 }
 
+void timer::add_oneshot(time_point wakeup, std::function<void()> function) noexcept
+{
+    ttlet lock = std::scoped_lock(mutex);
+
+    oneshot_list.push_back({wakeup, std::move(function)});
+    request_wakeup_with_lock_held(wakeup);
+    start_with_lock_held();
+}
+
 void timer::remove_callback(callback_ptr_type const &callback_ptr) noexcept
 {
     ttlet lock = std::scoped_lock(mutex);
 
-    ttlet i = std::remove_if(callback_list.begin(), callback_list.end(), [&callback_ptr](ttlet &item) {
-        auto callback_ptr_ = item.callback_ptr.lock();
-        return !callback_ptr_ || callback_ptr_ == callback_ptr;
-    });
-    callback_list.erase(i, callback_list.end());
+    if (ttlet i = callback_handles.find(callback_ptr.get()); i != callback_handles.end()) {
+        callback_wheel.cancel(i->second);
+        callback_handles.erase(i);
+    }
 }
 
 } // namespace tt
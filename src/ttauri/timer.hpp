@@ -8,7 +8,10 @@
 #include "hires_utc_clock.hpp"
 #include "unfair_mutex.hpp"
 #include "subsystem.hpp"
+#include "timing_wheel.hpp"
 #include <mutex>
+#include <condition_variable>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <tuple>
@@ -17,6 +20,10 @@
 namespace tt {
 
 /** A timer which will execute callbacks at given intervals.
+ *
+ * The callbacks are kept in a timing wheel, so that adding and removing callbacks is O(1)
+ * and the timer thread only wakes up when a callback needs to be executed. Callbacks with
+ * wakeup times within the same coalescing window are executed together.
  */
 class timer {
 public:
@@ -30,7 +37,13 @@ public:
     using callback_type = std::function<void(time_point,bool)>;
     using callback_ptr_type = std::shared_ptr<callback_type>;
 
-    timer(std::string name) noexcept;
+    /** Create a timer.
+     *
+     * @param name The name of the timer thread.
+     * @param coalescing_window The resolution of the timer; callbacks are delayed by at most
+     *                          this duration so that they can be executed together.
+     */
+    timer(std::string name, duration coalescing_window = std::chrono::milliseconds(1)) noexcept;
     ~timer();
 
     /** Start the timer thread.
@@ -67,13 +80,16 @@ public:
         {
             ttlet lock = std::scoped_lock(mutex);
 
-            callback_list.emplace_back(
-                interval,
-                calculate_next_wakeup(current_time, interval),
-                callback_ptr
-            );
+            ttlet next_wakeup = calculate_next_wakeup(current_time, interval);
+            ttlet handle = callback_wheel.insert(next_wakeup, callback_entry{interval, callback_ptr, callback_ptr.get()});
+
+            // The address of a callback which expired without being removed may have been reused.
+            if (ttlet [it, inserted] = callback_handles.try_emplace(callback_ptr.get(), handle); not inserted) {
+                callback_wheel.cancel(std::exchange(it->second, handle));
+            }
 
-            if (std::ssize(callback_list) == 1) {
+            request_wakeup_with_lock_held(next_wakeup);
+            if (not running) {
                 start_with_lock_held();
             }
         }
@@ -88,6 +104,14 @@ public:
      */
     void remove_callback(callback_ptr_type const &callback_ptr) noexcept;
 
+    /** Execute a function once on the timer thread.
+     *
+     * @param wakeup The time when to execute the function.
+     * @param function The function to execute. When the timer is stopped before
+     *                 the wakeup time, the function is executed while stopping.
+     */
+    void add_oneshot(time_point wakeup, std::function<void()> function) noexcept;
+
     static timer &global() noexcept
     {
         return *start_subsystem_or_terminate(_global, nullptr, subsystem_init, subsystem_deinit);
@@ -96,13 +120,18 @@ public:
 private:
     struct callback_entry {
         duration interval;
-        time_point next_wakeup;
         std::weak_ptr<callback_type> callback_ptr;
 
-        callback_entry(duration interval, time_point next_wakeup, std::shared_ptr<callback_type> const &callback_ptr) noexcept :
-            interval(interval), next_wakeup(next_wakeup), callback_ptr(callback_ptr)
-        {
-        }
+        /** The address of the callback, used as key in `callback_handles`.
+         */
+        callback_type const *key;
+    };
+
+    using callback_wheel_type = timing_wheel<callback_entry, hires_utc_clock>;
+
+    struct oneshot_entry {
+        time_point wakeup;
+        std::function<void()> function;
     };
 
     static inline std::atomic<timer *> _global;
@@ -111,18 +140,51 @@ private:
      */
     std::string name;
 
-    mutable unfair_mutex mutex;
+    mutable unfair_mutex mutex{unfair_mutex_statistics_of<"timer">};
     std::jthread thread;
-    std::vector<callback_entry> callback_list;
+    callback_wheel_type callback_wheel;
+    std::unordered_map<callback_type const *, callback_wheel_type::handle_type> callback_handles;
+    std::vector<oneshot_entry> oneshot_list;
     size_t callback_count = 0;
 
-    /** Find the callbacks that have triggered.
+    /** The callbacks that triggered, reused by the timer thread to avoid allocations.
+     */
+    std::vector<callback_ptr_type> triggered_callbacks;
+
+    /** True while the timer thread executes its loop.
+     * The thread clears this flag, while holding the mutex, when it decides to exit.
+     */
+    bool running = false;
+
+    /** The time the timer thread will wake up.
+     */
+    time_point next_wakeup = time_point::max();
+
+    /** Set when a callback or one-shot function is added before `next_wakeup`, to wake up the timer thread.
+     */
+    bool wakeup_requested = false;
+    std::condition_variable_any wakeup_condition;
+
+    /** Wake up the timer thread when it is sleeping past the given time.
+     */
+    void request_wakeup_with_lock_held(time_point wakeup) noexcept
+    {
+        if (wakeup < next_wakeup) {
+            wakeup_requested = true;
+            wakeup_condition.notify_one();
+        }
+    }
+
+    /** Find the callbacks that have triggered and add them to `triggered_callbacks`.
      * This function will also update the wakup times of triggered callbacks.
+     */
+    void find_triggered_callbacks(time_point current_time) noexcept;
+
+    /** Remove the one-shot functions that have triggered.
      *
-     * @return List of triggered callbacks, Time to wakeup to trigger on the next callback.
+     * @return List of triggered functions.
      */
-    [[nodiscard]] std::pair<std::vector<callback_ptr_type>, timer::time_point>
-    find_triggered_callbacks(timer::time_point current_time) noexcept;
+    [[nodiscard]] std::vector<std::function<void()>> take_triggered_oneshots(time_point current_time) noexcept;
 
     /** The thread procedure.
      */
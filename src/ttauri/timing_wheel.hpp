@@ -0,0 +1,415 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace tt {
+
+/** A hierarchical timing wheel.
+ *
+ * Time is divided in ticks, the deadline of each entry is rounded up to a tick so that
+ * entries with similar deadlines expire together; the tick is the coalescing window.
+ *
+ * The wheel has 4 levels of 64 slots. An entry is placed in the lowest level whose range
+ * covers its deadline; level 0 has a slot for each of the next 64 ticks, level 1 a slot
+ * for each of the next 64 groups of 64 ticks, etc. When the time reaches the start of a
+ * slot in a higher level, its entries are moved to the lower levels. Deadlines beyond the
+ * range of the wheel are placed at the end of the range and are moved again when reached.
+ *
+ * Inserting and cancelling entries is O(1), entries are stored in a pool and are identified
+ * by a handle. Expiring entries does not allocate memory, and `advance()` skips empty
+ * slots using a bitmap for each level.
+ *
+ * This class is not thread-safe.
+ *
+ * @tparam T The type of the value of an entry.
+ * @tparam Clock The clock of the deadlines.
+ */
+template<typename T, typename Clock>
+class timing_wheel {
+public:
+    using value_type = T;
+    using duration = typename Clock::duration;
+    using time_point = typename Clock::time_point;
+    using handle_type = uint32_t;
+
+    static constexpr handle_type invalid_handle = std::numeric_limits<handle_type>::max();
+    static constexpr int nr_levels = 4;
+    static constexpr int slot_bits = 6;
+    static constexpr int nr_slots = 1 << slot_bits;
+
+    /** The number of ticks covered by the wheel.
+     */
+    static constexpr int64_t range = int64_t{1} << (slot_bits * nr_levels);
+
+    /** Create a timing wheel.
+     *
+     * @param start The current time.
+     * @param tick The resolution of the wheel and the window in which deadlines are coalesced.
+     */
+    timing_wheel(time_point start, duration tick) noexcept : _tick(tick), _current(to_tick_floor(start))
+    {
+        tt_axiom(tick > duration::zero());
+        _heads.fill(invalid_handle);
+    }
+
+    timing_wheel(timing_wheel const &) = delete;
+    timing_wheel(timing_wheel &&) = delete;
+    timing_wheel &operator=(timing_wheel const &) = delete;
+    timing_wheel &operator=(timing_wheel &&) = delete;
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    [[nodiscard]] duration tick() const noexcept
+    {
+        return _tick;
+    }
+
+    /** The time up to which the wheel has been advanced, rounded down to a tick.
+     */
+    [[nodiscard]] time_point now() const noexcept
+    {
+        return to_time_point(_current);
+    }
+
+    /** Add an entry.
+     *
+     * @param deadline The time at which the entry expires; a deadline in the past expires on the next tick.
+     * @param value The value of the entry.
+     * @return A handle to the entry, valid until the entry expires or is cancelled.
+     */
+    handle_type insert(time_point deadline, T value) noexcept
+    {
+        auto handle = _free;
+        if (handle != invalid_handle) {
+            _free = _nodes[handle].next;
+        } else {
+            handle = static_cast<handle_type>(_nodes.size());
+            tt_axiom(handle != invalid_handle);
+            _nodes.emplace_back();
+        }
+
+        auto &node = _nodes[handle];
+        node.value.emplace(std::move(value));
+        node.deadline = deadline;
+        link(handle, _current + 1);
+        ++_size;
+        return handle;
+    }
+
+    /** Remove an entry before it expires.
+     */
+    void cancel(handle_type handle) noexcept
+    {
+        tt_axiom(handle < _nodes.size() and _nodes[handle].value);
+        unlink(handle);
+        free(handle);
+    }
+
+    [[nodiscard]] T &operator[](handle_type handle) noexcept
+    {
+        tt_axiom(handle < _nodes.size() and _nodes[handle].value);
+        return *_nodes[handle].value;
+    }
+
+    [[nodiscard]] time_point deadline(handle_type handle) const noexcept
+    {
+        tt_axiom(handle < _nodes.size() and _nodes[handle].value);
+        return _nodes[handle].deadline;
+    }
+
+    /** The time when `advance()` has work to do next.
+     *
+     * This is the earliest tick at which entries expire, or at which entries of a higher
+     * level need to be moved to a lower level.
+     *
+     * @return The time of the next tick with work, or `time_point::max()` when empty.
+     */
+    [[nodiscard]] time_point next_expiry() const noexcept
+    {
+        ttlet tick = next_tick();
+        return tick == std::numeric_limits<int64_t>::max() ? time_point::max() : to_time_point(tick);
+    }
+
+    /** Advance the wheel and expire the entries with a deadline at or before the given time.
+     *
+     * The function is called for each expired entry with the handle and a reference to the
+     * value. It returns a new deadline to re-arm the entry with the same handle, or an empty
+     * optional to remove the entry. The function must not insert or cancel entries.
+     *
+     * @param current_time The current time.
+     * @param func A function `std::optional<time_point>(handle_type, T &)`.
+     * @return The number of expired entries.
+     */
+    template<typename Func>
+    size_t advance(time_point current_time, Func &&func) noexcept
+    {
+        ttlet target = to_tick_floor(current_time);
+        auto count = size_t{0};
+
+        while (_current < target) {
+            ttlet tick = next_tick();
+            if (tick > target) {
+                _current = target;
+                break;
+            }
+
+            _current = tick;
+            cascade();
+            count += expire(current_time, func);
+        }
+        return count;
+    }
+
+    /** Move all entries so that their time until expiry is kept.
+     * This is used when the clock jumped backwards.
+     *
+     * @param current_time The new current time.
+     */
+    void reset(time_point current_time) noexcept
+    {
+        ttlet old_time = now();
+
+        _current = to_tick_floor(current_time);
+        _heads.fill(invalid_handle);
+        _occupied.fill(0);
+
+        for (auto handle = handle_type{0}; handle != _nodes.size(); ++handle) {
+            auto &node = _nodes[handle];
+            if (node.value) {
+                node.deadline = current_time + std::max(node.deadline - old_time, duration::zero());
+                link(handle, _current + 1);
+            }
+        }
+    }
+
+    /** Remove all entries.
+     *
+     * @param func A function `void(T &)` called for each entry before it is removed.
+     */
+    template<typename Func>
+    void clear(Func &&func) noexcept
+    {
+        for (auto &node : _nodes) {
+            if (node.value) {
+                func(*node.value);
+            }
+        }
+
+        _nodes.clear();
+        _free = invalid_handle;
+        _heads.fill(invalid_handle);
+        _occupied.fill(0);
+        _size = 0;
+    }
+
+private:
+    struct node_type {
+        std::optional<T> value;
+        time_point deadline;
+        handle_type previous = invalid_handle;
+
+        /** The next node in the slot, or in the free list.
+         */
+        handle_type next = invalid_handle;
+
+        /** The index in `_heads` of the slot containing this node.
+         */
+        uint16_t slot = 0;
+    };
+
+    duration _tick;
+
+    /** The current tick, all entries of this tick and before have expired.
+     */
+    int64_t _current;
+
+    std::vector<node_type> _nodes;
+    handle_type _free = invalid_handle;
+    size_t _size = 0;
+
+    /** The first node of each slot, of each level.
+     */
+    std::array<handle_type, nr_levels * nr_slots> _heads;
+
+    /** A bit for each slot of each level that contains nodes.
+     */
+    std::array<uint64_t, nr_levels> _occupied = {};
+
+    static_assert(nr_slots == 64, "_occupied uses a 64 bit integer per level.");
+
+    [[nodiscard]] int64_t to_tick_floor(time_point tp) const noexcept
+    {
+        ttlet t = tp.time_since_epoch().count();
+        ttlet tick = _tick.count();
+        return t >= 0 ? t / tick : (t - tick + 1) / tick;
+    }
+
+    [[nodiscard]] int64_t to_tick_ceil(time_point tp) const noexcept
+    {
+        return to_tick_floor(tp - duration{1}) + 1;
+    }
+
+    [[nodiscard]] time_point to_time_point(int64_t tick) const noexcept
+    {
+        return time_point{duration{tick * _tick.count()}};
+    }
+
+    /** Add a node to the slot matching its deadline.
+     *
+     * @param handle The node to add.
+     * @param earliest The earliest tick for the node; a node which is already due is placed here.
+     */
+    void link(handle_type handle, int64_t earliest) noexcept
+    {
+        auto &node = _nodes[handle];
+
+        // A far entry is placed at the end of the range.
+        ttlet tick = std::clamp(to_tick_ceil(node.deadline), earliest, _current + range - 1);
+        ttlet delta = static_cast<uint64_t>(tick - _current);
+
+        ttlet level = delta < nr_slots ? 0 : (std::bit_width(delta) - 1) / slot_bits;
+        ttlet slot = static_cast<int>((tick >> (level * slot_bits)) & (nr_slots - 1));
+        ttlet index = level * nr_slots + slot;
+
+        node.slot = static_cast<uint16_t>(index);
+        node.previous = invalid_handle;
+        node.next = _heads[index];
+        if (node.next != invalid_handle) {
+            _nodes[node.next].previous = handle;
+        }
+        _heads[index] = handle;
+        _occupied[level] |= uint64_t{1} << slot;
+    }
+
+    void unlink(handle_type handle) noexcept
+    {
+        auto &node = _nodes[handle];
+
+        if (node.previous != invalid_handle) {
+            _nodes[node.previous].next = node.next;
+        } else {
+            _heads[node.slot] = node.next;
+            if (node.next == invalid_handle) {
+                _occupied[node.slot / nr_slots] &= ~(uint64_t{1} << (node.slot % nr_slots));
+            }
+        }
+
+        if (node.next != invalid_handle) {
+            _nodes[node.next].previous = node.previous;
+        }
+    }
+
+    void free(handle_type handle) noexcept
+    {
+        auto &node = _nodes[handle];
+        node.value.reset();
+        node.next = _free;
+        _free = handle;
+        --_size;
+    }
+
+    /** Take all the nodes from a slot.
+     * @return The first node of the list of nodes taken.
+     */
+    [[nodiscard]] handle_type take_slot(int level, int slot) noexcept
+    {
+        ttlet index = level * nr_slots + slot;
+        _occupied[level] &= ~(uint64_t{1} << slot);
+        return std::exchange(_heads[index], invalid_handle);
+    }
+
+    /** The next tick at which a slot needs processing.
+     */
+    [[nodiscard]] int64_t next_tick() const noexcept
+    {
+        auto r = std::numeric_limits<int64_t>::max();
+
+        for (auto level = 0; level != nr_levels; ++level) {
+            if (_occupied[level] == 0) {
+                continue;
+            }
+
+            // Search the slots of this level, starting at the one after the current slot.
+            ttlet shift = level * slot_bits;
+            ttlet current_slot = _current >> shift;
+            ttlet rotation = static_cast<int>((current_slot + 1) & (nr_slots - 1));
+            ttlet offset = std::countr_zero(std::rotr(_occupied[level], rotation));
+
+            r = std::min(r, (current_slot + 1 + offset) << shift);
+        }
+        return r;
+    }
+
+    /** Move the nodes of higher level slots that start at the current tick to lower levels.
+     * Higher levels are moved first, as their nodes may move into a lower level slot which starts now.
+     */
+    void cascade() noexcept
+    {
+        for (auto level = nr_levels - 1; level != 0; --level) {
+            ttlet shift = level * slot_bits;
+            if ((_current & ((int64_t{1} << shift) - 1)) != 0) {
+                continue;
+            }
+
+            auto handle = take_slot(level, static_cast<int>((_current >> shift) & (nr_slots - 1)));
+            while (handle != invalid_handle) {
+                link(std::exchange(handle, _nodes[handle].next), _current);
+            }
+        }
+    }
+
+    /** Expire the nodes in the level 0 slot of the current tick.
+     */
+    template<typename Func>
+    size_t expire(time_point current_time, Func &func) noexcept
+    {
+        auto count = size_t{0};
+
+        auto handle = take_slot(0, static_cast<int>(_current & (nr_slots - 1)));
+        while (handle != invalid_handle) {
+            ttlet next = _nodes[handle].next;
+
+            auto &node = _nodes[handle];
+            if (to_tick_ceil(node.deadline) > _current) {
+                // A far entry that was placed at the end of the range.
+                link(handle, _current + 1);
+
+            } else if (ttlet new_deadline = func(handle, *node.value)) {
+                node.deadline = std::max(*new_deadline, current_time);
+                link(handle, _current + 1);
+                ++count;
+
+            } else {
+                free(handle);
+                ++count;
+            }
+
+            handle = next;
+        }
+        return count;
+    }
+};
+
+} // namespace tt
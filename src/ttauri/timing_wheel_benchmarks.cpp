@@ -0,0 +1,100 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/timing_wheel.hpp"
+#include "ttauri/hires_utc_clock.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace tt;
+using namespace std::literals;
+
+using time_point = hires_utc_clock::time_point;
+
+static constexpr int nr_timers = 10'000;
+
+/** Deadlines of timers spread over the next 10 seconds.
+ */
+[[nodiscard]] static std::vector<time_point> timing_wheel_deadlines()
+{
+    auto engine = std::mt19937_64{42};
+    auto distribution = std::uniform_int_distribution<int64_t>{1, 10'000'000'000};
+
+    auto r = std::vector<time_point>{};
+    for (auto i = 0; i != nr_timers; ++i) {
+        r.push_back(time_point{std::chrono::nanoseconds{distribution(engine)}});
+    }
+    return r;
+}
+
+/** Insert and cancel 10k timers.
+ */
+static void timing_wheel_insert_cancel(benchmark::State &state)
+{
+    ttlet deadlines = timing_wheel_deadlines();
+    auto wheel = timing_wheel<int, hires_utc_clock>(time_point{}, 1ms);
+    auto handles = std::vector<timing_wheel<int, hires_utc_clock>::handle_type>(nr_timers);
+
+    for (auto _ : state) {
+        for (auto i = 0; i != nr_timers; ++i) {
+            handles[i] = wheel.insert(deadlines[i], i);
+        }
+        for (ttlet handle : handles) {
+            wheel.cancel(handle);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * nr_timers);
+}
+BENCHMARK(timing_wheel_insert_cancel);
+
+/** Insert 10k timers and wake up at each expiry until all timers have expired.
+ * The argument is the tick in microseconds, timers within a tick are expired together.
+ */
+static void timing_wheel_expire(benchmark::State &state)
+{
+    ttlet deadlines = timing_wheel_deadlines();
+    ttlet tick = std::chrono::microseconds{state.range(0)};
+    auto nr_wakeups = int64_t{0};
+
+    for (auto _ : state) {
+        auto wheel = timing_wheel<int, hires_utc_clock>(time_point{}, tick);
+        for (auto i = 0; i != nr_timers; ++i) {
+            wheel.insert(deadlines[i], i);
+        }
+
+        while (not wheel.empty()) {
+            wheel.advance(wheel.next_expiry(), [](auto, int &value) -> std::optional<time_point> {
+                benchmark::DoNotOptimize(value);
+                return {};
+            });
+            ++nr_wakeups;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * nr_timers);
+    state.counters["wakeups"] = benchmark::Counter(static_cast<double>(nr_wakeups), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(timing_wheel_expire)->Arg(1)->Arg(1000)->Arg(10'000);
+
+/** The same as timing_wheel_expire using a list of timers that is scanned on each wakeup.
+ */
+static void timing_wheel_vector_scan(benchmark::State &state)
+{
+    ttlet deadlines = timing_wheel_deadlines();
+
+    for (auto _ : state) {
+        auto timers = deadlines;
+        while (not timers.empty()) {
+            ttlet next = *std::min_element(timers.begin(), timers.end());
+            std::erase_if(timers, [next](ttlet deadline) {
+                return deadline <= next;
+            });
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * nr_timers);
+}
+BENCHMARK(timing_wheel_vector_scan);
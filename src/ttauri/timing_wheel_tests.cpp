@@ -0,0 +1,151 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/timing_wheel.hpp"
+#include "ttauri/hires_utc_clock.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+using namespace std::literals;
+using namespace tt;
+
+using wheel_type = timing_wheel<int, hires_utc_clock>;
+
+static hires_utc_clock::time_point at(hires_utc_clock::duration d)
+{
+    return hires_utc_clock::time_point{d};
+}
+
+TEST(timing_wheel, insert_advance)
+{
+    auto wheel = wheel_type(at(0ms), 1ms);
+    wheel.insert(at(30ms), 3);
+    wheel.insert(at(10ms), 1);
+    wheel.insert(at(20ms), 2);
+    ASSERT_EQ(wheel.size(), 3);
+
+    auto expired = vector<int>{};
+    auto expire = [&](auto, int &value) -> optional<hires_utc_clock::time_point> {
+        expired.push_back(value);
+        return {};
+    };
+
+    ASSERT_EQ(wheel.advance(at(9ms), expire), 0);
+    ASSERT_TRUE(expired.empty());
+
+    ASSERT_EQ(wheel.advance(at(20ms), expire), 2);
+    ASSERT_EQ(expired, (vector<int>{1, 2}));
+
+    ASSERT_EQ(wheel.advance(at(100ms), expire), 1);
+    ASSERT_EQ(expired, (vector<int>{1, 2, 3}));
+    ASSERT_TRUE(wheel.empty());
+}
+
+TEST(timing_wheel, coalescing)
+{
+    auto wheel = wheel_type(at(0ms), 10ms);
+    wheel.insert(at(11ms), 1);
+    wheel.insert(at(15ms), 2);
+    wheel.insert(at(20ms), 3);
+    wheel.insert(at(21ms), 4);
+
+    // Deadlines are rounded up to the next tick.
+    ASSERT_EQ(wheel.next_expiry(), at(20ms));
+
+    auto count = 0;
+    ASSERT_EQ(wheel.advance(at(20ms), [&](auto, int &) -> optional<hires_utc_clock::time_point> {
+        ++count;
+        return {};
+    }), 3);
+    ASSERT_EQ(count, 3);
+    ASSERT_EQ(wheel.next_expiry(), at(30ms));
+}
+
+TEST(timing_wheel, cancel)
+{
+    auto wheel = wheel_type(at(0ms), 1ms);
+    ttlet a = wheel.insert(at(10ms), 1);
+    ttlet b = wheel.insert(at(10ms), 2);
+    ttlet c = wheel.insert(at(5000ms), 3);
+
+    wheel.cancel(b);
+    wheel.cancel(c);
+    ASSERT_EQ(wheel.size(), 1);
+    ASSERT_EQ(wheel[a], 1);
+
+    // The cancelled handle is reused.
+    ttlet d = wheel.insert(at(20ms), 4);
+    ASSERT_TRUE(d == b or d == c);
+
+    auto expired = vector<int>{};
+    wheel.advance(at(10s), [&](auto, int &value) -> optional<hires_utc_clock::time_point> {
+        expired.push_back(value);
+        return {};
+    });
+    ASSERT_EQ(expired, (vector<int>{1, 4}));
+}
+
+TEST(timing_wheel, cascade)
+{
+    auto wheel = wheel_type(at(0ms), 1ms);
+
+    // Deadlines in each level, on and next to the boundaries of the slots, and beyond the range of the wheel.
+    auto deadlines = vector<int64_t>{1, 63, 64, 65, 100, 4095, 4096, 4097, 100'000, 262'144, 300'000, 16'777'215, 20'000'000};
+    for (ttlet deadline : deadlines) {
+        wheel.insert(at(deadline * 1ms), static_cast<int>(deadline));
+    }
+
+    auto expired = vector<int64_t>{};
+    auto now = int64_t{0};
+    while (not wheel.empty()) {
+        ttlet next = wheel.next_expiry();
+        ASSERT_GT(next, at(now * 1ms));
+        now = (next - at(0ms)) / 1ms;
+
+        wheel.advance(next, [&](auto, int &value) -> optional<hires_utc_clock::time_point> {
+            // Each entry expires exactly at its deadline.
+            EXPECT_EQ(value, now);
+            expired.push_back(value);
+            return {};
+        });
+    }
+    ASSERT_EQ(expired, deadlines);
+}
+
+TEST(timing_wheel, rearm)
+{
+    auto wheel = wheel_type(at(0ms), 1ms);
+    ttlet handle = wheel.insert(at(10ms), 0);
+
+    for (auto i = 1; i <= 5; ++i) {
+        ttlet count = wheel.advance(at(i * 10ms), [&](auto h, int &value) -> optional<hires_utc_clock::time_point> {
+            EXPECT_EQ(h, handle);
+            ++value;
+            return at((i + 1) * 10ms);
+        });
+        ASSERT_EQ(count, 1);
+    }
+    ASSERT_EQ(wheel[handle], 5);
+    ASSERT_EQ(wheel.deadline(handle), at(60ms));
+}
+
+TEST(timing_wheel, reset)
+{
+    auto wheel = wheel_type(at(1000ms), 1ms);
+    wheel.insert(at(1010ms), 1);
+
+    // The clock jumped backwards, the entry keeps its remaining time.
+    wheel.reset(at(500ms));
+    ASSERT_EQ(wheel.next_expiry(), at(510ms));
+
+    auto count = 0;
+    wheel.advance(at(510ms), [&](auto, int &) -> optional<hires_utc_clock::time_point> {
+        ++count;
+        return {};
+    });
+    ASSERT_EQ(count, 1);
+}
@@ -969,8 +969,8 @@ struct tokenizer {
 
     /*! Parse a token.
     */
-    [[nodiscard]] token_t getNextToken() {
-        auto token = token_t{};
+    [[nodiscard]] token_t getNextToken(std::pmr::memory_resource *resource) {
+        auto token = token_t{resource};
 
         auto transition = tokenizer_transition_t{};
         while (index != end) {
@@ -1020,12 +1020,12 @@ struct tokenizer {
 
     /*! Parse all tokens.
     */
-    [[nodiscard]] std::vector<token_t> getTokens() noexcept {
-        std::vector<token_t> r;
+    [[nodiscard]] token_vector getTokens(std::pmr::memory_resource *resource) noexcept {
+        auto r = token_vector{resource};
 
         tokenizer_name_t token_name;
         do {
-            ttlet token = getNextToken();
+            auto token = getNextToken(resource);
             token_name = token.name;
             r.push_back(std::move(token));
         } while (token_name != tokenizer_name_t::End);
@@ -1034,14 +1034,17 @@ struct tokenizer {
     }
 };
 
-[[nodiscard]] std::vector<token_t> parseTokens(std::string_view::const_iterator first, std::string_view::const_iterator last) noexcept
+[[nodiscard]] token_vector parseTokens(
+    std::string_view::const_iterator first,
+    std::string_view::const_iterator last,
+    std::pmr::memory_resource *resource) noexcept
 {
-    return tokenizer(first, last).getTokens();
+    return tokenizer(first, last).getTokens(resource);
 }
 
-[[nodiscard]] std::vector<token_t> parseTokens(std::string_view text) noexcept
+[[nodiscard]] token_vector parseTokens(std::string_view text, std::pmr::memory_resource *resource) noexcept
 {
-    return parseTokens(text.cbegin(), text.cend());
+    return parseTokens(text.cbegin(), text.cend(), resource);
 }
 
 }
@@ -14,6 +14,7 @@
 #include "charconv.hpp"
 #include <chrono>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <charconv>
@@ -73,15 +74,27 @@ struct std::formatter<tt::tokenizer_name_t, CharT> : std::formatter<char const *
 
 struct token_t {
     tokenizer_name_t name;
-    std::string value;
+
+    /** The text of the token.
+     * Allocated from the memory resource passed to `parseTokens()`.
+     */
+    std::pmr::string value;
     parse_location location;
     bool is_binary;
     int precedence;
 
     token_t() noexcept : name(tokenizer_name_t::NotAssigned), value(), location(), is_binary(false), precedence(0) {}
 
-    token_t(tokenizer_name_t name, std::string value) noexcept :
-        name(name), value(std::move(value)), location(), is_binary(false), precedence(0)
+    explicit token_t(std::pmr::memory_resource *resource) noexcept :
+        name(tokenizer_name_t::NotAssigned), value(resource), location(), is_binary(false), precedence(0)
+    {
+    }
+
+    token_t(
+        tokenizer_name_t name,
+        std::string_view value,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept :
+        name(name), value(value, resource), location(), is_binary(false), precedence(0)
     {
     }
 
@@ -132,7 +145,7 @@ struct token_t {
     explicit operator long double() const
     {
         try {
-            return std::stold(value);
+            return std::stold(std::string{value});
 
         } catch (...) {
             throw parse_error("Could not convert token {} to long double", *this);
@@ -142,7 +155,7 @@ struct token_t {
     explicit operator double() const
     {
         try {
-            return std::stod(value);
+            return std::stod(std::string{value});
 
         } catch (...) {
             throw parse_error("Could not convert token {} to double", *this);
@@ -152,7 +165,7 @@ struct token_t {
     explicit operator float() const
     {
         try {
-            return std::stof(value);
+            return std::stof(std::string{value});
 
         } catch (...) {
             throw parse_error("Could not convert token {} to float", *this);
@@ -172,7 +185,7 @@ struct token_t {
 
     explicit operator std::string() const noexcept
     {
-        return value;
+        return std::string{value};
     }
 
     explicit operator std::u8string() const noexcept
@@ -240,7 +253,7 @@ struct token_t {
     }
 };
 
-using token_vector = std::vector<tt::token_t>;
+using token_vector = std::pmr::vector<tt::token_t>;
 using token_iterator = typename token_vector::iterator;
 
 template<typename T>
@@ -280,11 +293,16 @@ struct parse_result {
  *    - white space (skip)
  *
  * Errors will be returned as tokens which will point back into the text.
+ *
+ * @param resource The memory resource to allocate the list of tokens and their text from.
  */
-[[nodiscard]] std::vector<token_t> parseTokens(std::string_view text) noexcept;
+[[nodiscard]] token_vector
+parseTokens(std::string_view text, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept;
 
-[[nodiscard]] std::vector<token_t>
-parseTokens(std::string_view::const_iterator first, std::string_view::const_iterator last) noexcept;
+[[nodiscard]] token_vector parseTokens(
+    std::string_view::const_iterator first,
+    std::string_view::const_iterator last,
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept;
 
 } // namespace tt
 
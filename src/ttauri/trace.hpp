@@ -11,9 +11,13 @@
 #include "tagged_map.hpp"
 #include "fixed_string.hpp"
 #include "statistics.hpp"
+#include "latency_histogram.hpp"
+#include "trace_recorder.hpp"
 #include <format>
 #include <atomic>
 #include <array>
+#include <iterator>
+#include <string>
 #include <utility>
 #include <ostream>
 #include <typeinfo>
@@ -23,8 +27,6 @@
 
 namespace tt {
 
-constexpr int MAX_NR_TRACES = 1024;
-
 inline std::atomic<int64_t> trace_id = 0;
 
 struct trace_stack_type {
@@ -154,6 +156,10 @@ private:
     std::atomic<long long> peak_duration = {};
     std::atomic<long long> version = 0;
 
+    /*! The durations since the last read, outside of the count/version protocol.
+     */
+    latency_histogram histogram;
+
     // Variables used by logger.
     long long prev_count = 0;
     std::chrono::nanoseconds prev_duration = {};
@@ -178,6 +184,7 @@ public:
 
         version.store(current_count + 1, std::memory_order::release);
 
+        histogram.add(d);
         return current_count == 0;
     }
 
@@ -188,8 +195,33 @@ public:
         std::chrono::nanoseconds duration;
         std::chrono::nanoseconds last_duration;
         std::chrono::nanoseconds peak_duration;
+
+        /*! The durations of the traces since the last read.
+         */
+        latency_histogram::snapshot_type last_histogram;
     };
 
+    struct total_result {
+        long long count;
+        std::chrono::nanoseconds duration;
+    };
+
+    /*! Read the totals since the start of the application.
+     * Unlike `read()` this does not reset the peak and histogram,
+     * so it may be called from any thread.
+     */
+    [[nodiscard]] total_result read_total() const noexcept
+    {
+        total_result r;
+        do {
+            r.count = count.load(std::memory_order::acquire);
+            r.duration = std::chrono::nanoseconds{duration.load(std::memory_order::relaxed)};
+
+            std::atomic_thread_fence(std::memory_order::release);
+        } while (r.count != version.load(std::memory_order::relaxed));
+        return r;
+    }
+
     read_result read()
     {
         read_result r;
@@ -208,6 +240,8 @@ public:
             std::atomic_thread_fence(std::memory_order::release);
         } while (r.count != version.load(std::memory_order::relaxed));
 
+        r.last_histogram = histogram.take();
+
         r.last_count = r.count - prev_count;
         r.last_duration = r.duration - prev_duration;
 
@@ -220,7 +254,7 @@ public:
 template<basic_fixed_string Tag>
 inline trace_statistics_type trace_statistics;
 
-inline wfree_unordered_map<std::string, trace_statistics_type *, MAX_NR_TRACES> trace_statistics_map;
+inline wfree_hash_map<std::string, trace_statistics_type *> trace_statistics_map;
 
 template<basic_fixed_string Tag, basic_fixed_string... InfoTags>
 class trace final {
@@ -237,6 +271,49 @@ class trace final {
         statistics_start();
     }
 
+    /** Append the string representation of an info value to the arguments of an event.
+     * Numbers are formatted directly into the arguments, so that the reused capacity of the
+     * event's buffer avoids allocating a temporary string for each span.
+     */
+    static void append_info(std::string &args, sdatum const &value) noexcept
+    {
+        if (value.is_integer()) {
+            std::format_to(std::back_inserter(args), "{}", static_cast<int64_t>(value));
+
+        } else if (value.is_float()) {
+            ttlet first = args.size();
+            std::format_to(std::back_inserter(args), "{:g}", static_cast<double>(value));
+            if (args.find('.', first) == std::string::npos) {
+                args += ".0";
+            }
+
+        } else {
+            args += static_cast<std::string>(value);
+        }
+    }
+
+    tt_no_inline void record_event(std::chrono::nanoseconds duration) noexcept
+    {
+        auto &buffer = get_trace_event_buffer();
+        auto *event = buffer.prepare();
+        if (event == nullptr) {
+            increment_counter<"trace_event_drop">();
+            return;
+        }
+
+        event->tag = Tag.c_str();
+        event->start = data.time_stamp;
+        event->duration = duration;
+        event->args.clear();
+        for (size_t i = 0; i < data.info.size(); i++) {
+            event->args += data.info.get_tag(i);
+            event->args += '\0';
+            append_info(event->args, data.info[i]);
+            event->args += '\0';
+        }
+        buffer.commit();
+    }
+
 public:
     /*! The constructor will make the start of a trace.
      *
@@ -254,10 +331,15 @@ public:
     {
         ttlet end_time_stamp = time_stamp_count::now();
 
-        if (trace_statistics<Tag>.write(end_time_stamp.time_since_epoch() - data.time_stamp.time_since_epoch())) {
+        ttlet duration = end_time_stamp.time_since_epoch() - data.time_stamp.time_since_epoch();
+        if (trace_statistics<Tag>.write(duration)) {
             [[unlikely]] add_to_map();
         }
 
+        if (trace_recording.load(std::memory_order::relaxed)) {
+            [[unlikely]] record_event(duration);
+        }
+
         ttlet[id, is_recording] = stack->pop(data.parent_id);
 
         // Send the log to the log thread.
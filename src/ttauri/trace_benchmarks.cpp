@@ -0,0 +1,50 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/trace.hpp"
+#include "ttauri/latency_histogram.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+using namespace tt;
+
+/** The overhead of a trace without info-tags, including updating its statistics and histogram.
+ */
+static void trace_overhead(benchmark::State &state)
+{
+    for (auto _ : state) {
+        auto t = trace<"trace_benchmark">{};
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** The overhead of a trace with an info-tag.
+ */
+static void trace_overhead_with_info(benchmark::State &state)
+{
+    auto i = 0;
+    for (auto _ : state) {
+        auto t = trace<"trace_benchmark_info", "index">{};
+        t.set<"index">(i++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** The cost of adding a duration to a histogram on its own.
+ */
+static void latency_histogram_add(benchmark::State &state)
+{
+    static latency_histogram histogram;
+
+    auto duration = std::chrono::nanoseconds{0};
+    for (auto _ : state) {
+        histogram.add(duration);
+        duration += std::chrono::nanoseconds{37};
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(trace_overhead)->ThreadRange(1, 8);
+BENCHMARK(trace_overhead_with_info);
+BENCHMARK(latency_histogram_add)->ThreadRange(1, 8);
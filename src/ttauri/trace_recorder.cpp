@@ -0,0 +1,229 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "trace_recorder.hpp"
+#include "hires_utc_clock.hpp"
+#include "counters.hpp"
+#include "file.hpp"
+#include "URL.hpp"
+#include <algorithm>
+#include <format>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tt {
+
+/** The buffers of all the threads that have recorded traces.
+ */
+static std::mutex trace_event_buffers_mutex;
+static std::vector<std::shared_ptr<trace_event_buffer>> trace_event_buffers;
+
+/** Protects the recorder thread against concurrent start and stop.
+ */
+static std::mutex trace_recorder_mutex;
+static std::jthread trace_recorder_thread;
+
+namespace detail {
+
+[[nodiscard]] tt_no_inline trace_event_buffer &make_trace_event_buffer() noexcept
+{
+    auto buffer = std::make_shared<trace_event_buffer>();
+
+    {
+        ttlet lock = std::scoped_lock(trace_event_buffers_mutex);
+        trace_event_buffers.push_back(buffer);
+    }
+
+    trace_event_buffer_of_thread.buffer = std::move(buffer);
+    return *trace_event_buffer_of_thread.buffer;
+}
+
+} // namespace detail
+
+static void trace_recorder_append_json_string(std::string &r, std::string_view str) noexcept
+{
+    r += '"';
+    for (ttlet c : str) {
+        switch (c) {
+        case '"': r += "\\\""; break;
+        case '\\': r += "\\\\"; break;
+        case '\n': r += "\\n"; break;
+        case '\r': r += "\\r"; break;
+        case '\t': r += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                r += std::format("\\u{:04x}", static_cast<int>(c));
+            } else {
+                r += c;
+            }
+        }
+    }
+    r += '"';
+}
+
+/** Append a time in nanoseconds as a number of microseconds, the unit of the trace event format.
+ */
+static void trace_recorder_append_microseconds(std::string &r, int64_t ns) noexcept
+{
+    r += std::format("{}.{:03}", ns / 1000, ns % 1000);
+}
+
+static void trace_recorder_append_event(std::string &r, trace_event const &event, thread_id tid) noexcept
+{
+    ttlet start = hires_utc_clock::make(event.start).time_since_epoch().count();
+
+    r += ",\n{\"name\":";
+    trace_recorder_append_json_string(r, event.tag);
+    r += ",\"cat\":\"trace\",\"ph\":\"X\",\"ts\":";
+    trace_recorder_append_microseconds(r, start);
+    r += ",\"dur\":";
+    trace_recorder_append_microseconds(r, event.duration.count());
+    r += std::format(",\"pid\":0,\"tid\":{},\"args\":{{", tid);
+
+    auto first = true;
+    for (auto i = size_t{0}; i < event.args.size();) {
+        ttlet name_end = event.args.find('\0', i);
+        ttlet value_end = event.args.find('\0', name_end + 1);
+
+        if (not std::exchange(first, false)) {
+            r += ',';
+        }
+        trace_recorder_append_json_string(r, std::string_view{event.args}.substr(i, name_end - i));
+        r += ':';
+        trace_recorder_append_json_string(r, std::string_view{event.args}.substr(name_end + 1, value_end - name_end - 1));
+
+        i = value_end + 1;
+    }
+    r += "}}";
+}
+
+static void trace_recorder_append_thread_name(std::string &r, thread_id tid) noexcept
+{
+    ttlet name = get_thread_name(tid);
+    if (name.empty()) {
+        return;
+    }
+
+    r += std::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":", tid);
+    trace_recorder_append_json_string(r, name);
+    r += "}}";
+}
+
+/** Take the events from all the buffers.
+ *
+ * @param r The JSON text to append the events to.
+ * @param named_threads The threads whose name was already written.
+ * @return The number of events taken.
+ */
+static size_t trace_recorder_take_events(std::string &r, std::unordered_set<thread_id> &named_threads) noexcept
+{
+    auto buffers = std::vector<std::shared_ptr<trace_event_buffer>>{};
+    {
+        ttlet lock = std::scoped_lock(trace_event_buffers_mutex);
+        buffers = trace_event_buffers;
+    }
+
+    auto count = size_t{0};
+    for (ttlet &buffer : buffers) {
+        ttlet tid = buffer->owner();
+        ttlet closed = buffer->closed.load(std::memory_order::acquire);
+
+        count += buffer->take_all([&](trace_event const &event) {
+            if (named_threads.insert(tid).second) {
+                trace_recorder_append_thread_name(r, tid);
+            }
+            trace_recorder_append_event(r, event, tid);
+        });
+
+        if (closed) {
+            // The thread has exited and its last events have been taken.
+            named_threads.erase(tid);
+
+            ttlet lock = std::scoped_lock(trace_event_buffers_mutex);
+            std::erase(trace_event_buffers, buffer);
+        }
+    }
+    return count;
+}
+
+static void trace_recorder_loop(std::stop_token stop_token, std::unique_ptr<file> output) noexcept
+{
+    using namespace std::chrono_literals;
+
+    set_thread_name("trace_recorder");
+
+    auto named_threads = std::unordered_set<thread_id>{};
+    auto text = std::string{};
+    while (true) {
+        // Events recorded before the stop was requested are taken below.
+        ttlet stop = stop_token.stop_requested();
+
+        text.clear();
+        ttlet count = trace_recorder_take_events(text, named_threads);
+        if (stop) {
+            text += "\n]\n";
+        }
+
+        try {
+            output->write(std::string_view{text});
+            increment_counter<"trace_event">(count);
+        } catch (...) {
+            increment_counter<"trace_event_drop">(count);
+        }
+
+        if (stop) {
+            break;
+        }
+        std::this_thread::sleep_for(100ms);
+    }
+
+    try {
+        output->close();
+    } catch (...) {
+    }
+}
+
+void trace_recorder_start(URL const &location)
+{
+    ttlet lock = std::scoped_lock(trace_recorder_mutex);
+
+    if (trace_recorder_thread.joinable()) {
+        return;
+    }
+
+    auto output = std::make_unique<file>(location, access_mode::truncate_or_create_for_write | access_mode::create_directories);
+
+    // The array is opened with a metadata event, so that every following event starts with a comma.
+    output->write(std::string_view{"[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"ttauri\"}}"});
+
+    // Discard events left over from an earlier recording.
+    {
+        ttlet buffers_lock = std::scoped_lock(trace_event_buffers_mutex);
+        for (ttlet &buffer : trace_event_buffers) {
+            buffer->take_all([](trace_event const &) {});
+        }
+    }
+
+    trace_recorder_thread = std::jthread(trace_recorder_loop, std::move(output));
+    trace_recording.store(true, std::memory_order::relaxed);
+}
+
+void trace_recorder_stop() noexcept
+{
+    ttlet lock = std::scoped_lock(trace_recorder_mutex);
+
+    if (not trace_recorder_thread.joinable()) {
+        return;
+    }
+
+    trace_recording.store(false, std::memory_order::relaxed);
+    trace_recorder_thread.request_stop();
+    trace_recorder_thread.join();
+    trace_recorder_thread = {};
+}
+
+} // namespace tt
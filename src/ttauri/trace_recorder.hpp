@@ -0,0 +1,157 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "architecture.hpp"
+#include "time_stamp_count.hpp"
+#include "thread.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace tt {
+class URL;
+
+/** A completed trace span.
+ */
+struct trace_event {
+    /** The tag of the trace, a string with static storage duration.
+     */
+    char const *tag;
+
+    time_stamp_count start;
+    std::chrono::nanoseconds duration;
+
+    /** The values of the info-tags of the trace as pairs of null-terminated name and value.
+     */
+    std::string args;
+};
+
+/** A single-producer, single-consumer ring buffer of trace events.
+ * Each thread that records traces owns one buffer, which is drained by the trace recorder thread.
+ */
+class trace_event_buffer {
+public:
+    static constexpr size_t capacity = 4096;
+
+    trace_event_buffer() noexcept : _thread_id(current_thread_id()) {}
+
+    [[nodiscard]] thread_id owner() const noexcept
+    {
+        return _thread_id;
+    }
+
+    /** Get the slot for the next event.
+     * Called by the owner thread.
+     *
+     * @return The event to fill in, or nullptr when the buffer is full.
+     */
+    [[nodiscard]] trace_event *prepare() noexcept
+    {
+        ttlet head = _head.load(std::memory_order::relaxed);
+        if (head - _tail.load(std::memory_order::acquire) == capacity) {
+            return nullptr;
+        }
+        return &_events[head % capacity];
+    }
+
+    /** Make the event returned by `prepare()` available to the recorder.
+     */
+    void commit() noexcept
+    {
+        _head.store(_head.load(std::memory_order::relaxed) + 1, std::memory_order::release);
+    }
+
+    /** Take all the events from the buffer.
+     * Called by the trace recorder thread.
+     *
+     * @param operation The function to call with each `trace_event const &`.
+     * @return The number of events taken.
+     */
+    template<typename Operation>
+    size_t take_all(Operation const &operation) noexcept
+    {
+        ttlet head = _head.load(std::memory_order::acquire);
+        auto tail = _tail.load(std::memory_order::relaxed);
+        ttlet count = head - tail;
+        for (; tail != head; ++tail) {
+            operation(_events[tail % capacity]);
+        }
+        _tail.store(tail, std::memory_order::release);
+        return count;
+    }
+
+    /** Set by the owner thread when it exits.
+     */
+    std::atomic<bool> closed = false;
+
+private:
+    std::array<trace_event, capacity> _events;
+    thread_id _thread_id;
+
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> _head = 0;
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> _tail = 0;
+};
+
+/** True while completed traces are being recorded by `trace_recorder_start()`.
+ */
+inline std::atomic<bool> trace_recording = false;
+
+namespace detail {
+
+/** Get the trace event buffer of the current thread.
+ * The buffer is created and registered with the trace recorder on first use.
+ */
+[[nodiscard]] tt_no_inline trace_event_buffer &make_trace_event_buffer() noexcept;
+
+struct trace_event_buffer_owner {
+    std::shared_ptr<trace_event_buffer> buffer;
+
+    ~trace_event_buffer_owner()
+    {
+        if (buffer) {
+            buffer->closed.store(true, std::memory_order::release);
+        }
+    }
+};
+
+inline thread_local trace_event_buffer_owner trace_event_buffer_of_thread;
+
+} // namespace detail
+
+/** Get the trace event buffer of the current thread.
+ */
+[[nodiscard]] inline trace_event_buffer &get_trace_event_buffer() noexcept
+{
+    if (auto *buffer = detail::trace_event_buffer_of_thread.buffer.get()) {
+        [[likely]] return *buffer;
+    }
+    return detail::make_trace_event_buffer();
+}
+
+/** Start recording each completed trace.
+ *
+ * The traces are written as Chrome Trace Event JSON, which can be viewed with
+ * chrome://tracing or https://ui.perfetto.dev. Each trace becomes a complete-event
+ * with the info-tags of the trace as arguments, threads are named after `set_thread_name()`.
+ *
+ * The following counters are maintained:
+ *  - "trace_event": The number of events written.
+ *  - "trace_event_drop": The number of events dropped because a thread's buffer was full.
+ *
+ * @param location The file to write the events to, an existing file is overwritten.
+ * @throw io_error When the file could not be created.
+ */
+void trace_recorder_start(URL const &location);
+
+/** Stop recording traces.
+ * The events that were recorded are written to the file before it is closed.
+ */
+void trace_recorder_stop() noexcept;
+
+} // namespace tt
@@ -0,0 +1,70 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/trace_recorder.hpp"
+#include "ttauri/trace.hpp"
+#include "ttauri/thread.hpp"
+#include "ttauri/file_view.hpp"
+#include "ttauri/URL.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace tt;
+
+[[nodiscard]] static std::string read_text(URL const &location)
+{
+    ttlet view = file_view(location);
+    ttlet bytes = view.bytes();
+    return std::string(reinterpret_cast<char const *>(bytes.data()), bytes.size());
+}
+
+[[nodiscard]] static size_t count_occurrences(std::string const &haystack, std::string const &needle)
+{
+    auto r = size_t{0};
+    for (auto i = haystack.find(needle); i != std::string::npos; i = haystack.find(needle, i + 1)) {
+        ++r;
+    }
+    return r;
+}
+
+TEST(trace_recorder, record)
+{
+    ttlet location = URL("file:trace_recorder_test.json");
+
+    trace_recorder_start(location);
+    {
+        auto t = trace<"recorder_main", "value">{};
+        t.set<"value">(42);
+    }
+
+    auto thread = std::jthread([] {
+        set_thread_name("recorder_thread");
+        for (auto i = 0; i != 10; ++i) {
+            auto t = trace<"recorder_thread", "value">{};
+            t.set<"value">("a\"b");
+        }
+    });
+    thread.join();
+    trace_recorder_stop();
+
+    // A trace after stopping is not recorded.
+    {
+        auto t = trace<"recorder_main", "value">{};
+    }
+
+    ttlet text = read_text(location);
+    ASSERT_TRUE(text.starts_with("["));
+    ASSERT_TRUE(text.ends_with("]\n"));
+
+    ASSERT_EQ(count_occurrences(text, "{\"name\":\"recorder_main\",\"cat\":\"trace\",\"ph\":\"X\""), 1);
+    ASSERT_EQ(count_occurrences(text, "\"args\":{\"value\":\"42\"}"), 1);
+
+    ASSERT_EQ(count_occurrences(text, "{\"name\":\"recorder_thread\",\"cat\":\"trace\",\"ph\":\"X\""), 10);
+    ASSERT_EQ(count_occurrences(text, "\"args\":{\"value\":\"a\\\"b\"}"), 10);
+
+    ASSERT_EQ(count_occurrences(text, "\"args\":{\"name\":\"recorder_thread\"}"), 1);
+}
@@ -8,19 +8,145 @@
 #include "thread.hpp"
 #include "assert.hpp"
 #include "dead_lock_detector.hpp"
+#include "fixed_string.hpp"
+#include "wfree_hash_map.hpp"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <string>
 #include <thread>
 
+#if TT_PROCESSOR == TT_CPU_X64
+#include <immintrin.h>
+#endif
+
 namespace tt {
 
+/** Contention statistics of a group of mutexes.
+ *
+ * Mutexes are assigned to a group when constructed, mutexes without a group are
+ * counted in the "unfair_mutex" group. A group is added to the
+ * `unfair_mutex_statistics_map` the first time one of its mutexes is contended,
+ * so that it is included in the statistics output.
+ */
+struct unfair_mutex_statistics {
+    struct read_result {
+        int64_t count;
+        int64_t last_count;
+        std::chrono::nanoseconds duration;
+        std::chrono::nanoseconds last_duration;
+    };
+
+    char const *name;
+
+    /** The number of times a lock could not be acquired immediately.
+     */
+    std::atomic<int64_t> count = 0;
+
+    /** The total time in nanoseconds spent waiting for contended locks.
+     */
+    std::atomic<int64_t> duration = 0;
+
+    std::atomic<bool> in_map = false;
+
+    /** The values at the previous `read()`, only used by the statistics thread.
+     */
+    int64_t previous_count = 0;
+    int64_t previous_duration = 0;
+
+    constexpr explicit unfair_mutex_statistics(char const *name) noexcept : name(name) {}
+
+    unfair_mutex_statistics(unfair_mutex_statistics const &) = delete;
+    unfair_mutex_statistics(unfair_mutex_statistics &&) = delete;
+    unfair_mutex_statistics &operator=(unfair_mutex_statistics const &) = delete;
+    unfair_mutex_statistics &operator=(unfair_mutex_statistics &&) = delete;
+
+    /** Count a contended lock.
+     *
+     * @param wait_duration The time it took to acquire the lock.
+     */
+    void add(std::chrono::nanoseconds wait_duration) noexcept
+    {
+        count.fetch_add(1, std::memory_order::relaxed);
+        duration.fetch_add(wait_duration.count(), std::memory_order::relaxed);
+
+        if (not in_map.load(std::memory_order::relaxed)) {
+            [[unlikely]] add_to_map();
+        }
+    }
+
+    /** Read the totals and the change since the previous read.
+     * Should only be called by the statistics thread.
+     */
+    read_result read() noexcept
+    {
+        ttlet current_count = count.load(std::memory_order::relaxed);
+        ttlet current_duration = duration.load(std::memory_order::relaxed);
+
+        return {
+            current_count,
+            current_count - std::exchange(previous_count, current_count),
+            std::chrono::nanoseconds{current_duration},
+            std::chrono::nanoseconds{current_duration - std::exchange(previous_duration, current_duration)}};
+    }
+
+private:
+    tt_no_inline void add_to_map() noexcept;
+};
+
+inline wfree_hash_map<std::string, unfair_mutex_statistics *> unfair_mutex_statistics_map;
+
+inline void unfair_mutex_statistics::add_to_map() noexcept
+{
+    // Mutexes of a group may be contended concurrently, only the first inserts the group.
+    if (not in_map.exchange(true, std::memory_order::relaxed)) {
+        unfair_mutex_statistics_map.insert(name, this);
+    }
+}
+
+/** The contention statistics of a named group of mutexes.
+ *
+ * ```
+ * unfair_mutex logger_mutex{unfair_mutex_statistics_of<"logger">};
+ * ```
+ */
+template<basic_fixed_string Name>
+inline unfair_mutex_statistics unfair_mutex_statistics_of{Name.data()};
+
+namespace detail {
+
+inline unfair_mutex_statistics unfair_mutex_default_statistics{"unfair_mutex"};
+
+#if TT_OPERATING_SYSTEM == TT_OS_LINUX
+/** Sleep while the value is equal to expected, using FUTEX_WAIT_PRIVATE.
+ * May return spuriously.
+ */
+void unfair_mutex_futex_wait(std::atomic<uint32_t> &value, uint32_t expected) noexcept;
+
+/** Wake one thread sleeping on the value, using FUTEX_WAKE_PRIVATE.
+ */
+void unfair_mutex_futex_wake_one(std::atomic<uint32_t> &value) noexcept;
+#endif
+
+} // namespace detail
+
 /** An unfair mutex
  * This is a fast implementation of a mutex which does not fairly arbitrate
  * between multiple blocking threads. Due to the unfairness it is possible
  * that blocking threads will be completely starved.
  * 
  * This mutex however does block on a operating system's futex/unfair_mutex
- * primitives and therefor thread priority are properly handled.
+ * primitives and therefor thread priority are properly handled. On Linux the
+ * futex is used directly, on other operating systems through `std::atomic::wait()`.
+ *
+ * Before blocking, a contended lock spins for a short time, as most critical sections
+ * are only a few instructions long. The number of spins adapts to the number of spins
+ * that were needed to acquire the lock during earlier contention, which is a measure
+ * of how long the lock is held.
+ *
+ * The number of contended locks and the time spent waiting on them are counted in
+ * a `unfair_mutex_statistics` group, so that lock hot spots show up in the statistics.
  * 
  * On windows and Linux the compiler generally emits the following sequence
  * of instructions:
@@ -33,6 +159,11 @@ template<bool UseDeadLockDetector>
 class unfair_mutex_impl {
 public:
     constexpr unfair_mutex_impl() noexcept {}
+
+    /** Construct a mutex which records its contention in the given statistics group.
+     */
+    constexpr explicit unfair_mutex_impl(unfair_mutex_statistics &statistics) noexcept : _statistics(&statistics) {}
+
     unfair_mutex_impl(unfair_mutex_impl const &) = delete;
     unfair_mutex_impl(unfair_mutex_impl &&) = delete;
     unfair_mutex_impl &operator=(unfair_mutex_impl const &) = delete;
@@ -48,7 +179,7 @@ public:
     void lock() noexcept
     {
         if constexpr (UseDeadLockDetector) {
-            ttlet other = dead_lock_detector::lock(this);
+            [[maybe_unused]] ttlet other = dead_lock_detector::lock(this);
             tt_axiom(other != this, "Mutex already locked.");
             tt_axiom(other == nullptr, "Potential dead-lock.");
         }
@@ -73,7 +204,7 @@ public:
      */
     [[nodiscard]] bool try_lock() noexcept {
         if constexpr (UseDeadLockDetector) {
-            ttlet other = dead_lock_detector::lock(this);
+            [[maybe_unused]] ttlet other = dead_lock_detector::lock(this);
             tt_axiom(other != this, "Mutex already locked.");
             tt_axiom(other == nullptr, "Potential dead-lock.");
         }
@@ -86,7 +217,8 @@ public:
             tt_axiom(semaphore.load() <= 2);
 
             if constexpr (UseDeadLockDetector) {
-                tt_axiom(dead_lock_detector::unlock(this), "Unlocking mutex out of order.");
+                [[maybe_unused]] ttlet unlocked = dead_lock_detector::unlock(this);
+                tt_axiom(unlocked, "Unlocking mutex out of order.");
             }
 
             [[unlikely]] return false;
@@ -98,17 +230,18 @@ public:
 
     void unlock() noexcept {
         if constexpr (UseDeadLockDetector) {
-            tt_axiom(dead_lock_detector::unlock(this), "Unlocking mutex out of order.");
+            [[maybe_unused]] ttlet unlocked = dead_lock_detector::unlock(this);
+            tt_axiom(unlocked, "Unlocking mutex out of order.");
         }
 
         tt_axiom(semaphore.load() <= 2);
 
-        if (semaphore.fetch_sub(1, std::memory_order::relaxed) != 1) {
+        // The decrement must be a release, a fence after it would not order the writes
+        // of the critical section before a lock acquired by another thread while spinning.
+        if (semaphore.fetch_sub(1, std::memory_order::release) != 1) {
             [[unlikely]] semaphore.store(0, std::memory_order::release);
 
-            semaphore.notify_one();
-        } else {
-            atomic_thread_fence(std::memory_order::release);
+            wake_one();
         }
 
         tt_axiom(semaphore.load() <= 2);
@@ -123,28 +256,96 @@ private:
      */
     std::atomic<uint32_t> semaphore = 0;
 
+    /** Running average of the number of spins needed to acquire the lock when contended.
+     */
+    std::atomic<uint16_t> _spin_count = 0;
+
+    unfair_mutex_statistics *_statistics = &detail::unfair_mutex_default_statistics;
+
+    /** The maximum number of spins before blocking; about a few microseconds.
+     */
+    static constexpr int max_spin_count = 100;
+
+    static void pause() noexcept
+    {
+#if TT_PROCESSOR == TT_CPU_X64
+        _mm_pause();
+#endif
+    }
+
+    void wait(uint32_t expected) noexcept
+    {
+#if TT_OPERATING_SYSTEM == TT_OS_LINUX
+        detail::unfair_mutex_futex_wait(semaphore, expected);
+#else
+        semaphore.wait(expected);
+#endif
+    }
+
+    void wake_one() noexcept
+    {
+#if TT_OPERATING_SYSTEM == TT_OS_LINUX
+        detail::unfair_mutex_futex_wake_one(semaphore);
+#else
+        semaphore.notify_one();
+#endif
+    }
+
+    /** Try to acquire the lock by spinning.
+     *
+     * The lock is acquired as "locked, no waiters", which is safe even when other
+     * threads are blocked: the unlock that made the semaphore zero has woken one of
+     * them, and it will mark the semaphore as having waiters again.
+     */
+    [[nodiscard]] bool lock_spin() noexcept
+    {
+        ttlet spin_count = static_cast<int>(_spin_count.load(std::memory_order::relaxed));
+        ttlet max_spin = std::min(max_spin_count, spin_count * 2 + 10);
+
+        for (auto i = 0; i != max_spin; ++i) {
+            pause();
+
+            uint32_t expected = 0;
+            if (semaphore.load(std::memory_order::relaxed) == 0 and
+                semaphore.compare_exchange_strong(expected, 1, std::memory_order::acquire)) {
+                _spin_count.store(static_cast<uint16_t>(spin_count + (i - spin_count) / 8), std::memory_order::relaxed);
+                return true;
+            }
+        }
+
+        _spin_count.store(static_cast<uint16_t>(spin_count + (max_spin - spin_count) / 8), std::memory_order::relaxed);
+        return false;
+    }
+
     tt_no_inline void lock_contended(uint32_t expected) noexcept
     {
         tt_axiom(semaphore.load() <= 2);
 
-        do {
-            ttlet should_wait = expected == 2;
+        ttlet start = std::chrono::steady_clock::now();
+
+        if (not lock_spin()) {
+            expected = semaphore.load(std::memory_order::relaxed);
+            do {
+                ttlet should_wait = expected == 2;
+
+                // Set to 2 when we are waiting.
+                expected = 1;
+                if (should_wait || semaphore.compare_exchange_strong(expected, 2)) {
+                    tt_axiom(semaphore.load() <= 2);
+                    wait(2);
+                }
 
-            // Set to 2 when we are waiting.
-            expected = 1;
-            if (should_wait || semaphore.compare_exchange_strong(expected, 2)) {
                 tt_axiom(semaphore.load() <= 2);
-                semaphore.wait(2);
-            }
+                // Set to 2 when acquiring the lock, so that during unlock we wake other waiting threads.
+                expected = 0;
+            } while (!semaphore.compare_exchange_strong(expected, 2));
+        }
 
-            tt_axiom(semaphore.load() <= 2);
-            // Set to 2 when acquiring the lock, so that during unlock we wake other waiting threads.
-            expected = 0;
-        } while (!semaphore.compare_exchange_strong(expected, 2));
+        _statistics->add(std::chrono::steady_clock::now() - start);
     }
 };
 
-#if TT_BUILD_TYPE == TT_BT_DEBUG
+#if TT_BUILD_TYPE == TT_BT_DEBUG || defined(TT_DEAD_LOCK_DETECTOR)
 using unfair_mutex = unfair_mutex_impl<true>;
 #else
 using unfair_mutex = unfair_mutex_impl<false>;
@@ -0,0 +1,49 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/unfair_mutex.hpp"
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <type_traits>
+
+using namespace tt;
+
+template<typename Mutex>
+struct mutex_benchmark_state {
+    inline static Mutex mutex;
+    inline static int64_t value = 0;
+};
+
+/** Each thread repeatedly takes the lock for a tiny critical section.
+ * Reports the fraction of contended locks and the mean wait time for the unfair_mutex.
+ */
+template<typename Mutex>
+static void mutex_contention(benchmark::State &state)
+{
+    using benchmark_state = mutex_benchmark_state<Mutex>;
+
+    auto &statistics = detail::unfair_mutex_default_statistics;
+    ttlet start_count = statistics.count.load();
+    ttlet start_duration = statistics.duration.load();
+
+    for (auto _ : state) {
+        ttlet lock = std::scoped_lock(benchmark_state::mutex);
+        benchmark::DoNotOptimize(++benchmark_state::value);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if constexpr (std::is_same_v<Mutex, unfair_mutex_impl<false>>) {
+        // The statistics are shared by all threads, so they are reported once.
+        if (state.thread_index() == 0) {
+            ttlet count = statistics.count.load() - start_count;
+            ttlet duration = statistics.duration.load() - start_duration;
+            ttlet nr_locks = static_cast<double>(state.iterations() * state.threads());
+            state.counters["contended"] = static_cast<double>(count) / nr_locks;
+            state.counters["wait_ns"] = count != 0 ? static_cast<double>(duration) / static_cast<double>(count) : 0.0;
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(mutex_contention, unfair_mutex_impl<false>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(mutex_contention, std::mutex)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,25 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "unfair_mutex.hpp"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tt::detail {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) and std::atomic<uint32_t>::is_always_lock_free);
+
+void unfair_mutex_futex_wait(std::atomic<uint32_t> &value, uint32_t expected) noexcept
+{
+    // Returns immediately when the value no longer equals expected, or when interrupted.
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&value), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void unfair_mutex_futex_wake_one(std::atomic<uint32_t> &value) noexcept
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&value), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+} // namespace tt::detail
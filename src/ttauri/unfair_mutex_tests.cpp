@@ -0,0 +1,73 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/unfair_mutex.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+TEST(unfair_mutex, mutual_exclusion)
+{
+    constexpr int nr_threads = 4;
+    constexpr int nr_iterations = 100'000;
+
+    auto mutex = unfair_mutex_impl<false>{};
+    auto value = 0;
+
+    auto threads = std::vector<std::jthread>{};
+    for (auto i = 0; i != nr_threads; ++i) {
+        threads.emplace_back([&] {
+            for (auto j = 0; j != nr_iterations; ++j) {
+                ttlet lock = std::scoped_lock(mutex);
+                ++value;
+            }
+        });
+    }
+    threads.clear();
+
+    ASSERT_EQ(value, nr_threads * nr_iterations);
+}
+
+TEST(unfair_mutex, contention_statistics)
+{
+    using namespace std::chrono_literals;
+
+    auto &statistics = unfair_mutex_statistics_of<"unfair_mutex_tests">;
+    auto mutex = unfair_mutex_impl<false>{statistics};
+    auto waiting = std::atomic<bool>{false};
+
+    // Uncontended locks are not counted.
+    mutex.lock();
+    mutex.unlock();
+    ASSERT_EQ(statistics.count.load(), 0);
+    ASSERT_FALSE(unfair_mutex_statistics_map.contains("unfair_mutex_tests"));
+
+    mutex.lock();
+    auto thread = std::jthread([&] {
+        waiting = true;
+        ttlet lock = std::scoped_lock(mutex);
+    });
+    while (not waiting) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(50ms);
+    mutex.unlock();
+    thread.join();
+
+    ASSERT_EQ(statistics.count.load(), 1);
+    ASSERT_GE(statistics.duration.load(), std::chrono::nanoseconds{10ms}.count());
+    ASSERT_EQ(unfair_mutex_statistics_map.get("unfair_mutex_tests", nullptr), &statistics);
+
+    ttlet result = statistics.read();
+    ASSERT_EQ(result.count, 1);
+    ASSERT_EQ(result.last_count, 1);
+    ASSERT_EQ(statistics.read().last_count, 0);
+}
@@ -50,6 +50,11 @@ public:
     unfair_recursive_mutex &operator=(unfair_recursive_mutex const &) = delete;
 
     unfair_recursive_mutex() = default;
+
+    /** Construct a mutex which records its contention in the given statistics group.
+     */
+    constexpr explicit unfair_recursive_mutex(unfair_mutex_statistics &statistics) noexcept : mutex(statistics) {}
+
     ~unfair_recursive_mutex() = default;
 
     /** This function should be used in tt_axiom() to check if the lock is held by current thread.
@@ -2,6 +2,11 @@
 
 #pragma once
 
+#include "required.hpp"
+#include "assert.hpp"
+#include "architecture.hpp"
+#include "counters.hpp"
+#include <bit>
 #include <concepts>
 #include <atomic>
 #include <memory>
@@ -10,30 +15,48 @@
 namespace tt {
 
 /** A wait-free multiple-producer/single-consumer fifo designed for absolute performance.
- * Because of performance reasons the ring-buffer is 64kByte.
- * Each slot in the ring buffer consists of a pointer and a byte buffer for storage.
+ * Each slot in the ring buffer consists of a turn counter, a pointer and a byte buffer for storage.
  *
  * The number of slots in the ring-buffer is dictated by the size of each
  * slot and the ring-buffer size.
  *
+ * When a producer finds its slot still occupied, because the consumer fell behind
+ * a full ring, it spins for a short while and then blocks until the consumer releases
+ * the slot. Each time this happens the `wfree_fifo` counter is incremented, and
+ * the `wfree_fifo_block` counter when the producer had to block.
+ *
  * @tparam T Base class of the value type stored in the ring buffer.
  * @tparam SlotSize Size of each slot, must be power-of-two.
+ * @tparam FifoSize Size of the ring buffer in bytes, must be power-of-two.
  */
-template<typename T, size_t SlotSize>
+template<typename T, size_t SlotSize, size_t FifoSize = 65536>
 class wfree_fifo {
 public:
     static_assert(std::has_single_bit(SlotSize), "Only power-of-two number of messages size allowed.");
+    static_assert(std::has_single_bit(FifoSize), "Only power-of-two fifo size allowed.");
+    static_assert(FifoSize >= SlotSize * 2, "The fifo must have at least two slots.");
 
     using value_type = T;
 
-    static constexpr size_t fifo_size = 65536;
+    static constexpr size_t fifo_size = FifoSize;
     static constexpr size_t slot_size = SlotSize;
     static constexpr size_t num_slots = fifo_size / slot_size;
 
-    struct slot_type {
-        static constexpr size_t buffer_size = slot_size - sizeof(value_type *);
+    /** The number of times a producer checks an occupied slot before blocking.
+     */
+    static constexpr int spin_count = 256;
 
-        std::atomic<value_type *> pointer = nullptr;
+    struct slot_type {
+        static constexpr size_t buffer_size = slot_size - sizeof(std::atomic<size_t>) - sizeof(value_type *);
+
+        /** The turn counter of the slot.
+         * For the n-th time the ring buffer wraps around, the slot may be written
+         * when turn is `n * 2` and read when turn is `n * 2 + 1`.
+         * This makes sure messages are taken in order, even when producers that wrapped
+         * around wait on the same slot.
+         */
+        std::atomic<size_t> turn = 0;
+        value_type *pointer = nullptr;
         std::array<std::byte, buffer_size> buffer = {};
     };
 
@@ -53,14 +76,13 @@ public:
     template<typename Operation>
     bool take_one(Operation &&operation) noexcept
     {
-        auto index = _tail;
+        auto &slot = _slots[_tail % num_slots];
+        ttlet turn = (_tail / num_slots) * 2;
 
-        // The shift here should be eliminated by the equal shift inside the index operator.
-        auto &slot = _slots[index / slot_size];
-
-        // Check if the slot.pointer is not null, this is when the writer
+        // Check if it is the turn of the reader, this is when the writer
         // has finished writing the slot.
-        if (auto ptr = slot.pointer.load(std::memory_order::acquire)) {
+        if (slot.turn.load(std::memory_order::acquire) == turn + 1) {
+            auto ptr = slot.pointer;
             std::forward<Operation>(operation)(*ptr);
 
             // Destroy the object depending if it lives in the buffer or on the heap.
@@ -71,19 +93,29 @@ public:
             }
 
             // We are done with the slot.
-            slot.pointer.store(nullptr, std::memory_order::release);
-            _tail += slot_size;
+            release(slot, turn + 2);
+            ++_tail;
             return true;
         } else {
             return false;
         }
     }
 
-    tt_no_inline void contended() noexcept
+    /** Take all messages that are available in the fifo.
+     * This drains at most a full ring of messages, so that producers which keep
+     * adding messages can not keep the consumer busy forever.
+     *
+     * @param operation A `void(value_type const &)` which is called for each message.
+     * @return The number of messages that were taken.
+     */
+    template<typename Operation>
+    size_t take_all(Operation const &operation) noexcept
     {
-        // If we get here, that would suck, but nothing to do about it.
-        [[unlikely]] increment_counter<"wfree_fifo">();
-        std::this_thread::sleep_for(16ms);
+        size_t count = 0;
+        while (count != num_slots and take_one(operation)) {
+            ++count;
+        }
+        return count;
     }
 
     /** Create an message in-place on the fifo.
@@ -94,33 +126,28 @@ public:
     tt_force_inline void emplace(Args &&...args) noexcept requires(sizeof(Message) <= slot_type::buffer_size)
     {
         // We need a new index.
-        // - The index is a byte index into 64kByte of memory.
-        // - Increment index by the slot_size and the _head will overflow naturally
-        //   at the end of the fifo.
+        // - The index counts slots, and wraps around at the end of the ring buffer.
         // - We don't care about memory ordering with other writer threads. as
         //   each slot has an atomic for handling read/writer contention.
         // - We don't have to check full/empty, this is done on the slot itself.
-        ttlet index = _head.fetch_add(slot_size, std::memory_order::relaxed);
-        tt_axiom(index % slot_size == 0);
-
-        auto &slot = *std::launder(std::assume_aligned<slot_size>(reinterpret_cast<slot_type*>(reinterpret_cast<char*>(this) + index)));
+        ttlet index = _head.fetch_add(1, std::memory_order::relaxed);
 
-        // The division here should be eliminated by the equal multiplication inside the index operator.
-        // auto &slot = _slots[index / slot_size];
+        // The modulo and division here are a mask and shift since the number of slots is a power-of-two.
+        auto &slot = _slots[index % num_slots];
+        ttlet turn = (index / num_slots) * 2;
 
-        // Wait until the slot.pointer is a nullptr.
+        // Wait until it is our turn to write the slot.
         // And aquire the buffer to start overwriting it.
-        // There are no other threads that will make this non-null afterwards.
-        while (slot.pointer.load(std::memory_order_acquire)) {
-            // If we get here, that would suck, but nothing to do about it.
-            [[unlikely]] contended();
+        // There are no other threads that will write this slot in our turn.
+        if (slot.turn.load(std::memory_order::acquire) != turn) {
+            [[unlikely]] contended(slot, turn);
         }
 
         // Overwrite the buffer with the new slot.
-        auto new_ptr = new (slot.buffer.data()) Message(std::forward<Args>(args)...);
+        slot.pointer = new (slot.buffer.data()) Message(std::forward<Args>(args)...);
 
         // Release the buffer for reading.
-        slot.pointer.store(new_ptr, std::memory_order::release);
+        slot.turn.store(turn + 1, std::memory_order::release);
     }
 
     /** Create an message in-place on the fifo.
@@ -131,39 +158,76 @@ public:
     tt_force_inline void emplace(Args &&...args) noexcept
     {
         // We need a new index.
-        // - The index is a byte index into 64kByte of memory.
-        // - Increment index by the slot_size and the _head will overflow naturally
-        //   at the end of the fifo.
+        // - The index counts slots, and wraps around at the end of the ring buffer.
         // - We don't care about memory ordering with other writer threads. as
         //   each slot has an atomic for handling read/writer contention.
         // - We don't have to check full/empty, this is done on the slot itself.
-        ttlet index = _head.fetch_add(slot_size, std::memory_order::relaxed);
-        tt_axiom(index % slot_size == 0);
+        ttlet index = _head.fetch_add(1, std::memory_order::relaxed);
 
-        // The division here should be eliminated by the equal multiplication inside the index operator.
-        auto &slot = _slots[index / slot_size];
+        // The modulo and division here are a mask and shift since the number of slots is a power-of-two.
+        auto &slot = _slots[index % num_slots];
+        ttlet turn = (index / num_slots) * 2;
 
         // We need a heap allocated pointer with a fully constructed object
         // Lets do this ahead of time to let another thread have some time
         // to release the ring-buffer-slot.
         ttlet new_ptr = new Message(std::forward<Args>(args)...);
 
-        // Wait until the slot.pointer is a nullptr.
-        // We don't need to acquire since we wrote into a new heap location.
-        // There are no other threads that will make this non-null afterwards.
-        while (slot.pointer.load(std::memory_order::relaxed)) {
-            // If we get here, that would suck, but nothing to do about it.
-            [[unlikely]] contended();
+        // Wait until it is our turn to write the slot.
+        // There are no other threads that will write this slot in our turn.
+        if (slot.turn.load(std::memory_order::acquire) != turn) {
+            [[unlikely]] contended(slot, turn);
         }
 
         // Release the heap for reading.
-        slot.pointer.store(new_ptr, std::memory_order::release);
+        slot.pointer = new_ptr;
+        slot.turn.store(turn + 1, std::memory_order::release);
     }
 
 private:
-    std::array<slot_type, 256> _slots = {};
-    std::atomic<uint16_t> _head = 0;
-    uint16_t _tail = 0;
+    std::array<slot_type, num_slots> _slots = {};
+    std::atomic<size_t> _head = 0;
+    size_t _tail = 0;
+
+    /** The number of producers blocked on an occupied slot.
+     */
+    std::atomic<size_t> _nr_waiting = 0;
+
+    /** Release a slot after the consumer is done with it, and wake up a blocked producer.
+     */
+    void release(slot_type &slot, size_t next_turn) noexcept
+    {
+        // Sequentially consistent with the producer incrementing `_nr_waiting` before
+        // checking the slot, so that either the producer sees its turn, or
+        // the consumer sees the waiting producer.
+        slot.turn.store(next_turn);
+        if (_nr_waiting.load() != 0) {
+            [[unlikely]] slot.turn.notify_all();
+        }
+    }
+
+    /** Wait until the consumer has released a slot.
+     * This happens when the producers are a full ring ahead of the consumer.
+     * Spin first, as the consumer is likely to be working on this slot already,
+     * then block on the slot so that the producer does not burn CPU or oversleep.
+     */
+    tt_no_inline void contended(slot_type &slot, size_t turn) noexcept
+    {
+        increment_counter<"wfree_fifo", counter_mode::sharded>();
+
+        for (auto i = 0; i != spin_count; ++i) {
+            if (slot.turn.load(std::memory_order::acquire) == turn) {
+                return;
+            }
+        }
+
+        increment_counter<"wfree_fifo_block", counter_mode::sharded>();
+        ++_nr_waiting;
+        for (auto current = slot.turn.load(); current != turn; current = slot.turn.load()) {
+            slot.turn.wait(current);
+        }
+        --_nr_waiting;
+    }
 };
 
 } // namespace tt
@@ -0,0 +1,74 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/wfree_fifo.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace tt;
+
+struct benchmark_message {
+    std::chrono::steady_clock::time_point time_stamp;
+
+    benchmark_message(std::chrono::steady_clock::time_point time_stamp) noexcept : time_stamp(time_stamp) {}
+};
+
+/** Several producers add messages to the fifo while a single consumer drains it in batches.
+ * Besides the throughput this reports the latency percentiles between adding and taking a message.
+ */
+template<size_t FifoSize>
+static void wfree_fifo_producer_consumer(benchmark::State &state)
+{
+    using namespace std::chrono;
+
+    ttlet nr_producers = static_cast<int>(state.range(0));
+    constexpr int nr_messages_per_producer = 100000;
+    ttlet nr_messages = static_cast<size_t>(nr_producers * nr_messages_per_producer);
+
+    auto fifo = std::make_unique<wfree_fifo<benchmark_message, 64, FifoSize>>();
+    auto latencies = std::vector<int64_t>{};
+    latencies.reserve(nr_messages);
+
+    for (auto _ : state) {
+        latencies.clear();
+
+        auto consumer = std::jthread([&] {
+            while (latencies.size() != nr_messages) {
+                ttlet count = fifo->take_all([&latencies](benchmark_message const &message) {
+                    latencies.push_back(duration_cast<nanoseconds>(steady_clock::now() - message.time_stamp).count());
+                });
+                if (count == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        auto producers = std::vector<std::jthread>{};
+        for (auto i = 0; i != nr_producers; ++i) {
+            producers.emplace_back([&fifo] {
+                for (auto j = 0; j != nr_messages_per_producer; ++j) {
+                    fifo->template emplace<benchmark_message>(steady_clock::now());
+                }
+            });
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    ttlet percentile = [&latencies](double fraction) {
+        return static_cast<double>(latencies[static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1))]);
+    };
+
+    state.SetItemsProcessed(state.iterations() * nr_messages);
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.counters["max_ns"] = percentile(1.0);
+}
+
+BENCHMARK_TEMPLATE(wfree_fifo_producer_consumer, 4096)->DenseRange(1, 4)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(wfree_fifo_producer_consumer, 65536)->DenseRange(1, 4)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,369 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace tt {
+
+/** A growable unordered map with wait-free lookups.
+ *
+ * Lookups, `keys()`, `items()` and `size()` are wait-free. Inserts are lock-free;
+ * items can not be erased.
+ *
+ * Items are allocated as nodes which never move, so references to values remain valid
+ * while the map grows. The table of the map holds pointers to the nodes and is doubled
+ * in size when it becomes half full. Threads that insert cooperate in copying the node
+ * pointers from the previous table into the new table in chunks, while lookups search
+ * both tables until the migration is complete.
+ *
+ * Retired tables are kept until the map is destroyed, so that lookups don't need to
+ * protect the tables they are reading. Because the tables double in size the retired
+ * tables together are smaller than the current table.
+ *
+ * This class can be instantiated as a global variable without needing initialization.
+ *
+ * @tparam K The key type, must be hashable with `std::hash`.
+ * @tparam V The value type, must be default constructible.
+ */
+template<typename K, typename V>
+class wfree_hash_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+
+    static constexpr size_t initial_capacity = 64;
+
+    constexpr wfree_hash_map() noexcept = default;
+    wfree_hash_map(wfree_hash_map const &) = delete;
+    wfree_hash_map(wfree_hash_map &&) = delete;
+    wfree_hash_map &operator=(wfree_hash_map const &) = delete;
+    wfree_hash_map &operator=(wfree_hash_map &&) = delete;
+
+    ~wfree_hash_map()
+    {
+        auto *node = _nodes.load(std::memory_order::acquire);
+        while (node != nullptr) {
+            delete std::exchange(node, node->next);
+        }
+
+        auto *table = _table.load(std::memory_order::acquire);
+        while (table != nullptr) {
+            delete std::exchange(table, table->previous);
+        }
+    }
+
+    /** The number of items in the map.
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _size.load(std::memory_order::relaxed);
+    }
+
+    /** Insert an item, or replace the value of an existing item.
+     * Replacing a value is not atomic, the caller must make sure this does not race with readers.
+     */
+    void insert(K key, V value) noexcept
+    {
+        auto [node, inserted] = insert_node(std::move(key), value);
+        if (not inserted) {
+            node->value = std::move(value);
+        }
+    }
+
+    /** Get a reference to the value of an item, default-constructing the item when it does not exist.
+     */
+    [[nodiscard]] V &operator[](K const &key) noexcept
+    {
+        if (auto *node = find(key, std::hash<K>{}(key))) {
+            return node->value;
+        }
+        return insert_node(key, V{}).first->value;
+    }
+
+    [[nodiscard]] std::optional<V> get(K const &key) const noexcept
+    {
+        if (ttlet *node = find(key, std::hash<K>{}(key))) {
+            return {node->value};
+        }
+        return {};
+    }
+
+    [[nodiscard]] V get(K const &key, V const &default_value) const noexcept
+    {
+        if (ttlet *node = find(key, std::hash<K>{}(key))) {
+            return node->value;
+        }
+        return default_value;
+    }
+
+    [[nodiscard]] bool contains(K const &key) const noexcept
+    {
+        return find(key, std::hash<K>{}(key)) != nullptr;
+    }
+
+    /** Get the keys of all the items.
+     * Items inserted during the call may or may not be included.
+     */
+    [[nodiscard]] std::vector<K> keys() const noexcept
+    {
+        auto r = std::vector<K>{};
+        r.reserve(size());
+        for (auto *node = _nodes.load(std::memory_order::acquire); node != nullptr; node = node->next) {
+            r.push_back(node->key);
+        }
+        return r;
+    }
+
+    /** Get a copy of all the items.
+     * Items inserted during the call may or may not be included.
+     */
+    [[nodiscard]] std::vector<std::pair<K, V>> items() const noexcept
+    {
+        auto r = std::vector<std::pair<K, V>>{};
+        r.reserve(size());
+        for (auto *node = _nodes.load(std::memory_order::acquire); node != nullptr; node = node->next) {
+            r.emplace_back(node->key, node->value);
+        }
+        return r;
+    }
+
+private:
+    struct node_type {
+        K key;
+        V value;
+        size_t hash;
+
+        /** The next node in the list of all nodes, used for iteration.
+         */
+        node_type *next = nullptr;
+    };
+
+    struct table_type {
+        size_t capacity;
+
+        /** The table this table replaced, its items are being migrated into this table.
+         */
+        table_type *previous;
+
+        /** Set when all the items of the previous table have been migrated.
+         */
+        std::atomic<bool> migrated;
+
+        /** The number of used slots, used to decide when to grow.
+         */
+        std::atomic<size_t> count = 0;
+
+        /** The next chunk of the previous table to migrate.
+         */
+        std::atomic<size_t> migrate_index = 0;
+
+        /** Pointers to nodes, the `moved_bit` is set when the slot was migrated to the next table.
+         */
+        std::unique_ptr<std::atomic<uintptr_t>[]> slots;
+
+        table_type(size_t capacity, table_type *previous) noexcept :
+            capacity(capacity), previous(previous), migrated(previous == nullptr), slots(new std::atomic<uintptr_t>[capacity])
+        {
+            tt_axiom(std::has_single_bit(capacity));
+            for (auto i = size_t{0}; i != capacity; ++i) {
+                slots[i].store(0, std::memory_order::relaxed);
+            }
+        }
+    };
+
+    static constexpr uintptr_t moved_bit = 1;
+    static constexpr size_t migrate_chunk_size = 64;
+
+    std::atomic<table_type *> _table = nullptr;
+    std::atomic<node_type *> _nodes = nullptr;
+    std::atomic<size_t> _size = 0;
+
+    [[nodiscard]] static node_type *to_node(uintptr_t slot) noexcept
+    {
+        return reinterpret_cast<node_type *>(slot & ~moved_bit);
+    }
+
+    [[nodiscard]] static node_type *find_in_table(table_type const &table, K const &key, size_t hash) noexcept
+    {
+        ttlet mask = table.capacity - 1;
+        for (auto i = size_t{0}; i != table.capacity; ++i) {
+            auto *node = to_node(table.slots[(hash + i) & mask].load(std::memory_order::acquire));
+            if (node == nullptr) {
+                return nullptr;
+            } else if (node->hash == hash and node->key == key) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] node_type *find(K const &key, size_t hash) const noexcept
+    {
+        ttlet *table = _table.load(std::memory_order::acquire);
+        if (table == nullptr) {
+            return nullptr;
+        }
+
+        // The migrated flag must be read before searching the table. If it were read afterwards, a migration
+        // that copies the node into the table after it was searched and then completes, would make the
+        // lookup skip the previous table and miss the node.
+        ttlet migrated = table->migrated.load(std::memory_order::acquire);
+
+        if (auto *node = find_in_table(*table, key, hash)) {
+            return node;
+        }
+
+        // The previous table keeps pointing to its nodes after they were migrated, so a node which was
+        // inserted before this lookup started is always found in one of the tables.
+        if (not migrated) {
+            return find_in_table(*table->previous, key, hash);
+        }
+        return nullptr;
+    }
+
+    /** Add a node to a table.
+     *
+     * @return The node with the same key, or nullptr when the table was retired and the insert must be retried.
+     */
+    [[nodiscard]] static node_type *insert_in_table(table_type &table, node_type *new_node) noexcept
+    {
+        ttlet mask = table.capacity - 1;
+        for (auto i = size_t{0}; i != table.capacity; ++i) {
+            auto &slot = table.slots[(new_node->hash + i) & mask];
+
+            auto value = slot.load(std::memory_order::acquire);
+            while (value == 0) {
+                if (slot.compare_exchange_weak(
+                        value, reinterpret_cast<uintptr_t>(new_node), std::memory_order::acq_rel, std::memory_order::acquire)) {
+                    table.count.fetch_add(1, std::memory_order::relaxed);
+                    return new_node;
+                }
+            }
+
+            if (value == moved_bit) {
+                // An empty slot which was migrated; this table was replaced by a newer table.
+                return nullptr;
+            }
+
+            auto *node = to_node(value);
+            if (node == new_node or (node->hash == new_node->hash and node->key == new_node->key)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Copy a slot from the previous table into this table and mark it as moved.
+     * This is idempotent so that multiple threads may migrate the same slot.
+     */
+    static void migrate_slot(table_type &table, std::atomic<uintptr_t> &slot) noexcept
+    {
+        auto value = slot.load(std::memory_order::acquire);
+        while ((value & moved_bit) == 0) {
+            if (value != 0) {
+                [[maybe_unused]] ttlet *node = insert_in_table(table, to_node(value));
+                tt_axiom(node == to_node(value));
+            }
+            if (slot.compare_exchange_weak(value, value | moved_bit, std::memory_order::acq_rel, std::memory_order::acquire)) {
+                return;
+            }
+        }
+    }
+
+    /** Migrate all the items from the previous table.
+     * Concurrent threads first divide the work in chunks, then each checks that every slot was migrated.
+     */
+    static void migrate(table_type &table) noexcept
+    {
+        if (table.migrated.load(std::memory_order::acquire)) {
+            return;
+        }
+
+        auto &previous = *table.previous;
+        while (true) {
+            ttlet first = table.migrate_index.fetch_add(migrate_chunk_size, std::memory_order::relaxed);
+            if (first >= previous.capacity) {
+                break;
+            }
+            for (auto i = first; i != first + migrate_chunk_size; ++i) {
+                migrate_slot(table, previous.slots[i]);
+            }
+        }
+
+        // A chunk claimed by a thread which is not done yet is migrated here as well.
+        for (auto i = size_t{0}; i != previous.capacity; ++i) {
+            migrate_slot(table, previous.slots[i]);
+        }
+        table.migrated.store(true, std::memory_order::release);
+    }
+
+    /** Get the current table after its migration is complete, creating or growing it when needed.
+     */
+    [[nodiscard]] table_type &get_table_for_insert() noexcept
+    {
+        while (true) {
+            auto *table = _table.load(std::memory_order::acquire);
+            if (table == nullptr) {
+                auto *new_table = new table_type(initial_capacity, nullptr);
+                if (not _table.compare_exchange_strong(table, new_table, std::memory_order::acq_rel)) {
+                    delete new_table;
+                }
+                continue;
+            }
+
+            migrate(*table);
+
+            if (table->count.load(std::memory_order::relaxed) * 2 < table->capacity) {
+                return *table;
+            }
+
+            auto *new_table = new table_type(table->capacity * 2, table);
+            if (not _table.compare_exchange_strong(table, new_table, std::memory_order::acq_rel)) {
+                delete new_table;
+            }
+        }
+    }
+
+    /** Insert a new node for the key.
+     *
+     * @return The node for the key and true if it was inserted, or the existing node and false.
+     */
+    [[nodiscard]] std::pair<node_type *, bool> insert_node(K key, V const &value) noexcept
+    {
+        ttlet hash = std::hash<K>{}(key);
+        if (auto *node = find(key, hash)) {
+            return {node, false};
+        }
+
+        auto *new_node = new node_type{std::move(key), value, hash};
+        while (true) {
+            if (auto *node = insert_in_table(get_table_for_insert(), new_node)) {
+                if (node != new_node) {
+                    delete new_node;
+                    return {node, false};
+                }
+                break;
+            }
+        }
+
+        new_node->next = _nodes.load(std::memory_order::relaxed);
+        while (not _nodes.compare_exchange_weak(new_node->next, new_node, std::memory_order::release, std::memory_order::relaxed)) {
+        }
+        _size.fetch_add(1, std::memory_order::relaxed);
+        return {new_node, true};
+    }
+};
+
+} // namespace tt
@@ -0,0 +1,57 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/wfree_hash_map.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+
+using namespace tt;
+
+/** Lookups of existing keys from a number of threads at the same time.
+ */
+static void wfree_hash_map_lookup(benchmark::State &state)
+{
+    constexpr int nr_keys = 1000;
+
+    static auto map = [] {
+        auto r = std::make_unique<wfree_hash_map<std::string, int>>();
+        for (auto i = 0; i != nr_keys; ++i) {
+            r->insert(std::to_string(i), i);
+        }
+        return r;
+    }();
+
+    auto keys = std::vector<std::string>{};
+    for (auto i = 0; i != nr_keys; ++i) {
+        keys.push_back(std::to_string(i));
+    }
+
+    auto i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map->get(keys[i], -1));
+        i = (i + 1) % nr_keys;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** Insert new keys into a growing map, with each thread inserting its own keys.
+ */
+static void wfree_hash_map_insert(benchmark::State &state)
+{
+    static auto map = std::unique_ptr<wfree_hash_map<int, int>>{};
+    if (state.thread_index() == 0) {
+        map = std::make_unique<wfree_hash_map<int, int>>();
+    }
+
+    auto key = state.thread_index();
+    for (auto _ : state) {
+        map->insert(key, key);
+        key += state.threads();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(wfree_hash_map_lookup)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(wfree_hash_map_insert)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,150 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/wfree_hash_map.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+TEST(wfree_hash_map, insert_get)
+{
+    auto map = wfree_hash_map<std::string, int>{};
+    ASSERT_EQ(map.size(), 0);
+    ASSERT_FALSE(map.get("foo"));
+
+    map.insert("foo", 1);
+    map.insert("bar", 2);
+    ASSERT_EQ(map.size(), 2);
+    ASSERT_EQ(map.get("foo"), 1);
+    ASSERT_EQ(map.get("bar"), 2);
+    ASSERT_EQ(map.get("baz", 3), 3);
+
+    // Replace a value.
+    map.insert("foo", 4);
+    ASSERT_EQ(map.size(), 2);
+    ASSERT_EQ(map.get("foo"), 4);
+
+    // Default construct a value.
+    ASSERT_EQ(map["baz"], 0);
+    map["baz"] = 5;
+    ASSERT_EQ(map.get("baz"), 5);
+    ASSERT_EQ(map.size(), 3);
+
+    auto keys = map.keys();
+    std::sort(keys.begin(), keys.end());
+    ASSERT_EQ(keys, (std::vector<std::string>{"bar", "baz", "foo"}));
+}
+
+TEST(wfree_hash_map, grow)
+{
+    auto map = wfree_hash_map<int, int>{};
+
+    // References to values remain valid while the map grows.
+    auto &first = map[0];
+    first = 42;
+
+    for (auto i = 1; i != 10000; ++i) {
+        map.insert(i, i * 2);
+    }
+    ASSERT_EQ(map.size(), 10000);
+    ASSERT_EQ(&map[0], &first);
+    ASSERT_EQ(map.get(0), 42);
+
+    for (auto i = 1; i != 10000; ++i) {
+        ASSERT_EQ(map.get(i), i * 2);
+    }
+    ASSERT_FALSE(map.contains(10000));
+
+    auto items = map.items();
+    ASSERT_EQ(items.size(), 10000);
+    std::sort(items.begin(), items.end());
+    for (auto i = 1; i != 10000; ++i) {
+        ASSERT_EQ(items[i], std::pair(i, i * 2));
+    }
+}
+
+TEST(wfree_hash_map, concurrent)
+{
+    constexpr int nr_threads = 8;
+    constexpr int nr_keys = 20000;
+
+    auto map = wfree_hash_map<int, int>{};
+    auto values = std::vector<std::vector<int *>>(nr_threads, std::vector<int *>(nr_keys, nullptr));
+
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto t = 0; t != nr_threads; ++t) {
+            threads.emplace_back([&, t] {
+                // Every thread inserts every key in a different order, so that threads race
+                // to insert the same keys while the map is growing.
+                for (auto i = 0; i != nr_keys; ++i) {
+                    ttlet key = (i * 7919 + t * 104729) % nr_keys;
+                    values[t][key] = &map[key];
+                }
+            });
+        }
+    }
+
+    ASSERT_EQ(map.size(), nr_keys);
+    ASSERT_EQ(map.keys().size(), nr_keys);
+
+    // All threads got the same item for a key.
+    for (auto key = 0; key != nr_keys; ++key) {
+        for (auto t = 0; t != nr_threads; ++t) {
+            ASSERT_EQ(values[t][key], &map[key]);
+        }
+    }
+}
+
+TEST(wfree_hash_map, concurrent_lookup)
+{
+    constexpr int nr_readers = 4;
+    constexpr int nr_keys = 100000;
+
+    auto map = wfree_hash_map<int, int>{};
+    auto inserted = std::atomic<int>{0};
+    auto missed = std::atomic<int>{0};
+
+    {
+        auto threads = std::vector<std::jthread>{};
+
+        // Readers look up keys which are known to be inserted, while the writer grows the map.
+        for (auto t = 0; t != nr_readers; ++t) {
+            threads.emplace_back([&, t] {
+                auto i = t;
+                while (true) {
+                    ttlet last = inserted.load(std::memory_order::acquire);
+                    if (last == nr_keys) {
+                        break;
+                    } else if (last != 0) {
+                        ttlet key = (i++ * 7919) % last;
+                        if (map.get(key, -1) != key) {
+                            ++missed;
+                        }
+                    }
+                    if (i % 256 == 0) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        threads.emplace_back([&] {
+            for (auto key = 0; key != nr_keys; ++key) {
+                map.insert(key, key);
+                inserted.store(key + 1, std::memory_order::release);
+            }
+        });
+    }
+
+    ASSERT_EQ(missed.load(), 0);
+    ASSERT_EQ(map.size(), nr_keys);
+}
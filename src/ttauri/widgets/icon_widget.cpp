@@ -60,9 +60,7 @@ void icon_widget::init() noexcept
 
             } else if (pixmap.hash() != _pixmap_hash) {
                 _pixmap_hash = pixmap.hash();
-                _pixmap_backing = device->imagePipeline->makeImage(pixmap.width(), pixmap.height());
-
-                _pixmap_backing.upload(pixmap);
+                _pixmap_backing = device->imagePipeline->makeImage(pixmap);
                 _icon_bounding_box = aarectangle{
                     extent2{narrow_cast<float>(_pixmap_backing.width_in_px), narrow_cast<float>(_pixmap_backing.height_in_px)}};
             }
@@ -0,0 +1,45 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/binary_log.hpp"
+#include "ttauri/file_view.hpp"
+#include "ttauri/URL.hpp"
+#include <format>
+#include <iostream>
+#include <exception>
+#include <string_view>
+
+template<typename... Args>
+void print(std::string_view fmt, Args const &... args) noexcept
+{
+    std::cerr << std::format(fmt, args...) << std::endl;
+}
+
+void usage(std::string_view program, std::string_view str)
+{
+    print("Argument Error: {}\n", str);
+    print("Usage: {} <binary-log-file>", program);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        usage(argv[0], "Expecting exactly one argument.");
+    }
+
+    try {
+        auto const view = tt::file_view(tt::URL::urlFromPath(argv[1]));
+        auto const reader = tt::binary_log_reader(view.bytes());
+
+        for (auto const &line : reader.lines()) {
+            std::cout << line;
+        }
+
+    } catch (std::exception const &e) {
+        print("Error: {}", e.what());
+        return 1;
+    }
+    return 0;
+}